@@ -0,0 +1,87 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the Arduino core, used only by [env:native].
+// Provides just enough of the API for the LED rendering code to build on a
+// desktop compiler, plus a fake clock and fake GPIO that tests drive.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mutex>
+
+// Fake clock - nothing advances it except the test harness
+inline unsigned long nativeMicros = 0;
+
+inline unsigned long micros() { return nativeMicros; }
+inline unsigned long millis() { return nativeMicros / 1000; }
+inline void setNativeMillis(unsigned long ms) { nativeMicros = ms * 1000; }
+inline void advanceNativeMicros(unsigned long us) { nativeMicros += us; }
+inline void delay(unsigned long ms) { nativeMicros += ms * 1000; }
+inline void delayMicroseconds(unsigned int us) { nativeMicros += us; }
+
+// GPIO: pin levels are set by the test harness, which also fires the
+// pin-change interrupt attached with attachInterrupt()
+#define IRAM_ATTR
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define CHANGE 0x03
+#define NATIVE_NUM_PINS 32
+
+inline uint8_t nativePinLevels[NATIVE_NUM_PINS] = {0};
+inline void (*nativePinHandlers[NATIVE_NUM_PINS])() = {nullptr};
+
+inline void pinMode(uint8_t pin, uint8_t mode) {}
+inline int digitalRead(uint8_t pin) { return nativePinLevels[pin]; }
+inline void digitalWrite(uint8_t pin, uint8_t level) { nativePinLevels[pin] = level; }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(int pin, void (*handler)(), int mode) { nativePinHandlers[pin] = handler; }
+inline void detachInterrupt(int pin) { nativePinHandlers[pin] = nullptr; }
+
+inline void setNativePin(uint8_t pin, uint8_t level) {
+  if (nativePinLevels[pin] == level) {
+    return;
+  }
+  nativePinLevels[pin] = level;
+  if (nativePinHandlers[pin]) {
+    nativePinHandlers[pin]();
+  }
+}
+
+// FreeRTOS types that shared headers mention (the ESP32 Arduino.h pulls in
+// FreeRTOS); no scheduler exists on the host, but mutexes are real so tests
+// can run writers on several threads
+typedef void* SemaphoreHandle_t;
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define pdTRUE 1
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return new std::mutex(); }
+inline int xSemaphoreTake(SemaphoreHandle_t mutex, unsigned long ticks) {
+  static_cast<std::mutex*>(mutex)->lock();
+  return pdTRUE;
+}
+inline int xSemaphoreGive(SemaphoreHandle_t mutex) {
+  static_cast<std::mutex*>(mutex)->unlock();
+  return pdTRUE;
+}
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+// Same integer mapping as the ESP32 Arduino core
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) {
+  const long run = in_max - in_min;
+  if (run == 0) {
+    return -1;
+  }
+  const long rise = out_max - out_min;
+  const long delta = x - in_min;
+  return (delta * rise) / run + out_min;
+}
+
+#endif // NATIVE_ARDUINO_H
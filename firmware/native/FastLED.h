@@ -0,0 +1,165 @@
+#ifndef NATIVE_FASTLED_H
+#define NATIVE_FASTLED_H
+
+// Host stand-in for FastLED, used only by [env:native].
+// CRGB arithmetic matches FastLED (saturating adds, FASTLED_SCALE8_FIXED
+// scaling) so rendered buffers are comparable to the device. inoise8() is a
+// cheap value-noise substitute: deterministic, but not FastLED's Perlin noise.
+
+#include <Arduino.h>
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+  unsigned int t = i + j;
+  return t > 255 ? 255 : t;
+}
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+  return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+struct CRGB {
+  union {
+    struct {
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+    };
+    uint8_t raw[3];
+  };
+
+  enum HTMLColorCode {
+    Black = 0x000000,
+    White = 0xFFFFFF
+  };
+
+  CRGB() {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(HTMLColorCode code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+
+  CRGB& operator+=(const CRGB& rhs) {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB& addToRGB(uint8_t d) {
+    r = qadd8(r, d);
+    g = qadd8(g, d);
+    b = qadd8(b, d);
+    return *this;
+  }
+
+  CRGB& nscale8(uint8_t scale) {
+    r = scale8(r, scale);
+    g = scale8(g, scale);
+    b = scale8(b, scale);
+    return *this;
+  }
+
+  bool operator==(const CRGB& rhs) const { return r == rhs.r && g == rhs.g && b == rhs.b; }
+  bool operator!=(const CRGB& rhs) const { return !(*this == rhs); }
+};
+
+inline void fill_solid(CRGB* leds, int numToFill, const CRGB& color) {
+  for (int i = 0; i < numToFill; i++) {
+    leds[i] = color;
+  }
+}
+
+enum EOrder { RGB = 0012, GRB = 0102 };
+
+template <uint8_t DATA_PIN, EOrder RGB_ORDER = GRB>
+class WS2812B {};
+
+// Value noise on a 256x256 lattice with smooth interpolation
+inline uint8_t nativeNoiseHash(uint8_t x, uint8_t y) {
+  uint32_t h = (uint32_t)x * 374761393u + (uint32_t)y * 668265263u;
+  h = (h ^ (h >> 13)) * 1274126177u;
+  return (h ^ (h >> 16)) & 0xFF;
+}
+
+inline uint8_t inoise8(uint16_t x, uint16_t y) {
+  uint8_t xi = x >> 8, yi = y >> 8;
+  uint16_t xf = x & 0xFF, yf = y & 0xFF;
+  xf = (xf * xf * (768 - 2 * xf)) >> 16;  // smoothstep on 0..255
+  yf = (yf * yf * (768 - 2 * yf)) >> 16;
+  int a = nativeNoiseHash(xi, yi), b = nativeNoiseHash(xi + 1, yi);
+  int c = nativeNoiseHash(xi, yi + 1), d = nativeNoiseHash(xi + 1, yi + 1);
+  int top = a + (((b - a) * (int)xf) >> 8);
+  int bottom = c + (((d - c) * (int)xf) >> 8);
+  return top + (((bottom - top) * (int)yf) >> 8);
+}
+
+// One strip on one pin. addLeds() hands it out; setLeds() re-points it at a
+// new buffer without registering another controller, as in FastLED
+class CLEDController {
+private:
+  CRGB* leds;
+  int numLeds;
+
+public:
+  uint8_t pin;
+
+  CLEDController() : leds(nullptr), numLeds(0), pin(0) {}
+
+  void setLeds(CRGB* data, int count) {
+    leds = data;
+    numLeds = count;
+  }
+
+  CRGB* getLeds() const { return leds; }
+  int size() const { return numLeds; }
+};
+
+#define NATIVE_MAX_CONTROLLERS 8
+
+#define DISABLE_DITHER 0x00
+#define BINARY_DITHER 0x01
+
+class CFastLED {
+private:
+  CLEDController controllers[NATIVE_MAX_CONTROLLERS];
+  int controllerCount;
+  uint8_t brightness;
+  uint8_t dither;
+
+public:
+  unsigned long showCount;
+
+  CFastLED() : controllerCount(0), brightness(255), dither(BINARY_DITHER), showCount(0) {}
+
+  template <template <uint8_t DATA_PIN, EOrder RGB_ORDER> class CHIPSET, uint8_t DATA_PIN, EOrder RGB_ORDER>
+  CLEDController& addLeds(CRGB* data, int count) {
+    CLEDController& controller = controllers[controllerCount < NATIVE_MAX_CONTROLLERS ? controllerCount++ : 0];
+    controller.pin = DATA_PIN;
+    controller.setLeds(data, count);
+    return controller;
+  }
+
+  void setBrightness(uint8_t scale) { brightness = scale; }
+  uint8_t getBrightness() const { return brightness; }
+  void setDither(uint8_t ditherMode) { dither = ditherMode; }
+  uint8_t getDither() const { return dither; }
+
+  void clear() {
+    for (int c = 0; c < controllerCount; c++) {
+      for (int i = 0; i < controllers[c].size(); i++) {
+        controllers[c].getLeds()[i] = CRGB::Black;
+      }
+    }
+  }
+
+  void show() { showCount++; }
+
+  int count() const { return controllerCount; }
+  CLEDController& operator[](int index) { return controllers[index]; }
+
+  // Like FastLED.leds() and FastLED.size(): the first controller's strip
+  CRGB* getLeds() const { return controllers[0].getLeds(); }
+  int size() const { return controllers[0].size(); }
+};
+
+inline CFastLED FastLED;
+
+#endif // NATIVE_FASTLED_H
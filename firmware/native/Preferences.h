@@ -0,0 +1,64 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+// Host stand-in for the ESP32 Preferences (NVS) library, used only by
+// [env:native]. Keys live in memory for the life of the object, which is
+// enough for SettingsManager's record, migration and commit paths.
+
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+private:
+  std::map<std::string, std::vector<uint8_t>> entries;
+
+  template <typename T>
+  T getValue(const char* key, T defaultValue) {
+    auto entry = entries.find(key);
+    if (entry == entries.end() || entry->second.size() != sizeof(T)) {
+      return defaultValue;
+    }
+    T value;
+    memcpy(&value, entry->second.data(), sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  size_t putValue(const char* key, T value) {
+    return putBytes(key, &value, sizeof(T));
+  }
+
+public:
+  bool begin(const char* name, bool readOnly = false) { return true; }
+  void end() {}
+  bool clear() { entries.clear(); return true; }
+  bool remove(const char* key) { return entries.erase(key) > 0; }
+  bool isKey(const char* key) { return entries.count(key) > 0; }
+  size_t freeEntries() { return 100; }
+
+  size_t putBytes(const char* key, const void* value, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    entries[key].assign(bytes, bytes + length);
+    return length;
+  }
+  size_t getBytes(const char* key, void* buffer, size_t maxLength) {
+    auto entry = entries.find(key);
+    if (entry == entries.end() || entry->second.size() > maxLength) {
+      return 0;
+    }
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+  }
+
+  size_t putUChar(const char* key, uint8_t value) { return putValue(key, value); }
+  size_t putUShort(const char* key, uint16_t value) { return putValue(key, value); }
+  size_t putBool(const char* key, bool value) { return putValue<uint8_t>(key, value); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+  bool getBool(const char* key, bool defaultValue = false) { return getValue<uint8_t>(key, defaultValue) != 0; }
+};
+
+#endif // NATIVE_PREFERENCES_H
@@ -2,9 +2,31 @@
 #include <ArduinoJson.h>
 #include "throttle.h"
 #include "constants.h"
+#include "logging.h"
+#include "effects.h"
+#include "ble_write.h"
 
-// Forward declaration for throttle calibration
+// Forward declarations for throttle calibration (handled by the input task)
 extern void startThrottleCalibration();
+extern void requestThrottleCalibrationReset();
+
+// Telemetry samples recorded by the render task
+extern TelemetryBuffer telemetry;
+
+// Delayed work, run by the system task
+extern DeferredActions deferredActions;
+
+// Receives connection parameter updates from the GAP handler
+static AfterburnerBLEService* gapEventService = nullptr;
+
+static void handleGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+  if (event == ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT && gapEventService &&
+      param->update_conn_params.status == ESP_BT_STATUS_SUCCESS) {
+    gapEventService->handleConnParamsUpdated(param->update_conn_params.conn_int,
+                                             param->update_conn_params.latency,
+                                             param->update_conn_params.timeout);
+  }
+}
 
 // Server callbacks for connection monitoring
 class ServerCallbacks : public BLEServerCallbacks {
@@ -13,132 +35,67 @@ private:
 public:
   ServerCallbacks(AfterburnerBLEService* service) : bleService(service) {}
   
-  void onConnect(BLEServer* pServer) {
-    Serial.println("BLE: Client connected successfully!");
-    bleService->deviceConnected = true;
-    
-    // Send current calibration status to newly connected client
-    delay(500); // Give BLE stack time to establish connection
-    if (bleService->getSettingsManager()) {
-      bool isCalibrated = bleService->getSettingsManager()->isThrottleCalibrated();
-      uint16_t minPWM = bleService->getSettingsManager()->getThrottleMin();
-      uint16_t maxPWM = bleService->getSettingsManager()->getThrottleMax();
-      bleService->updateThrottleCalibrationStatus(isCalibrated, minPWM, maxPWM);
-    }
+  void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+    LOG_INFO(BLE, "BLE: Client connected successfully!\n");
+    bleService->handleConnect(param);
   }
   
   void onDisconnect(BLEServer* pServer) {
-    Serial.println("BLE: Client disconnected");
-    bleService->deviceConnected = false;
+    LOG_INFO(BLE, "BLE: Client disconnected\n");
+    bleService->handleDisconnect();
     
     // Automatically restart advertising when client disconnects
     if (bleService) {
       bleService->restartAdvertising();
     }
   }
-};
-
-// Callback classes for BLE characteristics
-class ModeCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  ModeCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleModeWrite(pCharacteristic);
-  }
-};
-
-class StartColorCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  StartColorCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleStartColorWrite(pCharacteristic);
+  
+  void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+    bleService->handleMtuChanged(param->mtu.mtu);
   }
 };
 
-class EndColorCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  EndColorCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleEndColorWrite(pCharacteristic);
-  }
-};
+// Receives characteristic writes
+static AfterburnerBLEService* writeService = nullptr;
 
-class SpeedMsCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
+// Every writable characteristic shares this one callback object; the service
+// finds the handler from the characteristic (see dispatchWrite())
+class WriteCallbacks : public BLECharacteristicCallbacks {
 public:
-  SpeedMsCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
   void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleSpeedMsWrite(pCharacteristic);
+    if (writeService) {
+      writeService->dispatchWrite(pCharacteristic);
+    }
   }
 };
 
-class BrightnessCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  BrightnessCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleBrightnessWrite(pCharacteristic);
-  }
-};
+static WriteCallbacks writeCallbacks;
 
-class NumLedsCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  NumLedsCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleNumLedsWrite(pCharacteristic);
-  }
+const AfterburnerBLEService::WriteRoute AfterburnerBLEService::WRITE_ROUTES[] = {
+  {&AfterburnerBLEService::pSavePresetCharacteristic, &AfterburnerBLEService::handleSavePresetWrite},
+  {&AfterburnerBLEService::pApplySettingsCharacteristic, &AfterburnerBLEService::handleApplySettingsWrite},
+  {&AfterburnerBLEService::pTelemetryCharacteristic, &AfterburnerBLEService::handleTelemetryWrite},
+  {&AfterburnerBLEService::pTopologyCharacteristic, &AfterburnerBLEService::handleTopologyWrite},
+  {&AfterburnerBLEService::pThrottleCalibrationCharacteristic, &AfterburnerBLEService::handleThrottleCalibrationWrite},
+  {&AfterburnerBLEService::pThrottleCalibrationResetCharacteristic, &AfterburnerBLEService::handleThrottleCalibrationResetWrite},
 };
 
-class AbThresholdCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  AbThresholdCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleAbThresholdWrite(pCharacteristic);
-  }
-};
+#define WRITE_ROUTE_COUNT (sizeof(AfterburnerBLEService::WRITE_ROUTES) / sizeof(AfterburnerBLEService::WRITE_ROUTES[0]))
 
-class SavePresetCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  SavePresetCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleSavePresetWrite(pCharacteristic);
+// BLECharacteristic::PROPERTY_* for a settings field's FIELD_PROP_* bits
+static uint32_t toBleProperties(uint8_t properties) {
+  uint32_t bleProperties = 0;
+  if (properties & FIELD_PROP_READ) {
+    bleProperties |= BLECharacteristic::PROPERTY_READ;
   }
-};
-
-// Throttle calibration callback classes
-class ThrottleCalibrationCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  ThrottleCalibrationCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleThrottleCalibrationWrite(pCharacteristic);
+  if (properties & FIELD_PROP_WRITE) {
+    bleProperties |= BLECharacteristic::PROPERTY_WRITE;
   }
-};
-
-class ThrottleCalibrationResetCharacteristicCallbacks : public BLECharacteristicCallbacks {
-private:
-  AfterburnerBLEService* bleService;
-public:
-  ThrottleCalibrationResetCharacteristicCallbacks(AfterburnerBLEService* service) : bleService(service) {}
-  void onWrite(BLECharacteristic* pCharacteristic) {
-    bleService->handleThrottleCalibrationResetWrite(pCharacteristic);
+  if (properties & FIELD_PROP_NOTIFY) {
+    bleProperties |= BLECharacteristic::PROPERTY_NOTIFY;
   }
-};
+  return bleProperties;
+}
 
 AfterburnerBLEService::AfterburnerBLEService(SettingsManager* settings, ThrottleReader* throttle) {
   settingsManager = settings;
@@ -146,18 +103,28 @@ AfterburnerBLEService::AfterburnerBLEService(SettingsManager* settings, Throttle
   pServer = nullptr;
   pService = nullptr;
   lastStatusUpdate = 0;
+  lastStatusFrameUpdate = 0;
+  statusSequence = 0;
+  lastTelemetryUpdate = 0;
   deviceConnected = false;
   
   // Initialize characteristics to nullptr
-  pModeCharacteristic = nullptr;
-  pStartColorCharacteristic = nullptr;
-  pEndColorCharacteristic = nullptr;
-  pSpeedMsCharacteristic = nullptr;
-  pBrightnessCharacteristic = nullptr;
-  pNumLedsCharacteristic = nullptr;
-  pAbThresholdCharacteristic = nullptr;
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    fieldCharacteristics[i] = nullptr;
+  }
   pSavePresetCharacteristic = nullptr;
+  pApplySettingsCharacteristic = nullptr;
   pStatusCharacteristic = nullptr;
+  pStatusFrameCharacteristic = nullptr;
+  pStatusNotifyDescriptor = nullptr;
+  pStatusFrameNotifyDescriptor = nullptr;
+  pTelemetryCharacteristic = nullptr;
+  pDiagnosticsCharacteristic = nullptr;
+  pModeListCharacteristic = nullptr;
+  pTopologyCharacteristic = nullptr;
+  memset(peerAddress, 0, sizeof(peerAddress));
+  lastDiagnosticsChange = 0;
+  advertisingRestartPending = false;
   
   // Initialize throttle calibration characteristics to nullptr
   pThrottleCalibrationCharacteristic = nullptr;
@@ -166,13 +133,18 @@ AfterburnerBLEService::AfterburnerBLEService(SettingsManager* settings, Throttle
 }
 
 void AfterburnerBLEService::begin() {
-  Serial.println("BLE: Starting BLE initialization...");
+  LOG_INFO(BLE, "BLE: Starting BLE initialization...\n");
   
-  // Initialize BLE device
+  // Initialize BLE device (returns once the stack is up)
   BLEDevice::init(DEVICE_NAME);
   
-  // Give BLE stack a moment to initialize
-  delay(100);
+  // Largest MTU we accept when the central starts the MTU exchange
+  BLEDevice::setMTU(BLE_PREFERRED_MTU);
+  
+  // Connection parameter updates are only reported as GAP events
+  gapEventService = this;
+  writeService = this;
+  BLEDevice::setCustomGapHandler(handleGapEvent);
   
   // Create BLE server
   pServer = BLEDevice::createServer();
@@ -199,342 +171,400 @@ void AfterburnerBLEService::begin() {
   // Start advertising
   BLEDevice::startAdvertising();
   
-  Serial.println("BLE service started successfully");
+  LOG_INFO(BLE, "BLE service started successfully\n");
 }
 
 void AfterburnerBLEService::createService() {
-  pService = pServer->createService(SERVICE_UUID);
+  pService = pServer->createService(BLEUUID(SERVICE_UUID), BLE_SERVICE_HANDLES);
   if (!pService) {
-    Serial.println("ERROR: Failed to create BLE service!");
+    LOG_ERROR(BLE, "ERROR: Failed to create BLE service!\n");
     return;
   }
   
-  // Create characteristics
+  // Create characteristics, starting with one per settings field
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    const SettingsField& field = SETTINGS_FIELDS[i];
+    fieldCharacteristics[i] = pService->createCharacteristic(field.uuid, toBleProperties(field.properties));
+    if (!fieldCharacteristics[i]) {
+      LOG_ERROR(BLE, "ERROR: Failed to create %s characteristic!\n", field.name);
+      return;
+    }
+    LOG_DEBUG(BLE, "BLE: %s characteristic created - UUID: %s\n", field.name, field.uuid);
+  }
   
-  pModeCharacteristic = pService->createCharacteristic(
-    MODE_UUID,
-    BLECharacteristic::PROPERTY_READ |
+  pSavePresetCharacteristic = pService->createCharacteristic(
+    SAVE_PRESET_UUID,
     BLECharacteristic::PROPERTY_WRITE
   );
-  if (!pModeCharacteristic) {
-    Serial.println("ERROR: Failed to create mode characteristic!");
+  if (!pSavePresetCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create save preset characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Mode characteristic created - UUID: %s\n", MODE_UUID);
-  Serial.printf("BLE: Mode characteristic properties: READ=YES, WRITE=YES\n");
+  LOG_DEBUG(BLE, "BLE: Save Preset characteristic created - UUID: %s\n", SAVE_PRESET_UUID);
   
-  pStartColorCharacteristic = pService->createCharacteristic(
-    START_COLOR_UUID,
+  pApplySettingsCharacteristic = pService->createCharacteristic(
+    APPLY_SETTINGS_UUID,
     BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_WRITE
+    BLECharacteristic::PROPERTY_WRITE |
+    BLECharacteristic::PROPERTY_NOTIFY
   );
-  if (!pStartColorCharacteristic) {
-    Serial.println("ERROR: Failed to create start color characteristic!");
+  if (!pApplySettingsCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create apply settings characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Start color characteristic created - UUID: %s\n", START_COLOR_UUID);
+  LOG_DEBUG(BLE, "BLE: Apply settings characteristic created - UUID: %s\n", APPLY_SETTINGS_UUID);
   
-  pEndColorCharacteristic = pService->createCharacteristic(
-    END_COLOR_UUID,
-    BLECharacteristic::PROPERTY_READ |
+  // Add descriptor for notifications (required for ESP32 BLE)
+  pApplySettingsCharacteristic->addDescriptor(new BLE2902());
+  
+  // Create throttle calibration characteristics
+  pThrottleCalibrationCharacteristic = pService->createCharacteristic(
+    THROTTLE_CALIBRATION_UUID,
     BLECharacteristic::PROPERTY_WRITE
   );
-  if (!pEndColorCharacteristic) {
-    Serial.println("ERROR: Failed to create end color characteristic!");
+  if (!pThrottleCalibrationCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create throttle calibration characteristic!\n");
     return;
   }
-  Serial.printf("BLE: End color characteristic created - UUID: %s\n", END_COLOR_UUID);
+  LOG_DEBUG(BLE, "BLE: Throttle calibration characteristic created - UUID: %s\n", THROTTLE_CALIBRATION_UUID);
   
-  pSpeedMsCharacteristic = pService->createCharacteristic(
-    SPEED_MS_UUID,
+  pThrottleCalibrationStatusCharacteristic = pService->createCharacteristic(
+    THROTTLE_CALIBRATION_STATUS_UUID,
     BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_WRITE
+    BLECharacteristic::PROPERTY_NOTIFY
   );
-  if (!pSpeedMsCharacteristic) {
-    Serial.println("ERROR: Failed to create speed characteristic!");
+  if (!pThrottleCalibrationStatusCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create throttle calibration status characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Speed characteristic created - UUID: %s\n", SPEED_MS_UUID);
+  LOG_DEBUG(BLE, "BLE: Throttle calibration status characteristic created - UUID: %s\n", THROTTLE_CALIBRATION_STATUS_UUID);
   
-  pBrightnessCharacteristic = pService->createCharacteristic(
-    BRIGHTNESS_UUID,
-    BLECharacteristic::PROPERTY_READ |
+  // Add descriptor for notifications (required for ESP32 BLE)
+  pThrottleCalibrationStatusCharacteristic->addDescriptor(new BLE2902());
+  
+  pThrottleCalibrationResetCharacteristic = pService->createCharacteristic(
+    THROTTLE_CALIBRATION_RESET_UUID,
     BLECharacteristic::PROPERTY_WRITE
   );
-  if (!pBrightnessCharacteristic) {
-    Serial.println("ERROR: Failed to create brightness characteristic!");
+  if (!pThrottleCalibrationResetCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create throttle calibration reset characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Brightness characteristic created - UUID: %s\n", BRIGHTNESS_UUID);
+  LOG_DEBUG(BLE, "BLE: Throttle calibration reset characteristic created - UUID: %s\n", THROTTLE_CALIBRATION_RESET_UUID);
   
-  pNumLedsCharacteristic = pService->createCharacteristic(
-    NUM_LEDS_UUID,
+  pStatusCharacteristic = pService->createCharacteristic(
+    STATUS_UUID,
     BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_WRITE
+    BLECharacteristic::PROPERTY_NOTIFY
   );
-  if (!pNumLedsCharacteristic) {
-    Serial.println("ERROR: Failed to create num LEDs characteristic!");
+  if (!pStatusCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create status characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Num LEDs characteristic created - UUID: %s\n", NUM_LEDS_UUID);
+  LOG_DEBUG(BLE, "BLE: Status characteristic created - UUID: %s\n", STATUS_UUID);
+  
+  // Add descriptor for notifications (required for ESP32 BLE)
+  pStatusNotifyDescriptor = new BLE2902();
+  pStatusCharacteristic->addDescriptor(pStatusNotifyDescriptor);
   
-  pAbThresholdCharacteristic = pService->createCharacteristic(
-    AB_THRESHOLD_UUID,
+  pStatusFrameCharacteristic = pService->createCharacteristic(
+    STATUS_FRAME_UUID,
     BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_WRITE
+    BLECharacteristic::PROPERTY_NOTIFY
   );
-  if (!pAbThresholdCharacteristic) {
-    Serial.println("ERROR: Failed to create AB threshold characteristic!");
+  if (!pStatusFrameCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create status frame characteristic!\n");
     return;
   }
-  Serial.printf("BLE: AB Threshold characteristic created - UUID: %s\n", AB_THRESHOLD_UUID);
+  LOG_DEBUG(BLE, "BLE: Status frame characteristic created - UUID: %s\n", STATUS_FRAME_UUID);
   
-  pSavePresetCharacteristic = pService->createCharacteristic(
-    SAVE_PRESET_UUID,
-    BLECharacteristic::PROPERTY_WRITE
-  );
-  if (!pSavePresetCharacteristic) {
-    Serial.println("ERROR: Failed to create save preset characteristic!");
-    return;
-  }
-  Serial.printf("BLE: Save Preset characteristic created - UUID: %s\n", SAVE_PRESET_UUID);
+  pStatusFrameNotifyDescriptor = new BLE2902();
+  pStatusFrameCharacteristic->addDescriptor(pStatusFrameNotifyDescriptor);
   
-  // Create throttle calibration characteristics
-  pThrottleCalibrationCharacteristic = pService->createCharacteristic(
-    THROTTLE_CALIBRATION_UUID,
-    BLECharacteristic::PROPERTY_WRITE
+  pTelemetryCharacteristic = pService->createCharacteristic(
+    TELEMETRY_UUID,
+    BLECharacteristic::PROPERTY_WRITE |
+    BLECharacteristic::PROPERTY_NOTIFY
   );
-  if (!pThrottleCalibrationCharacteristic) {
-    Serial.println("ERROR: Failed to create throttle calibration characteristic!");
+  if (!pTelemetryCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create telemetry characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Throttle calibration characteristic created - UUID: %s\n", THROTTLE_CALIBRATION_UUID);
+  LOG_DEBUG(BLE, "BLE: Telemetry characteristic created - UUID: %s\n", TELEMETRY_UUID);
   
-  pThrottleCalibrationStatusCharacteristic = pService->createCharacteristic(
-    THROTTLE_CALIBRATION_STATUS_UUID,
+  // Add descriptor for notifications (required for ESP32 BLE)
+  pTelemetryCharacteristic->addDescriptor(new BLE2902());
+  
+  pDiagnosticsCharacteristic = pService->createCharacteristic(
+    DIAGNOSTICS_UUID,
     BLECharacteristic::PROPERTY_READ |
     BLECharacteristic::PROPERTY_NOTIFY
   );
-  if (!pThrottleCalibrationStatusCharacteristic) {
-    Serial.println("ERROR: Failed to create throttle calibration status characteristic!");
+  if (!pDiagnosticsCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create diagnostics characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Throttle calibration status characteristic created - UUID: %s\n", THROTTLE_CALIBRATION_STATUS_UUID);
+  LOG_DEBUG(BLE, "BLE: Diagnostics characteristic created - UUID: %s\n", DIAGNOSTICS_UUID);
   
   // Add descriptor for notifications (required for ESP32 BLE)
-  pThrottleCalibrationStatusCharacteristic->addDescriptor(new BLE2902());
+  pDiagnosticsCharacteristic->addDescriptor(new BLE2902());
   
-  pThrottleCalibrationResetCharacteristic = pService->createCharacteristic(
-    THROTTLE_CALIBRATION_RESET_UUID,
-    BLECharacteristic::PROPERTY_WRITE
+  pModeListCharacteristic = pService->createCharacteristic(
+    MODE_LIST_UUID,
+    BLECharacteristic::PROPERTY_READ
   );
-  if (!pThrottleCalibrationResetCharacteristic) {
-    Serial.println("ERROR: Failed to create throttle calibration reset characteristic!");
+  if (!pModeListCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create mode list characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Throttle calibration reset characteristic created - UUID: %s\n", THROTTLE_CALIBRATION_RESET_UUID);
+  LOG_DEBUG(BLE, "BLE: Mode list characteristic created - UUID: %s\n", MODE_LIST_UUID);
+  setModeListValue();
   
-  pStatusCharacteristic = pService->createCharacteristic(
-    STATUS_UUID,
+  pTopologyCharacteristic = pService->createCharacteristic(
+    TOPOLOGY_UUID,
     BLECharacteristic::PROPERTY_READ |
-    BLECharacteristic::PROPERTY_NOTIFY
+    BLECharacteristic::PROPERTY_WRITE
   );
-  if (!pStatusCharacteristic) {
-    Serial.println("ERROR: Failed to create status characteristic!");
+  if (!pTopologyCharacteristic) {
+    LOG_ERROR(BLE, "ERROR: Failed to create topology characteristic!\n");
     return;
   }
-  Serial.printf("BLE: Status characteristic created - UUID: %s\n", STATUS_UUID);
-  
-  // Add descriptor for notifications (required for ESP32 BLE)
-  pStatusCharacteristic->addDescriptor(new BLE2902());
+  LOG_DEBUG(BLE, "BLE: Topology characteristic created - UUID: %s\n", TOPOLOGY_UUID);
   
-  Serial.println("BLE: All characteristics created successfully");
+  LOG_DEBUG(BLE, "BLE: All characteristics created successfully\n");
   
   // Setup callbacks BEFORE starting the service
-  Serial.println("BLE: Setting up callbacks BEFORE starting service...");
+  LOG_DEBUG(BLE, "BLE: Setting up callbacks BEFORE starting service...\n");
   setupCallbacks();
-  Serial.println("BLE: Callbacks setup completed");
+  LOG_DEBUG(BLE, "BLE: Callbacks setup completed\n");
   
   // Start the service AFTER callbacks are set up
   pService->start();
-  Serial.println("BLE: Service started");
-  
-  // Verify write properties are set correctly
-  uint16_t modeProps = pModeCharacteristic->getProperties();
-  Serial.printf("BLE: Mode characteristic properties: READ=%s, WRITE=%s, NOTIFY=%s\n",
-                (modeProps & BLECharacteristic::PROPERTY_READ) ? "YES" : "NO",
-                (modeProps & BLECharacteristic::PROPERTY_WRITE) ? "YES" : "NO",
-                (modeProps & BLECharacteristic::PROPERTY_NOTIFY) ? "YES" : "NO");
-  
-  // Test if the characteristic can actually be written to
-  Serial.println("BLE: Testing characteristic write capability...");
-  uint8_t testValue = 99;
-  pModeCharacteristic->setValue(&testValue, 1);
-  Serial.println("BLE: Test write completed");
+  LOG_DEBUG(BLE, "BLE: Service started\n");
   
   // Set initial values
   updateCharacteristicValues();
-  Serial.println("BLE: Initial characteristic values set");
+  LOG_DEBUG(BLE, "BLE: Initial characteristic values set\n");
 }
 
 void AfterburnerBLEService::setupCallbacks() {
-  Serial.println("BLE: Setting up callbacks...");
+  LOG_DEBUG(BLE, "BLE: Setting up callbacks...\n");
   
-  // Set up each callback with error checking
-  if (pModeCharacteristic) {
-    pModeCharacteristic->setCallbacks(new ModeCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Mode callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Mode characteristic is null!");
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    fieldCharacteristics[i]->setCallbacks(&writeCallbacks);
   }
-  
-  if (pStartColorCharacteristic) {
-    pStartColorCharacteristic->setCallbacks(new StartColorCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Start color callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Start color characteristic is null!");
+  for (size_t i = 0; i < WRITE_ROUTE_COUNT; i++) {
+    BLECharacteristic* pCharacteristic = this->*WRITE_ROUTES[i].characteristic;
+    if (pCharacteristic) {
+      pCharacteristic->setCallbacks(&writeCallbacks);
+    } else {
+      LOG_ERROR(BLE, "BLE: ❌ ERROR - Writable characteristic %u is null!\n", (unsigned)i);
+    }
   }
   
-  if (pEndColorCharacteristic) {
-    pEndColorCharacteristic->setCallbacks(new EndColorCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ End color callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - End color characteristic is null!");
-  }
+  LOG_DEBUG(BLE, "BLE: All callbacks setup completed successfully\n");
+}
+
+void AfterburnerBLEService::updateCharacteristicValues() {
+  LOG_DEBUG(BLE, "BLE: Setting initial characteristic values...\n");
   
-  if (pSpeedMsCharacteristic) {
-    pSpeedMsCharacteristic->setCallbacks(new SpeedMsCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Speed callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Speed characteristic is null!");
-  }
+  const AfterburnerSettings& settings = settingsManager->getSettings();
+  syncCharacteristicValues(settings);
   
-  if (pBrightnessCharacteristic) {
-    pBrightnessCharacteristic->setCallbacks(new BrightnessCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Brightness callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Brightness characteristic is null!");
-  }
+  uint8_t topologyBytes[TOPOLOGY_MAX_SIZE];
+  size_t topologyLength = encodeTopology(settings.topology, topologyBytes);
+  pTopologyCharacteristic->setValue(topologyBytes, topologyLength);
+  LOG_DEBUG(BLE, "BLE: Topology characteristic set to: %u segment(s)\n", settings.topology.segmentCount);
   
-  if (pNumLedsCharacteristic) {
-    pNumLedsCharacteristic->setCallbacks(new NumLedsCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Num LEDs callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Num LEDs characteristic is null!");
+  LOG_DEBUG(BLE, "BLE: All characteristic values set successfully\n");
+}
+
+// The effect list is fixed at compile time, so this is set once
+void AfterburnerBLEService::setModeListValue() {
+  char modeList[MODE_LIST_MAX_SIZE];
+  size_t length = 0;
+  modeList[length++] = '[';
+  for (uint8_t mode = 0; mode < EFFECT_COUNT; mode++) {
+    int written = snprintf(modeList + length, sizeof(modeList) - length, "%s\"%s\"",
+                           mode ? "," : "", EFFECTS[mode].name);
+    if (written < 0 || length + written >= sizeof(modeList) - 1) {
+      LOG_ERROR(BLE, "BLE: ❌ Mode list does not fit in %d bytes\n", MODE_LIST_MAX_SIZE);
+      break;
+    }
+    length += written;
   }
+  modeList[length++] = ']';
   
-  if (pAbThresholdCharacteristic) {
-    pAbThresholdCharacteristic->setCallbacks(new AbThresholdCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ AB threshold callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - AB threshold characteristic is null!");
+  pModeListCharacteristic->setValue((uint8_t*)modeList, length);
+  LOG_INFO(BLE, "BLE: Mode list: %.*s\n", (int)length, modeList);
+}
+
+// Keeps the per-field characteristics readable after a multi-field write
+void AfterburnerBLEService::syncCharacteristicValues(const AfterburnerSettings& settings) {
+  uint8_t value[SETTINGS_FIELD_MAX_WIDTH];
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    size_t length = encodeField(SETTINGS_FIELDS[i], settings, value);
+    fieldCharacteristics[i]->setValue(value, length);
   }
-  
-  if (pSavePresetCharacteristic) {
-    pSavePresetCharacteristic->setCallbacks(new SavePresetCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Save preset callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Save preset characteristic is null!");
+}
+
+void AfterburnerBLEService::updateStatus(float throttle, uint8_t mode, uint8_t flags, uint16_t ledCurrentMa) {
+  // Each format is only built while a connected client has subscribed to it
+  if (!deviceConnected) {
+    return;
   }
   
-  // Set up throttle calibration callbacks
-  if (pThrottleCalibrationCharacteristic) {
-    pThrottleCalibrationCharacteristic->setCallbacks(new ThrottleCalibrationCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Throttle calibration callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Throttle calibration characteristic is null!");
+  if (pStatusFrameNotifyDescriptor && pStatusFrameNotifyDescriptor->getNotifications() &&
+      millis() - lastStatusFrameUpdate >= getStatusFrameInterval()) {
+    sendStatusFrame(throttle, mode, flags, ledCurrentMa);
+    lastStatusFrameUpdate = millis();
   }
   
-  if (pThrottleCalibrationResetCharacteristic) {
-    pThrottleCalibrationResetCharacteristic->setCallbacks(new ThrottleCalibrationResetCharacteristicCallbacks(this));
-    Serial.println("BLE: ✅ Throttle calibration reset callbacks set");
-  } else {
-    Serial.println("BLE: ❌ ERROR - Throttle calibration reset characteristic is null!");
+  if (pStatusNotifyDescriptor && pStatusNotifyDescriptor->getNotifications() &&
+      millis() - lastStatusUpdate > STATUS_JSON_INTERVAL_MS) {
+    sendStatusJson(throttle, mode);
+    lastStatusUpdate = millis();
   }
-  
-  Serial.println("BLE: All callbacks setup completed successfully");
 }
 
-void AfterburnerBLEService::updateCharacteristicValues() {
-  Serial.println("BLE: Setting initial characteristic values...");
-  
-  AfterburnerSettings& settings = settingsManager->getSettings();
-  
-  // Set initial values
-  pModeCharacteristic->setValue(&settings.mode, 1);
-  Serial.printf("BLE: Mode characteristic set to: %d\n", settings.mode);
-  
-  pStartColorCharacteristic->setValue(settings.startColor, 3);
-  Serial.printf("BLE: Start color characteristic set to: R%d G%d B%d\n", 
-                settings.startColor[0], settings.startColor[1], settings.startColor[2]);
-  
-  pEndColorCharacteristic->setValue(settings.endColor, 3);
-  Serial.printf("BLE: End color characteristic set to: R%d G%d B%d\n", 
-                settings.endColor[0], settings.endColor[1], settings.endColor[2]);
+void AfterburnerBLEService::sendStatusFrame(float throttle, uint8_t mode, uint8_t flags, uint16_t ledCurrentMa) {
+  StatusFrame status;
+  status.sequence = statusSequence++;
+  status.throttlePermille = throttleToPermille(throttle);
+  status.mode = mode;
+  status.flags = flags;
+  status.ledCurrentMa = ledCurrentMa;
+  
+  // Member buffer: setValue() copies it, nothing is allocated per frame
+  size_t length = encodeStatusFrame(status, statusFrameBuffer);
+  pStatusFrameCharacteristic->setValue(statusFrameBuffer, length);
+  pStatusFrameCharacteristic->notify();
+  
+  // Log status updates every 5 seconds to avoid spam
+  static unsigned long lastStatusFrameLog = 0;
+  if (millis() - lastStatusFrameLog > 5000) {
+    LOG_DEBUG(BLE, "BLE: Status frame #%u - Throttle: %u/1000, Mode: %d, Flags: 0x%02X, LEDs: %u mA\n",
+                  status.sequence, status.throttlePermille, mode, flags, status.ledCurrentMa);
+    lastStatusFrameLog = millis();
+  }
+}
+
+// Legacy JSON status for older app versions
+void AfterburnerBLEService::sendStatusJson(float throttle, uint8_t mode) {
+  StaticJsonDocument<256> doc;
+  doc["thr"] = round(throttle * 100) / 100.0; // Round to 2 decimal places
+  doc["mode"] = mode;
   
-  uint8_t speedBytes[2];
-  uint16ToBytes(settings.speedMs, speedBytes);
-  pSpeedMsCharacteristic->setValue(speedBytes, 2);
-  Serial.printf("BLE: Speed characteristic set to: %dms\n", settings.speedMs);
+  // Serialize into a stack buffer rather than a String
+  char statusJson[STATUS_JSON_MAX_SIZE];
+  size_t length = serializeJson(doc, statusJson, sizeof(statusJson));
   
-  pBrightnessCharacteristic->setValue(&settings.brightness, 1);
-  Serial.printf("BLE: Brightness characteristic set to: %d\n", settings.brightness);
+  // A full buffer means the JSON was truncated
+  if (length == 0 || length >= sizeof(statusJson) - 1) {
+    LOG_ERROR(BLE, "BLE: ERROR - Status JSON did not fit (length: %u)\n", (unsigned)length);
+    return;
+  }
   
-  uint8_t numLedsBytes[2];
-  uint16ToBytes(settings.numLeds, numLedsBytes);
-  pNumLedsCharacteristic->setValue(numLedsBytes, 2);
-  Serial.printf("BLE: Num LEDs characteristic set to: %d\n", settings.numLeds);
+  pStatusCharacteristic->setValue((uint8_t*)statusJson, length);
+  pStatusCharacteristic->notify();
   
-  pAbThresholdCharacteristic->setValue(&settings.abThreshold, 1);
-  Serial.printf("BLE: AB Threshold characteristic set to: %d%%\n", settings.abThreshold);
+  // Log status updates every 5 seconds to avoid spam
+  static unsigned long lastStatusLog = 0;
+  if (millis() - lastStatusLog > 5000) {
+    LOG_DEBUG(BLE, "BLE: Status sent - Throttle: %.1f%%, Mode: %d, JSON: '%s'\n",
+                  throttle * 100, mode, statusJson);
+    lastStatusLog = millis();
+  }
+}
+
+void AfterburnerBLEService::updateTelemetry() {
+  // Samples taken while nobody was listening are stale
+  if (!telemetry.isEnabled() || !deviceConnected) {
+    telemetry.discard();
+    return;
+  }
   
-  Serial.println("BLE: All characteristic values set successfully");
+  // One notification per call: at the 50 Hz system rate even a default MTU
+  // (2 samples per batch) keeps up with 60 FPS sampling
+  uint8_t available = telemetry.available();
+  uint8_t batchSize = telemetrySamplesPerBatch(connection.getMtu());
+  if (available == 0 ||
+      (available < batchSize && millis() - lastTelemetryUpdate < TELEMETRY_MAX_LATENCY_MS)) {
+    return;
+  }
   
-  // Verify the characteristics are accessible
-  Serial.println("BLE: Verifying characteristic accessibility...");
-  if (pModeCharacteristic->getValue().length() > 0) {
-    Serial.println("BLE: Mode characteristic is accessible");
-  } else {
-    Serial.println("BLE: ERROR - Mode characteristic not accessible");
+  size_t length = telemetry.encodeBatch(telemetryFrameBuffer, batchSize);
+  if (length > 0) {
+    pTelemetryCharacteristic->setValue(telemetryFrameBuffer, length);
+    pTelemetryCharacteristic->notify();
   }
+  lastTelemetryUpdate = millis();
 }
 
-void AfterburnerBLEService::updateStatus(float throttle, uint8_t mode) {
-  // Send status notification every 200ms
-  if (millis() - lastStatusUpdate > 200) {
-    // Create JSON status with much larger buffer to prevent truncation
-    StaticJsonDocument<256> doc;
-    doc["thr"] = round(throttle * 100) / 100.0; // Round to 2 decimal places
-    doc["mode"] = mode;
-    
-    String statusJson;
-    serializeJson(doc, statusJson);
-    
-    // Verify JSON is complete before sending
-    if (statusJson.length() > 0 && statusJson.endsWith("}")) {
-      // Set the value and notify
-      pStatusCharacteristic->setValue(statusJson.c_str());
-      pStatusCharacteristic->notify();
-      
-      lastStatusUpdate = millis();
-      
-      // Log status updates every 5 seconds to avoid spam
-      static unsigned long lastStatusLog = 0;
-      if (millis() - lastStatusLog > 5000) {
-        Serial.printf("BLE: Status sent - Throttle: %.1f%%, Mode: %d, JSON: '%s'\n", 
-                      throttle * 100, mode, statusJson.c_str());
-        lastStatusLog = millis();
-      }
-    } else {
-      Serial.printf("BLE: ERROR - Invalid JSON generated: '%s' (length: %d)\n", 
-                    statusJson.c_str(), statusJson.length());
+void AfterburnerBLEService::updateConnection(bool active) {
+  ConnectionProfile profile = connection.update(active, millis());
+  if (profile != CONNECTION_PROFILE_NONE && pServer) {
+    bool activeProfile = profile == CONNECTION_PROFILE_ACTIVE;
+    pServer->updateConnParams(peerAddress,
+                              activeProfile ? CONN_ACTIVE_MIN_INTERVAL : CONN_IDLE_MIN_INTERVAL,
+                              activeProfile ? CONN_ACTIVE_MAX_INTERVAL : CONN_IDLE_MAX_INTERVAL,
+                              CONN_LATENCY, CONN_SUPERVISION_TIMEOUT);
+    LOG_INFO(BLE, "BLE: Requested %s connection interval (current %u ms)\n",
+                  connectionProfileName(profile), connection.getIntervalMs());
+  }
+  
+  // Publish whatever the stack reported since the last call
+  uint32_t changeCount = connection.getChangeCount();
+  if (changeCount != lastDiagnosticsChange && pDiagnosticsCharacteristic) {
+    lastDiagnosticsChange = changeCount;
+    size_t length = connection.encodeDiagnostics(diagnosticsBuffer);
+    pDiagnosticsCharacteristic->setValue(diagnosticsBuffer, length);
+    if (connection.isConnected()) {
+      pDiagnosticsCharacteristic->notify();
+      LOG_INFO(BLE, "BLE: Link - MTU %u, interval %u ms, latency %u, timeout %u ms\n",
+                    connection.getMtu(), connection.getIntervalMs(), connection.getLatency(),
+                    connection.getTimeoutUnits() * 10);
     }
   }
 }
 
+// The status frame is never sent faster than the connection interval, so
+// notifications do not queue up while the link is idle
+unsigned long AfterburnerBLEService::getStatusFrameInterval() {
+  uint16_t intervalMs = connection.getIntervalMs();
+  return intervalMs > STATUS_FRAME_INTERVAL_MS ? intervalMs : STATUS_FRAME_INTERVAL_MS;
+}
+
+void AfterburnerBLEService::handleConnect(esp_ble_gatts_cb_param_t* param) {
+  memcpy(peerAddress, param->connect.remote_bda, sizeof(peerAddress));
+  connection.onConnect(param->connect.conn_params.interval, param->connect.conn_params.latency,
+                       param->connect.conn_params.timeout, millis());
+  deviceConnected = true;
+  
+  // Send current calibration status once the client has had time to
+  // discover services and subscribe
+  defer(sendConnectStatusAction, CONNECT_STATUS_DELAY_MS);
+}
+
+void AfterburnerBLEService::handleDisconnect() {
+  deviceConnected = false;
+  connection.onDisconnect();
+  
+  // Telemetry is opt-in per connection
+  telemetry.setEnabled(false);
+}
+
+void AfterburnerBLEService::handleMtuChanged(uint16_t mtu) {
+  connection.onMtuChanged(mtu);
+}
+
+void AfterburnerBLEService::handleConnParamsUpdated(uint16_t interval, uint16_t latency, uint16_t timeout) {
+  connection.onParamsUpdated(interval, latency, timeout);
+}
+
 void AfterburnerBLEService::updateThrottleCalibrationStatus(bool isCalibrated, uint16_t minPWM, uint16_t maxPWM) {
   if (!pThrottleCalibrationStatusCharacteristic) {
-    Serial.println("BLE: ❌ Throttle calibration status characteristic not available");
+    LOG_ERROR(BLE, "BLE: ❌ Throttle calibration status characteristic not available\n");
     return;
   }
   
@@ -550,13 +580,13 @@ void AfterburnerBLEService::updateThrottleCalibrationStatus(bool isCalibrated, u
   // Send notification to connected clients
   pThrottleCalibrationStatusCharacteristic->notify();
   
-  Serial.printf("BLE: 🎯 Throttle calibration status updated and notified - Calibrated: %s, Min: %u, Max: %u\n",
+  LOG_DEBUG(BLE, "BLE: 🎯 Throttle calibration status updated and notified - Calibrated: %s, Min: %u, Max: %u\n",
                 isCalibrated ? "true" : "false", minPWM, maxPWM);
 }
 
 void AfterburnerBLEService::updateThrottleCalibrationProgress(uint16_t minPWM, uint16_t maxPWM, uint8_t minVisits, uint8_t maxVisits) {
   if (!pThrottleCalibrationStatusCharacteristic) {
-    Serial.println("BLE: ❌ Throttle calibration status characteristic not available");
+    LOG_ERROR(BLE, "BLE: ❌ Throttle calibration status characteristic not available\n");
     return;
   }
   
@@ -574,19 +604,19 @@ void AfterburnerBLEService::updateThrottleCalibrationProgress(uint16_t minPWM, u
   // Send notification to connected clients
   pThrottleCalibrationStatusCharacteristic->notify();
   
-  Serial.printf("BLE: 🎯 Calibration progress updated - Min: %u, Max: %u, Min visits: %d/%d, Max visits: %d/%d\n",
+  LOG_DEBUG(BLE, "BLE: 🎯 Calibration progress updated - Min: %u, Max: %u, Min visits: %d/%d, Max visits: %d/%d\n",
                 minPWM, maxPWM, minVisits, MIN_VISITS_REQUIRED, maxVisits, MAX_VISITS_REQUIRED);
 }
 
 void AfterburnerBLEService::notifyCalibrationStatus() {
   if (!pThrottleCalibrationStatusCharacteristic) {
-    Serial.println("BLE: ❌ Throttle calibration status characteristic not available");
+    LOG_ERROR(BLE, "BLE: ❌ Throttle calibration status characteristic not available\n");
     return;
   }
   
   // Send a notification to trigger the app to read the current status
   pThrottleCalibrationStatusCharacteristic->notify();
-  Serial.println("BLE: 🎯 Calibration status notification sent");
+  LOG_DEBUG(BLE, "BLE: 🎯 Calibration status notification sent\n");
 }
 
 bool AfterburnerBLEService::isConnected() {
@@ -594,17 +624,26 @@ bool AfterburnerBLEService::isConnected() {
 }
 
 void AfterburnerBLEService::restartAdvertising() {
-  Serial.println("BLE: Restarting advertising...");
+  // Already stopping, starting or verifying (disconnects and the system
+  // task's advertising check can both get here)
+  if (advertisingRestartPending.exchange(true)) {
+    return;
+  }
+  LOG_INFO(BLE, "BLE: Restarting advertising...\n");
   
-  // Stop current advertising if it's active
+  // Stop current advertising if it's active, and start again once the stack
+  // has cleaned up
   if (BLEDevice::getAdvertising()->isAdvertising()) {
     BLEDevice::stopAdvertising();
-    Serial.println("BLE: Current advertising stopped");
-    
-    // Wait a moment for cleanup
-    delay(100);
+    LOG_INFO(BLE, "BLE: Current advertising stopped\n");
+    defer(startAdvertisingAction, ADVERTISING_RESTART_DELAY_MS);
+    return;
   }
   
+  startAdvertising();
+}
+
+void AfterburnerBLEService::startAdvertising() {
   // Get advertising object and reconfigure
   BLEAdvertising* pAdvertising = BLEDevice::getAdvertising();
   
@@ -622,17 +661,50 @@ void AfterburnerBLEService::restartAdvertising() {
   // Start advertising again
   BLEDevice::startAdvertising();
   
-  // Verify advertising started successfully
-  delay(50); // Give advertising a moment to start
-  if (pAdvertising->isAdvertising()) {
-    Serial.println("BLE: Advertising restarted successfully");
-    Serial.printf("BLE: Device name: %s\n", DEVICE_NAME);
-    Serial.printf("BLE: Service UUID: %s\n", SERVICE_UUID);
+  // Verify advertising started once it has had a moment to come up
+  defer(verifyAdvertisingAction, ADVERTISING_VERIFY_DELAY_MS);
+}
+
+void AfterburnerBLEService::verifyAdvertising() {
+  advertisingRestartPending = false;
+  
+  if (BLEDevice::getAdvertising()->isAdvertising()) {
+    LOG_INFO(BLE, "BLE: Advertising restarted successfully\n");
+    LOG_INFO(BLE, "BLE: Device name: %s\n", DEVICE_NAME);
+    LOG_INFO(BLE, "BLE: Service UUID: %s\n", SERVICE_UUID);
   } else {
-    Serial.println("BLE: ERROR - Failed to start advertising!");
+    LOG_ERROR(BLE, "BLE: ERROR - Failed to start advertising!\n");
   }
 }
 
+void AfterburnerBLEService::sendConnectStatus() {
+  if (!deviceConnected || !settingsManager) {
+    return;
+  }
+  // One copy, so the range and the flag come from the same calibration
+  AfterburnerSettings settings = settingsManager->copySettings();
+  updateThrottleCalibrationStatus(settings.throttleCalibrated, settings.throttleMin, settings.throttleMax);
+}
+
+void AfterburnerBLEService::defer(DeferredAction action, unsigned long delayMs) {
+  if (!deferredActions.schedule(action, this, delayMs)) {
+    LOG_WARN(BLE, "BLE: ⚠️ Deferred action table full - running now\n");
+    action(this);
+  }
+}
+
+void AfterburnerBLEService::sendConnectStatusAction(void* context) {
+  static_cast<AfterburnerBLEService*>(context)->sendConnectStatus();
+}
+
+void AfterburnerBLEService::startAdvertisingAction(void* context) {
+  static_cast<AfterburnerBLEService*>(context)->startAdvertising();
+}
+
+void AfterburnerBLEService::verifyAdvertisingAction(void* context) {
+  static_cast<AfterburnerBLEService*>(context)->verifyAdvertising();
+}
+
 bool AfterburnerBLEService::isAdvertising() {
   if (pServer) {
     // Check if advertising is currently active
@@ -644,229 +716,145 @@ bool AfterburnerBLEService::isAdvertising() {
 void AfterburnerBLEService::ensureAdvertising() {
   // Only ensure advertising if we're not connected
   if (!isConnected()) {
-    if (!isAdvertising()) {
-      Serial.println("BLE: Ensuring advertising is active...");
+    if (!isAdvertising() && !advertisingRestartPending) {
+      LOG_INFO(BLE, "BLE: Ensuring advertising is active...\n");
       restartAdvertising();
     }
   }
 }
 
-void AfterburnerBLEService::handleModeWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🎯 handleModeWrite called!");
-  String value = pCharacteristic->getValue();
-  Serial.printf("BLE: Mode write received - length: %d, value: %d\n", value.length(), value.length() > 0 ? value.charAt(0) : -1);
-  
-  if (value.length() == 1) {
-    uint8_t mode = value.charAt(0);
-    Serial.printf("BLE: Processing mode value: %d\n", mode);
-    
-    if (mode <= 2) {
-      AfterburnerSettings& settings = settingsManager->getSettings();
-      uint8_t oldMode = settings.mode;
-      Serial.printf("BLE: Current mode in settings: %d\n", oldMode);
-      
-      settings.mode = mode;
-      Serial.printf("BLE: Updated mode in settings to: %d\n", settings.mode);
-      
-      settingsManager->saveSettings();
-      Serial.printf("BLE: Mode changed via BLE: %d -> %d (SAVED)\n", oldMode, mode);
-      
-      // Small delay to ensure settings are written
-      delay(10);
-      
-      // Reload settings from flash memory to update the in-memory structure
-      settingsManager->loadSettings();
-      
-      // Verify the setting was actually saved to flash memory
-      settingsManager->verifySettings();
-      
-      // Update the characteristic value so reads return the new value
-      pModeCharacteristic->setValue(&mode, 1);
-      Serial.printf("DEBUG: Updated mode characteristic value to: %d\n", mode);
-      
-      // Also update the status to reflect the new mode immediately
-      Serial.printf("DEBUG: Mode change complete - characteristic updated, settings reloaded, mode: %d\n", mode);
-    } else {
-      Serial.printf("BLE: Invalid mode value received: %d (must be 0-2)\n", mode);
-    }
-  } else {
-    Serial.printf("BLE: Invalid mode data length: %d (expected 1)\n", value.length());
-  }
-}
-
-void AfterburnerBLEService::handleStartColorWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🎨 handleStartColorWrite called!");
-  String value = pCharacteristic->getValue();
-  if (value.length() == 3) {
-    AfterburnerSettings& settings = settingsManager->getSettings();
-    uint8_t oldColor[3] = {settings.startColor[0], settings.startColor[1], settings.startColor[2]};
-    settings.startColor[0] = value.charAt(0);
-    settings.startColor[1] = value.charAt(1);
-    settings.startColor[2] = value.charAt(2);
-    settingsManager->saveSettings();
-    Serial.printf("BLE: Start color changed via BLE: R%d G%d B%d -> R%d G%d B%d\n", 
-                  oldColor[0], oldColor[1], oldColor[2], value.charAt(0), value.charAt(1), value.charAt(2));
-    
-    // Reload settings from flash memory to update the in-memory structure
-    settingsManager->loadSettings();
-    
-    // Verify the setting was actually saved
-    settingsManager->verifySettings();
-  } else {
-    Serial.printf("BLE: Invalid start color data length: %d\n", value.length());
-  }
-}
-
-void AfterburnerBLEService::handleEndColorWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🎨 handleEndColorWrite called!");
-  String value = pCharacteristic->getValue();
-  if (value.length() == 3) {
-    AfterburnerSettings& settings = settingsManager->getSettings();
-    uint8_t oldColor[3] = {settings.endColor[0], settings.endColor[1], settings.endColor[2]};
-    settings.endColor[0] = value.charAt(0);
-    settings.endColor[1] = value.charAt(1);
-    settings.endColor[2] = value.charAt(2);
-    settingsManager->saveSettings();
-    Serial.printf("BLE: End color changed via BLE: R%d G%d B%d -> R%d G%d B%d\n", 
-                  oldColor[0], oldColor[1], oldColor[2], value.charAt(0), value.charAt(1), value.charAt(2));
-    
-    // Reload settings from flash memory to update the in-memory structure
-    settingsManager->loadSettings();
-    
-    // Verify the setting was actually saved
-    settingsManager->verifySettings();
-  } else {
-    Serial.printf("BLE: Invalid end color data length: %d\n", value.length());
-  }
-}
-
-void AfterburnerBLEService::handleSpeedMsWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: ⚡ handleSpeedMsWrite called!");
-  String value = pCharacteristic->getValue();
-  if (value.length() == 2) {
-    uint8_t speedBytes[2] = {value.charAt(0), value.charAt(1)};
-    uint16_t speedMs = bytesToUint16(speedBytes);
-    if (speedMs >= 100 && speedMs <= 5000) {
-      AfterburnerSettings& settings = settingsManager->getSettings();
-      uint16_t oldSpeed = settings.speedMs;
-      settings.speedMs = speedMs;
-      settingsManager->saveSettings();
-      Serial.printf("BLE: Speed changed via BLE: %dms -> %dms\n", oldSpeed, speedMs);
-      
-      // Reload settings from flash memory to update the in-memory structure
-      settingsManager->loadSettings();
-      
-      // Verify the setting was actually saved
-      settingsManager->verifySettings();
-    } else {
-      Serial.printf("BLE: Invalid speed value received: %dms (valid range: 100-5000ms)\n", speedMs);
+void AfterburnerBLEService::dispatchWrite(BLECharacteristic* pCharacteristic) {
+  // Handlers read the stack's own copy of the value; nothing is copied here
+  const uint8_t* data = pCharacteristic->getData();
+  size_t length = pCharacteristic->getLength();
+  uint32_t freeBefore = ESP.getFreeHeap();
+  
+  bool handled = false;
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT && !handled; i++) {
+    if (fieldCharacteristics[i] == pCharacteristic) {
+      handleFieldWrite(i, data, length);
+      handled = true;
     }
-  } else {
-    Serial.printf("BLE: Invalid speed data length: %d\n", value.length());
-  }
-}
-
-void AfterburnerBLEService::handleBrightnessWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 💡 handleBrightnessWrite called!");
-  String value = pCharacteristic->getValue();
-  if (value.length() == 1) {
-    uint8_t brightness = value.charAt(0);
-    if (brightness >= 10 && brightness <= 255) {
-      AfterburnerSettings& settings = settingsManager->getSettings();
-      uint8_t oldBrightness = settings.brightness;
-      settings.brightness = brightness;
-      settingsManager->saveSettings();
-      Serial.printf("BLE: Brightness changed via BLE: %d -> %d\n", oldBrightness, brightness);
-      
-      // Reload settings from flash memory to update the in-memory structure
-      settingsManager->loadSettings();
-      
-      // Verify the setting was actually saved
-      settingsManager->verifySettings();
-    } else {
-      Serial.printf("BLE: Invalid brightness value received: %d (valid range: 10-255)\n", brightness);
+  }
+  for (size_t i = 0; i < WRITE_ROUTE_COUNT && !handled; i++) {
+    if (this->*WRITE_ROUTES[i].characteristic == pCharacteristic) {
+      (this->*WRITE_ROUTES[i].handler)(pCharacteristic, data, length);
+      handled = true;
     }
-  } else {
-    Serial.printf("BLE: Invalid brightness data length: %d\n", value.length());
-  }
-}
-
-void AfterburnerBLEService::handleNumLedsWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🔢 handleNumLedsWrite called!");
-  String value = pCharacteristic->getValue();
-  if (value.length() == 2) {
-    uint8_t numLedsBytes[2] = {value.charAt(0), value.charAt(1)};
-    uint16_t numLeds = bytesToUint16(numLedsBytes);
-    if (numLeds >= 1 && numLeds <= 300) {
-      AfterburnerSettings& settings = settingsManager->getSettings();
-      uint16_t oldNumLeds = settings.numLeds;
-      settings.numLeds = numLeds;
-      settingsManager->saveSettings();
-      Serial.printf("BLE: LED count changed via BLE: %d -> %d\n", oldNumLeds, numLeds);
-      
-      // Reload settings from flash memory to update the in-memory structure
-      settingsManager->loadSettings();
-      
-      // Verify the setting was actually saved
-      settingsManager->verifySettings();
+  }
+  if (!handled) {
+    LOG_WARN(BLE, "BLE: Write to a characteristic without a handler (length %u)\n", (unsigned)length);
+  }
+  
+  heapWatermark.recordWrite(freeBefore, ESP.getFreeHeap());
+}
+
+void AfterburnerBLEService::handleFieldWrite(uint8_t fieldIndex, const uint8_t* data, size_t length) {
+  const SettingsField& field = SETTINGS_FIELDS[fieldIndex];
+  AfterburnerSettings settings;
+  uint16_t oldValue = 0;
+  WriteStatus status = WRITE_OK;
+  settingsManager->modifySettings([&](AfterburnerSettings& current) {
+    oldValue = getFieldValue(field, current);
+    status = applyFieldWrite(field, data, length, current);
+    return status == WRITE_OK;
+  }, &settings);
+  
+  if (status == WRITE_OK) {
+    if (field.width == 3) {
+      LOG_INFO(BLE, "BLE: %s changed via BLE: R%d G%d B%d\n", field.name, data[0], data[1], data[2]);
     } else {
-      Serial.printf("BLE: Invalid LED count value received: %d (valid range: 1-300)\n", numLeds);
+      LOG_INFO(BLE, "BLE: %s changed via BLE: %u -> %u\n", field.name, oldValue, getFieldValue(field, settings));
     }
   } else {
-    Serial.printf("BLE: Invalid LED count data length: %d\n", value.length());
-  }
-}
-
-void AfterburnerBLEService::handleAbThresholdWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🎯 handleAbThresholdWrite called!");
-  String value = pCharacteristic->getValue();
-  if (value.length() == 1) {
-    uint8_t threshold = value.charAt(0);
-    if (threshold <= 100) {
-      AfterburnerSettings& settings = settingsManager->getSettings();
-      uint8_t oldThreshold = settings.abThreshold;
-      settings.abThreshold = threshold;
-      settingsManager->saveSettings();
-      Serial.printf("BLE: AB Threshold changed via BLE: %d%% -> %d%%\n", oldThreshold, threshold);
-      
-      // Reload settings from flash memory to update the in-memory structure
-      settingsManager->loadSettings();
-      
-      // Verify the setting was actually saved
-      settingsManager->verifySettings();
-    } else {
-      Serial.printf("BLE: Invalid AB threshold value received: %d%% (valid range: 0-100%%)\n", threshold);
+    LOG_WARN(BLE, "BLE: Invalid %s write: %s (length %u, valid range: %u-%u)\n", field.name,
+                  writeStatusName(status), (unsigned)length, field.min, field.max);
+  }
+  
+  // Reads return the stored value, so a rejected write is visibly undone
+  uint8_t value[SETTINGS_FIELD_MAX_WIDTH];
+  size_t valueLength = encodeField(field, settings, value);
+  fieldCharacteristics[fieldIndex]->setValue(value, valueLength);
+}
+
+void AfterburnerBLEService::handleSavePresetWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length) {
+  CommandWrite write;
+  WriteStatus status = parseCommandWrite(data, length, 1, 1, write);
+  if (status != WRITE_OK) {
+    LOG_WARN(BLE, "BLE: Invalid save preset command: %s (length %u, value %d)\n", writeStatusName(status),
+                  (unsigned)length, length > 0 ? data[0] : -1);
+    return;
+  }
+  
+  LOG_INFO(BLE, "BLE: Save preset command received via BLE\n");
+  
+  // Flush pending changes now instead of after the quiet period; the
+  // flash write itself runs in the system task, not in this callback
+  settingsManager->requestCommit();
+}
+
+void AfterburnerBLEService::handleApplySettingsWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length) {
+  // Validated as a whole against a copy; published in one update
+  AfterburnerSettings settings;
+  SettingsPacketResult result;
+  settingsManager->modifySettings([&](AfterburnerSettings& current) {
+    result = applySettingsPacket(data, length, current);
+    return result.status == SETTINGS_PACKET_OK;
+  }, &settings);
+  
+  if (result.status == SETTINGS_PACKET_OK) {
+    if (result.flags & SETTINGS_PACKET_FLAG_SAVE) {
+      settingsManager->requestCommit();
     }
+    syncCharacteristicValues(settings);
+    LOG_INFO(BLE, "BLE: 📦 Settings applied - fields 0x%02X%s\n", result.mask,
+                  (result.flags & SETTINGS_PACKET_FLAG_SAVE) ? ", saving now" : "");
   } else {
-    Serial.printf("BLE: Invalid AB threshold data length: %d\n", value.length());
+    LOG_WARN(BLE, "BLE: Settings packet rejected: %s (length %u, fields 0x%02X, rejected 0x%02X)\n",
+                  settingsPacketStatusName(result.status), (unsigned)length, result.mask, result.rejectedField);
   }
+  
+  // The result replaces the written value, so a read or notification acknowledges it
+  uint8_t resultFrame[SETTINGS_PACKET_RESULT_SIZE];
+  size_t resultLength = encodeSettingsPacketResult(result, resultFrame);
+  pCharacteristic->setValue(resultFrame, resultLength);
+  pCharacteristic->notify();
 }
 
-void AfterburnerBLEService::handleSavePresetWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 💾 handleSavePresetWrite called!");
-  String value = pCharacteristic->getValue();
-  Serial.printf("BLE: Save preset command received - length: %d, value: %d\n", 
-                value.length(), value.length() > 0 ? value.charAt(0) : -1);
-  
-  if (value.length() == 1 && value.charAt(0) == 1) {
-    Serial.println("BLE: Save preset command received via BLE");
-    
-    settingsManager->saveSettings();
-    Serial.println("BLE: Settings saved to flash memory SUCCESSFULLY");
-    
-    // Reload settings from flash memory to update the in-memory structure
-    settingsManager->loadSettings();
-    
-    // Verify the settings were actually saved
-    settingsManager->verifySettings();
+void AfterburnerBLEService::handleTopologyWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length) {
+  AfterburnerSettings settings;
+  TopologyStatus status = TOPOLOGY_OK;
+  settingsManager->modifySettings([&](AfterburnerSettings& current) {
+    status = decodeTopology(data, length, current.topology);
+    return status == TOPOLOGY_OK;
+  }, &settings);
+  
+  if (status == TOPOLOGY_OK) {
+    LOG_INFO(BLE, "BLE: Ring topology set - %u segment(s), %u LEDs (applied at next start)\n",
+                  settings.topology.segmentCount, getTopologyLedCount(settings.topology));
   } else {
-    Serial.printf("BLE: Invalid save preset command received: length=%d, value=%d\n", 
-                  value.length(), value.length() > 0 ? value.charAt(0) : -1);
+    LOG_WARN(BLE, "BLE: Topology rejected: %s (length %u)\n", topologyStatusName(status), (unsigned)length);
   }
+  
+  // Reads return the stored layout, so a rejected write is visibly undone
+  uint8_t topologyBytes[TOPOLOGY_MAX_SIZE];
+  size_t topologyLength = encodeTopology(settings.topology, topologyBytes);
+  pCharacteristic->setValue(topologyBytes, topologyLength);
 }
 
-uint16_t AfterburnerBLEService::bytesToUint16(const uint8_t* data) {
-  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+void AfterburnerBLEService::handleTelemetryWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length) {
+  CommandWrite write;
+  WriteStatus status = parseCommandWrite(data, length, 0, 1, write);
+  if (status != WRITE_OK) {
+    LOG_WARN(BLE, "BLE: Invalid telemetry command: %s (length %u, value %d)\n", writeStatusName(status),
+                  (unsigned)length, length > 0 ? data[0] : -1);
+    return;
+  }
+  
+  bool enable = write.command == 1;
+  telemetry.setEnabled(enable);
+  LOG_INFO(BLE, "BLE: 📈 Telemetry %s (%u samples per batch)\n",
+                enable ? "started" : "stopped", telemetrySamplesPerBatch(connection.getMtu()));
 }
 
 void AfterburnerBLEService::uint16ToBytes(uint16_t value, uint8_t* data) {
@@ -875,47 +863,45 @@ void AfterburnerBLEService::uint16ToBytes(uint16_t value, uint8_t* data) {
 }
 
 // Throttle calibration handlers
-void AfterburnerBLEService::handleThrottleCalibrationWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🎯 handleThrottleCalibrationWrite called!");
-  String value = pCharacteristic->getValue();
-  
-  if (value.length() == 1 && value.charAt(0) == 1) {
-    Serial.println("BLE: 🎯 Start throttle calibration command received via BLE");
-    
-    // Update BLE status to show calibration is in progress
-    updateThrottleCalibrationStatus(false, 0, 0);
-    
-    // Start calibration by setting the global flag
-    startThrottleCalibration();
-    
-    Serial.println("BLE: 🎯 Throttle calibration started - move throttle to min and max positions");
-  } else {
-    Serial.printf("BLE: 🎯 Invalid throttle calibration command received: length=%d, value=%d\n", 
-                  value.length(), value.length() > 0 ? value.charAt(0) : -1);
+void AfterburnerBLEService::handleThrottleCalibrationWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length) {
+  CommandWrite write;
+  WriteStatus status = parseCommandWrite(data, length, 1, 1, write);
+  if (status != WRITE_OK) {
+    LOG_WARN(BLE, "BLE: 🎯 Invalid throttle calibration command: %s (length %u, value %d)\n", writeStatusName(status), 
+                  (unsigned)length, length > 0 ? data[0] : -1);
+    return;
   }
+  
+  LOG_INFO(BLE, "BLE: 🎯 Start throttle calibration command received via BLE\n");
+  
+  // Update BLE status to show calibration is in progress
+  updateThrottleCalibrationStatus(false, 0, 0);
+  
+  // Start calibration by setting the global flag
+  startThrottleCalibration();
+  
+  LOG_INFO(BLE, "BLE: 🎯 Throttle calibration started - move throttle to min and max positions\n");
 }
 
-void AfterburnerBLEService::handleThrottleCalibrationResetWrite(BLECharacteristic* pCharacteristic) {
-  Serial.println("BLE: 🔄 handleThrottleCalibrationResetWrite called!");
-  String value = pCharacteristic->getValue();
-  
-  if (value.length() == 1 && value.charAt(0) == 1) {
-    Serial.println("BLE: 🔄 Reset throttle calibration command received via BLE");
-    
-    // Reset throttle calibration to defaults
-    settingsManager->resetThrottleCalibration();
-    
-    // Update throttle reader with default values
-    if (throttleReader) {
-      throttleReader->resetCalibrationToDefaults();
-    }
-    
-    // Update BLE calibration status characteristic with reset values
-    updateThrottleCalibrationStatus(false, DEFAULT_THROTTLE_MIN, DEFAULT_THROTTLE_MAX);
-    
-    Serial.println("BLE: 🔄 Throttle calibration reset to defaults successfully");
-  } else {
-    Serial.printf("BLE: 🔄 Invalid throttle calibration reset command received: length=%d, value=%d\n", 
-                  value.length(), value.length() > 0 ? value.charAt(0) : -1);
+void AfterburnerBLEService::handleThrottleCalibrationResetWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length) {
+  CommandWrite write;
+  WriteStatus status = parseCommandWrite(data, length, 1, 1, write);
+  if (status != WRITE_OK) {
+    LOG_WARN(BLE, "BLE: 🔄 Invalid throttle calibration reset command: %s (length %u, value %d)\n", writeStatusName(status), 
+                  (unsigned)length, length > 0 ? data[0] : -1);
+    return;
   }
+  
+  LOG_INFO(BLE, "BLE: 🔄 Reset throttle calibration command received via BLE\n");
+  
+  // Reset throttle calibration to defaults
+  settingsManager->resetThrottleCalibration();
+  
+  // Update throttle reader with default values (the input task owns it)
+  requestThrottleCalibrationReset();
+  
+  // Update BLE calibration status characteristic with reset values
+  updateThrottleCalibrationStatus(false, DEFAULT_THROTTLE_MIN, DEFAULT_THROTTLE_MAX);
+  
+  LOG_INFO(BLE, "BLE: 🔄 Throttle calibration reset to defaults successfully\n");
 }
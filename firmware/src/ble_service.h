@@ -6,23 +6,23 @@
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include <atomic>
 #include "settings.h"
 #include "constants.h"
+#include "status_frame.h"
+#include "telemetry.h"
+#include "connection_manager.h"
+#include "settings_packet.h"
+#include "deferred_actions.h"
+#include "ble_write.h"
+#include "settings_fields.h"
 
 // Forward declaration to avoid circular dependency
 class ThrottleReader;
 
-// BLE UUIDs
-#define SERVICE_UUID "b5f9a000-2b6c-4f6a-93b1-2f1f5f9ab000"
-#define MODE_UUID "b5f9a001-2b6c-4f6a-93b1-2f1f5f9ab001"
-#define START_COLOR_UUID "b5f9a002-2b6c-4f6a-93b1-2f1f5f9ab002"
-#define END_COLOR_UUID "b5f9a003-2b6c-4f6a-93b1-2f1f5f9ab003"
-#define SPEED_MS_UUID "b5f9a004-2b6c-4f6a-93b1-2f1f5f9ab004"
-#define BRIGHTNESS_UUID "b5f9a005-2b6c-4f6a-93b1-2f1f5f9ab005"
-#define NUM_LEDS_UUID "b5f9a006-2b6c-4f6a-93b1-2f1f5f9ab006"
-#define AB_THRESHOLD_UUID "b5f9a007-2b6c-4f6a-93b1-2f1f5f9ab007"
-#define SAVE_PRESET_UUID "b5f9a008-2b6c-4f6a-93b1-2f1f5f9ab008"
-#define STATUS_UUID "b5f9a009-2b6c-4f6a-93b1-2f1f5f9ab009"
+// Attribute handles reserved for the service (the library default of 15 is
+// too few): 1 for the service, 2 per characteristic, 1 per descriptor
+#define BLE_SERVICE_HANDLES 64
 
 // Device name - defined in constants.h
 
@@ -33,24 +33,45 @@ private:
   SettingsManager* settingsManager;
   ThrottleReader* throttleReader;  // Reference to throttle reader for calibration updates
   
-  // Characteristics
-  BLECharacteristic* pModeCharacteristic;
-  BLECharacteristic* pStartColorCharacteristic;
-  BLECharacteristic* pEndColorCharacteristic;
-  BLECharacteristic* pSpeedMsCharacteristic;
-  BLECharacteristic* pBrightnessCharacteristic;
-  BLECharacteristic* pNumLedsCharacteristic;
-  BLECharacteristic* pAbThresholdCharacteristic;
+  // Characteristics; one per SETTINGS_FIELDS row, in table order
+  BLECharacteristic* fieldCharacteristics[SETTINGS_FIELD_COUNT];
   BLECharacteristic* pSavePresetCharacteristic;
+  BLECharacteristic* pApplySettingsCharacteristic;
   BLECharacteristic* pStatusCharacteristic;
+  BLECharacteristic* pStatusFrameCharacteristic;
+  BLE2902* pStatusNotifyDescriptor;
+  BLE2902* pStatusFrameNotifyDescriptor;
+  BLECharacteristic* pTelemetryCharacteristic;
+  BLECharacteristic* pDiagnosticsCharacteristic;
+  BLECharacteristic* pModeListCharacteristic;
+  BLECharacteristic* pTopologyCharacteristic;
   
   // Throttle calibration characteristics
   BLECharacteristic* pThrottleCalibrationCharacteristic;
   BLECharacteristic* pThrottleCalibrationStatusCharacteristic;
   BLECharacteristic* pThrottleCalibrationResetCharacteristic;
   
-  // Status notification timer
+  // Status notification timers
   unsigned long lastStatusUpdate;
+  unsigned long lastStatusFrameUpdate;
+  uint16_t statusSequence;
+  uint8_t statusFrameBuffer[STATUS_FRAME_SIZE];
+  
+  // Telemetry batches
+  unsigned long lastTelemetryUpdate;
+  uint8_t telemetryFrameBuffer[TELEMETRY_MAX_FRAME_SIZE];
+  
+  // Negotiated MTU / connection parameters
+  ConnectionManager connection;
+  esp_bd_addr_t peerAddress;
+  uint32_t lastDiagnosticsChange;
+  uint8_t diagnosticsBuffer[DIAGNOSTICS_SIZE];
+  
+  // Set from restartAdvertising() until the restart has been verified
+  std::atomic<bool> advertisingRestartPending;
+  
+  // Free heap around characteristic writes (BLE task only)
+  HeapWatermark heapWatermark;
   
 public:
   // Connection state - made public for callback access
@@ -58,7 +79,17 @@ public:
   
   AfterburnerBLEService(SettingsManager* settings, ThrottleReader* throttle);
   void begin();
-  void updateStatus(float throttle, uint8_t mode);
+  // flags are STATUS_FLAG_* bits; ledCurrentMa is the estimated LED current
+  void updateStatus(float throttle, uint8_t mode, uint8_t flags, uint16_t ledCurrentMa);
+  void updateTelemetry();
+  // active: tuning, calibrating or streaming - selects the connection interval
+  void updateConnection(bool active);
+  
+  // BLE stack events (server callbacks and GAP handler)
+  void handleConnect(esp_ble_gatts_cb_param_t* param);
+  void handleDisconnect();
+  void handleMtuChanged(uint16_t mtu);
+  void handleConnParamsUpdated(uint16_t interval, uint16_t latency, uint16_t timeout);
   void updateThrottleCalibrationStatus(bool isCalibrated, uint16_t minPWM, uint16_t maxPWM);
   void updateThrottleCalibrationProgress(uint16_t minPWM, uint16_t maxPWM, uint8_t minVisits, uint8_t maxVisits);
   void notifyCalibrationStatus();
@@ -68,25 +99,48 @@ public:
   bool isAdvertising();
   void ensureAdvertising();
   
-  // Make callback methods public so callback classes can access them
-  void handleModeWrite(BLECharacteristic* pCharacteristic);
-  void handleStartColorWrite(BLECharacteristic* pCharacteristic);
-  void handleEndColorWrite(BLECharacteristic* pCharacteristic);
-  void handleSpeedMsWrite(BLECharacteristic* pCharacteristic);
-  void handleBrightnessWrite(BLECharacteristic* pCharacteristic);
-  void handleNumLedsWrite(BLECharacteristic* pCharacteristic);
-  void handleAbThresholdWrite(BLECharacteristic* pCharacteristic);
-  void handleSavePresetWrite(BLECharacteristic* pCharacteristic);
+  // Called by the shared write callback for every writable characteristic
+  void dispatchWrite(BLECharacteristic* pCharacteristic);
+  const HeapWatermark& getHeapWatermark() const { return heapWatermark; }
+  
+private:
+  // Write handlers get the stack's value buffer, not a copy of it (ble_write.h)
+  typedef void (AfterburnerBLEService::*WriteHandler)(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
+  
+  // Writable characteristics outside SETTINGS_FIELDS and their handlers
+  struct WriteRoute {
+    BLECharacteristic* AfterburnerBLEService::*characteristic;
+    WriteHandler handler;
+  };
+  static const WriteRoute WRITE_ROUTES[];
+  
+  void handleFieldWrite(uint8_t fieldIndex, const uint8_t* data, size_t length);
+  void handleSavePresetWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
+  void handleApplySettingsWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
+  void handleTelemetryWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
+  void handleTopologyWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
   
   // Throttle calibration handlers
-  void handleThrottleCalibrationWrite(BLECharacteristic* pCharacteristic);
-  void handleThrottleCalibrationResetWrite(BLECharacteristic* pCharacteristic);
+  void handleThrottleCalibrationWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
+  void handleThrottleCalibrationResetWrite(BLECharacteristic* pCharacteristic, const uint8_t* data, size_t length);
   
-private:
   void createService();
   void setupCallbacks();
   void updateCharacteristicValues();
-  uint16_t bytesToUint16(const uint8_t* data);
+  void syncCharacteristicValues(const AfterburnerSettings& settings);
+  void setModeListValue();
+  void sendStatusFrame(float throttle, uint8_t mode, uint8_t flags, uint16_t ledCurrentMa);
+  void sendStatusJson(float throttle, uint8_t mode);
+  unsigned long getStatusFrameInterval();
+  
+  // Work that used to delay() in BLE callbacks, run later by the system task
+  void defer(DeferredAction action, unsigned long delayMs);
+  void sendConnectStatus();
+  void startAdvertising();
+  void verifyAdvertising();
+  static void sendConnectStatusAction(void* context);
+  static void startAdvertisingAction(void* context);
+  static void verifyAdvertisingAction(void* context);
   void uint16ToBytes(uint16_t value, uint8_t* data);
 };
 
@@ -0,0 +1,55 @@
+#include "ble_write.h"
+
+WriteStatus parseCommandWrite(const uint8_t* data, size_t length, uint8_t minCommand, uint8_t maxCommand,
+                              CommandWrite& write) {
+  if (length != 1) {
+    return WRITE_BAD_LENGTH;
+  }
+  if (data[0] < minCommand || data[0] > maxCommand) {
+    return WRITE_OUT_OF_RANGE;
+  }
+  write.command = data[0];
+  return WRITE_OK;
+}
+
+const char* writeStatusName(WriteStatus status) {
+  switch (status) {
+    case WRITE_OK:
+      return "ok";
+    case WRITE_BAD_LENGTH:
+      return "bad length";
+    case WRITE_OUT_OF_RANGE:
+      return "out of range";
+  }
+  return "unknown";
+}
+
+HeapWatermark::HeapWatermark() {
+  writes = 0;
+  changedWrites = 0;
+  largestChange = 0;
+}
+
+void HeapWatermark::recordWrite(uint32_t freeBefore, uint32_t freeAfter) {
+  writes++;
+  
+  int32_t change = (int32_t)(freeBefore - freeAfter);
+  if (change != 0) {
+    changedWrites++;
+  }
+  if (change > largestChange) {
+    largestChange = change;
+  }
+}
+
+uint32_t HeapWatermark::getWrites() const {
+  return writes;
+}
+
+uint32_t HeapWatermark::getChangedWrites() const {
+  return changedWrites;
+}
+
+int32_t HeapWatermark::getLargestChange() const {
+  return largestChange;
+}
@@ -0,0 +1,48 @@
+#ifndef BLE_WRITE_H
+#define BLE_WRITE_H
+
+#include <Arduino.h>
+
+// Characteristic writes parsed straight from the BLE stack's value buffer
+// (BLECharacteristic::getData() and getLength()) without a String copy or any
+// other heap allocation. Parsers check the length and range and only write
+// their result on WRITE_OK. Settings fields are parsed from their table row
+// (settings_fields.h).
+enum WriteStatus : uint8_t {
+  WRITE_OK,
+  WRITE_BAD_LENGTH,
+  WRITE_OUT_OF_RANGE
+};
+
+// One-byte command (save, calibrate, telemetry on/off)
+struct CommandWrite {
+  uint8_t command;
+};
+
+// Accepts minCommand-maxCommand
+WriteStatus parseCommandWrite(const uint8_t* data, size_t length, uint8_t minCommand, uint8_t maxCommand,
+                              CommandWrite& write);
+
+const char* writeStatusName(WriteStatus status);
+
+// Free heap around BLE writes. The dispatcher samples the free heap before
+// and after every handler; a write path that leaves the heap different from
+// how it found it is counted. The system task logs this next to the heap's
+// lowest free size since boot (ESP.getMinFreeHeap(), the high-water mark).
+class HeapWatermark {
+private:
+  uint32_t writes;
+  uint32_t changedWrites;  // Writes after which the free heap differed
+  int32_t largestChange;   // Biggest drop in free heap across one write (bytes)
+
+public:
+  HeapWatermark();
+
+  void recordWrite(uint32_t freeBefore, uint32_t freeAfter);
+
+  uint32_t getWrites() const;
+  uint32_t getChangedWrites() const;
+  int32_t getLargestChange() const;
+};
+
+#endif // BLE_WRITE_H
@@ -0,0 +1,97 @@
+#include "connection_manager.h"
+
+ConnectionManager::ConnectionManager() {
+  connected = false;
+  mtu = BLE_DEFAULT_MTU;
+  intervalUnits = 0;
+  latency = 0;
+  timeoutUnits = 0;
+  changeCount = 0;
+  requestedProfile = CONNECTION_PROFILE_NONE;
+  lastRequestTime = 0;
+  lastActiveTime = 0;
+}
+
+void ConnectionManager::onConnect(uint16_t interval, uint16_t connLatency, uint16_t timeout, unsigned long now) {
+  mtu = BLE_DEFAULT_MTU;  // Until the central runs the MTU exchange
+  intervalUnits = interval;
+  latency = connLatency;
+  timeoutUnits = timeout;
+  requestedProfile = CONNECTION_PROFILE_NONE;
+  lastActiveTime = now;   // A new connection is usually followed by reads and writes
+  connected = true;
+  changeCount++;
+}
+
+void ConnectionManager::onDisconnect() {
+  connected = false;
+  mtu = BLE_DEFAULT_MTU;
+  intervalUnits = 0;
+  latency = 0;
+  timeoutUnits = 0;
+  requestedProfile = CONNECTION_PROFILE_NONE;
+  changeCount++;
+}
+
+void ConnectionManager::onMtuChanged(uint16_t newMtu) {
+  mtu = newMtu;
+  changeCount++;
+}
+
+void ConnectionManager::onParamsUpdated(uint16_t interval, uint16_t connLatency, uint16_t timeout) {
+  intervalUnits = interval;
+  latency = connLatency;
+  timeoutUnits = timeout;
+  changeCount++;
+}
+
+ConnectionProfile ConnectionManager::update(bool active, unsigned long now) {
+  if (!connected) {
+    return CONNECTION_PROFILE_NONE;
+  }
+  
+  if (active) {
+    lastActiveTime = now;
+  }
+  
+  ConnectionProfile wanted = (now - lastActiveTime < CONN_IDLE_AFTER_MS) ? CONNECTION_PROFILE_ACTIVE
+                                                                         : CONNECTION_PROFILE_IDLE;
+  if (wanted == requestedProfile) {
+    return CONNECTION_PROFILE_NONE;
+  }
+  
+  // Give the central time to answer before asking again
+  if (requestedProfile != CONNECTION_PROFILE_NONE && now - lastRequestTime < CONN_REQUEST_SPACING_MS) {
+    return CONNECTION_PROFILE_NONE;
+  }
+  
+  requestedProfile = wanted;
+  lastRequestTime = now;
+  return wanted;
+}
+
+static void putUint16(uint8_t* data, uint16_t value) {
+  data[0] = value & 0xFF;
+  data[1] = value >> 8;
+}
+
+size_t ConnectionManager::encodeDiagnostics(uint8_t* frame) const {
+  frame[0] = DIAGNOSTICS_VERSION;
+  frame[1] = connected ? requestedProfile : CONNECTION_PROFILE_NONE;
+  putUint16(frame + 2, mtu);
+  putUint16(frame + 4, intervalUnits);
+  putUint16(frame + 6, latency);
+  putUint16(frame + 8, timeoutUnits);
+  return DIAGNOSTICS_SIZE;
+}
+
+const char* connectionProfileName(ConnectionProfile profile) {
+  switch (profile) {
+    case CONNECTION_PROFILE_IDLE:
+      return "idle";
+    case CONNECTION_PROFILE_ACTIVE:
+      return "active";
+    default:
+      return "none";
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+// Connection profiles requested from the central (intervals in constants.h)
+enum ConnectionProfile : uint8_t {
+  CONNECTION_PROFILE_NONE,    // Not connected / nothing requested yet
+  CONNECTION_PROFILE_IDLE,    // Long interval: saves radio time
+  CONNECTION_PROFILE_ACTIVE   // Short interval: tuning, calibration or telemetry
+};
+
+// Diagnostics characteristic (DIAGNOSTICS_UUID), little-endian:
+//
+//   version (1) | profile (1) | ATT MTU (2) | interval, 1.25 ms units (2) |
+//   peripheral latency (2) | supervision timeout, 10 ms units (2)
+//
+// Fields are only ever appended.
+#define DIAGNOSTICS_VERSION 1
+#define DIAGNOSTICS_SIZE 10
+
+// Tracks what was negotiated on the current connection and decides when to
+// ask for a different connection interval. BLE stack events feed it from the
+// BLE task; update() runs in the system task. Holds no BLE handles, the
+// service performs the actual requests.
+class ConnectionManager {
+private:
+  volatile bool connected;
+  volatile uint16_t mtu;
+  volatile uint16_t intervalUnits;      // 1.25 ms
+  volatile uint16_t latency;            // Connection events
+  volatile uint16_t timeoutUnits;       // 10 ms
+  volatile uint32_t changeCount;        // Bumped on every negotiated change
+
+  ConnectionProfile requestedProfile;
+  unsigned long lastRequestTime;
+  unsigned long lastActiveTime;
+
+public:
+  ConnectionManager();
+
+  // BLE stack events
+  void onConnect(uint16_t interval, uint16_t connLatency, uint16_t timeout, unsigned long now);
+  void onDisconnect();
+  void onMtuChanged(uint16_t newMtu);
+  void onParamsUpdated(uint16_t interval, uint16_t connLatency, uint16_t timeout);
+
+  // Returns the profile to request now, or CONNECTION_PROFILE_NONE if no
+  // request is due. Active wins at once; idle only after CONN_IDLE_AFTER_MS
+  // without activity. Requests are at least CONN_REQUEST_SPACING_MS apart.
+  ConnectionProfile update(bool active, unsigned long now);
+
+  bool isConnected() const { return connected; }
+  uint16_t getMtu() const { return mtu; }
+  uint16_t getIntervalUnits() const { return intervalUnits; }
+  uint16_t getIntervalMs() const { return (uint32_t)intervalUnits * 5 / 4; }
+  uint16_t getLatency() const { return latency; }
+  uint16_t getTimeoutUnits() const { return timeoutUnits; }
+  ConnectionProfile getRequestedProfile() const { return requestedProfile; }
+  uint32_t getChangeCount() const { return changeCount; }
+
+  // Writes a DIAGNOSTICS_SIZE-byte frame; returns its length
+  size_t encodeDiagnostics(uint8_t* frame) const;
+};
+
+const char* connectionProfileName(ConnectionProfile profile);
+
+#endif // CONNECTION_MANAGER_H
@@ -5,6 +5,24 @@
 #define DEVICE_NAME "ABurner"
 #define SERVICE_UUID "b5f9a000-2b6c-4f6a-93b1-2f1f5f9ab000"
 
+// Characteristic UUIDs (settings fields are described in settings_fields.h)
+#define MODE_UUID "b5f9a001-2b6c-4f6a-93b1-2f1f5f9ab001"
+#define START_COLOR_UUID "b5f9a002-2b6c-4f6a-93b1-2f1f5f9ab002"
+#define END_COLOR_UUID "b5f9a003-2b6c-4f6a-93b1-2f1f5f9ab003"
+#define SPEED_MS_UUID "b5f9a004-2b6c-4f6a-93b1-2f1f5f9ab004"
+#define BRIGHTNESS_UUID "b5f9a005-2b6c-4f6a-93b1-2f1f5f9ab005"
+#define NUM_LEDS_UUID "b5f9a006-2b6c-4f6a-93b1-2f1f5f9ab006"
+#define AB_THRESHOLD_UUID "b5f9a007-2b6c-4f6a-93b1-2f1f5f9ab007"
+#define SAVE_PRESET_UUID "b5f9a008-2b6c-4f6a-93b1-2f1f5f9ab008"
+#define STATUS_UUID "b5f9a009-2b6c-4f6a-93b1-2f1f5f9ab009"             // Legacy JSON status
+#define STATUS_FRAME_UUID "b5f9a013-2b6c-4f6a-93b1-2f1f5f9ab013"       // Binary status (status_frame.h)
+#define TELEMETRY_UUID "b5f9a014-2b6c-4f6a-93b1-2f1f5f9ab014"          // Write 1/0 to start/stop, batches notified (telemetry.h)
+#define DIAGNOSTICS_UUID "b5f9a015-2b6c-4f6a-93b1-2f1f5f9ab015"        // Negotiated MTU and interval (connection_manager.h)
+#define APPLY_SETTINGS_UUID "b5f9a016-2b6c-4f6a-93b1-2f1f5f9ab016"     // Several settings in one write (settings_packet.h)
+#define MODE_LIST_UUID "b5f9a017-2b6c-4f6a-93b1-2f1f5f9ab017"          // JSON array of effect names, index == mode (effects.h)
+#define TOPOLOGY_UUID "b5f9a018-2b6c-4f6a-93b1-2f1f5f9ab018"           // Ring segment layout (ring_topology.h)
+#define POWER_BUDGET_UUID "b5f9a019-2b6c-4f6a-93b1-2f1f5f9ab019"       // LED current limit in mA, 0 = none (power_limiter.h)
+
 // Throttle calibration UUIDs
 #define THROTTLE_CALIBRATION_UUID "b5f9a010-2b6c-4f6a-93b1-2f1f5f9ab010"
 #define THROTTLE_CALIBRATION_STATUS_UUID "b5f9a011-2b6c-4f6a-93b1-2f1f5f9ab011"
@@ -15,15 +33,86 @@
 #define THROTTLE_PIN 1         // GPIO1 for throttle input
 #define LED_STRIP_PIN 3        // GPIO3 for LED strip (avoid TX pin conflict)
 
+// Parallel LED outputs. Each output is its own data pin and RMT channel, and
+// all outputs transmit at once, so a frame takes as long as the longest output
+// rather than the whole strip. The ESP32-C3 has two RMT TX channels.
+// A topology segment picks its output with RING_SEGMENT_OUTPUT(n).
+#define LED_OUTPUT_COUNT 2
+#define LED_OUTPUT_PIN_0 LED_STRIP_PIN
+#define LED_OUTPUT_PIN_1 10    // GPIO10, free on the SuperMini
+#define LEGACY_RING_OUTPUTS 1  // 2 = default layout drives ring 2 from LED_OUTPUT_PIN_1
+#define LED_US_PER_LED 30      // WS2812B: 24 bits at 800 kHz
+
+// LED output stage (output_stage.h): effect colours are gamma-corrected to
+// 16-bit linear light, scaled by the brightness setting and temporally
+// dithered down to the strip's 8 bits
+#define OUTPUT_GAMMA 2.2f
+#define OUTPUT_DITHER 1        // 0 = round to the nearest 8-bit level instead
+
+// LED power model (power_limiter.h): WS2812B current per channel at full
+// level, and per LED with all channels off, at 5 V
+#define LED_MA_RED 16
+#define LED_MA_GREEN 11
+#define LED_MA_BLUE 15
+#define LED_MA_IDLE 1
+
 // Timing constants
 #define INITIAL_DELAY_MS 1000
 #define STATUS_UPDATE_INTERVAL_MS 2000
-#define LOOP_DELAY_MS 10
 #define LED_TEST_DELAY_MS 500
 
+// Deferred actions (deferred_actions.h), instead of delay() in callbacks
+#define CONNECT_STATUS_DELAY_MS 500      // Calibration status after a client connects
+#define ADVERTISING_RESTART_DELAY_MS 100 // Between stopping and restarting advertising
+#define ADVERTISING_VERIFY_DELAY_MS 50   // Before checking advertising came back up
+#define CALIBRATION_NOTIFY_DELAY_MS 100  // Second calibration-complete notification
+
+// BLE status notifications (sent only to clients subscribed to that format)
+#define STATUS_FRAME_INTERVAL_MS 20      // Binary status frame, 50 Hz
+#define STATUS_JSON_INTERVAL_MS 200      // Legacy JSON status
+#define STATUS_JSON_MAX_SIZE 64
+#define MODE_LIST_MAX_SIZE 128     // JSON list of effect names on MODE_LIST_UUID
+#define BLE_DEFAULT_MTU 23               // ATT MTU before negotiation
+
+// BLE connection management (connection_manager.h). The central runs the MTU
+// exchange; we advertise BLE_PREFERRED_MTU as our limit. Intervals are in
+// 1.25 ms units, timeouts in 10 ms units, and stay within what iOS accepts.
+#define BLE_PREFERRED_MTU 247
+#define CONN_ACTIVE_MIN_INTERVAL 12      // 15 ms
+#define CONN_ACTIVE_MAX_INTERVAL 24      // 30 ms
+#define CONN_IDLE_MIN_INTERVAL 80        // 100 ms
+#define CONN_IDLE_MAX_INTERVAL 160       // 200 ms
+#define CONN_LATENCY 0
+#define CONN_SUPERVISION_TIMEOUT 400     // 4 s
+#define CONN_IDLE_AFTER_MS 10000         // Quiet time before dropping to the idle interval
+#define CONN_REQUEST_SPACING_MS 2000     // Minimum time between parameter requests
+
+// Render scheduling
+#define TARGET_FPS 60                    // Default render cadence
+#define MIN_TARGET_FPS 10
+#define MAX_TARGET_FPS 120
+#define RENDER_STATS_INTERVAL_MS 10000   // How often achieved FPS and jitter are logged
+#define RENDER_THROTTLE_STEPS 1000       // Throttle resolution the effects render at
+
+// FreeRTOS tasks (Arduino loop() runs at priority 1; higher runs first)
+#define SHOW_TASK_PRIORITY 5             // Starts each LED transmission, then blocks on it
+#define RENDER_TASK_PRIORITY 4
+#define INPUT_TASK_PRIORITY 3
+#define SYSTEM_TASK_PRIORITY 1           // BLE notifications, flash, housekeeping
+#define SHOW_TASK_STACK 3072
+#define RENDER_TASK_STACK 4096
+#define INPUT_TASK_STACK 3072
+#define SYSTEM_TASK_STACK 6144
+#define INPUT_TASK_PERIOD_MS 20          // One RC frame (50 Hz)
+#define SYSTEM_TASK_PERIOD_MS 20
+
 // PWM timeout for throttle reading
 #define PWM_TIMEOUT 25000      // 25ms timeout for PWM read
 
+// Throttle capture uses pin-change interrupts (pwm_capture.h). Define this to
+// fall back to the old blocking pulseIn() reads.
+// #define THROTTLE_PULSEIN_FALLBACK
+
 // Throttle calibration constants
 #define DEFAULT_THROTTLE_MIN 900    // Default min throttle PWM (microseconds)
 #define DEFAULT_THROTTLE_MAX 2000   // Default max throttle PWM (microseconds)
@@ -0,0 +1,60 @@
+#include "deferred_actions.h"
+
+DeferredActions::DeferredActions() {
+  for (uint8_t i = 0; i < DEFERRED_ACTION_SLOTS; i++) {
+    slots[i].state.store(SLOT_FREE);
+    slots[i].action = nullptr;
+    slots[i].context = nullptr;
+    slots[i].dueMs = 0;
+  }
+  droppedActions = 0;
+}
+
+bool DeferredActions::schedule(DeferredAction action, void* context, unsigned long delayMs) {
+  for (uint8_t i = 0; i < DEFERRED_ACTION_SLOTS; i++) {
+    Slot& slot = slots[i];
+    uint8_t expected = SLOT_FREE;
+    if (slot.state.compare_exchange_strong(expected, SLOT_CLAIMED, std::memory_order_acquire)) {
+      slot.action = action;
+      slot.context = context;
+      slot.dueMs = (uint32_t)(millis() + delayMs);
+      slot.state.store(SLOT_PENDING, std::memory_order_release);
+      return true;
+    }
+  }
+  droppedActions++;
+  return false;
+}
+
+void DeferredActions::run(unsigned long now) {
+  for (uint8_t i = 0; i < DEFERRED_ACTION_SLOTS; i++) {
+    Slot& slot = slots[i];
+    if (slot.state.load(std::memory_order_acquire) != SLOT_PENDING) {
+      continue;
+    }
+    // Wrap-safe "now >= due"
+    if ((int32_t)((uint32_t)now - slot.dueMs) < 0) {
+      continue;
+    }
+    
+    // The slot stays taken while the action runs, so an action can schedule
+    // a follow-up without being handed its own slot back mid-call
+    slot.state.store(SLOT_RUNNING, std::memory_order_relaxed);
+    slot.action(slot.context);
+    slot.state.store(SLOT_FREE, std::memory_order_release);
+  }
+}
+
+uint8_t DeferredActions::getPendingCount() const {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < DEFERRED_ACTION_SLOTS; i++) {
+    if (slots[i].state.load(std::memory_order_acquire) == SLOT_PENDING) {
+      count++;
+    }
+  }
+  return count;
+}
+
+uint32_t DeferredActions::getDroppedActions() const {
+  return droppedActions;
+}
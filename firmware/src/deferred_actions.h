@@ -0,0 +1,48 @@
+#ifndef DEFERRED_ACTIONS_H
+#define DEFERRED_ACTIONS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define DEFERRED_ACTION_SLOTS 8
+
+typedef void (*DeferredAction)(void* context);
+
+// "Do this in N ms" without sleeping in the caller. Any task (including BLE
+// stack callbacks) can schedule; the system task runs due actions from its
+// loop, so resolution is one system task period. Slots are claimed with a
+// compare-and-swap, so scheduling never blocks and never takes a lock.
+class DeferredActions {
+private:
+  enum SlotState : uint8_t {
+    SLOT_FREE,
+    SLOT_CLAIMED,   // Being filled by schedule()
+    SLOT_PENDING,   // Waiting for its due time
+    SLOT_RUNNING    // Being run by run()
+  };
+
+  struct Slot {
+    std::atomic<uint8_t> state;
+    DeferredAction action;
+    void* context;
+    uint32_t dueMs;  // millis() wraps at 32 bits on the device
+  };
+
+  Slot slots[DEFERRED_ACTION_SLOTS];
+  volatile uint32_t droppedActions;
+
+public:
+  DeferredActions();
+
+  // Returns false if every slot is taken; the caller should then run the
+  // action itself
+  bool schedule(DeferredAction action, void* context, unsigned long delayMs);
+
+  // Runs every action that is due; called from a single task
+  void run(unsigned long now);
+
+  uint8_t getPendingCount() const;
+  uint32_t getDroppedActions() const;
+};
+
+#endif // DEFERRED_ACTIONS_H
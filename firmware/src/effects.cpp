@@ -0,0 +1,129 @@
+#include "effects.h"
+
+CRGB lerpColor(CRGB color1, CRGB color2, q16_16_t factor) {
+  factor = constrain(factor, 0, Q16_16_ONE);
+  
+  CRGB result;
+  result.r = lerp8(color1.r, color2.r, factor);
+  result.g = lerp8(color1.g, color2.g, factor);
+  result.b = lerp8(color1.b, color2.b, factor);
+  
+  return result;
+}
+
+bool sameFrameOutput(const FrameContext& a, const FrameContext& b) {
+  if (a.effect != b.effect || a.ringCount != b.ringCount) {
+    return false;
+  }
+  if (a.noiseThreshold != b.noiseThreshold || a.noiseTime != b.noiseTime) {
+    return false;
+  }
+  for (uint8_t ring = 0; ring < a.ringCount && ring < MAX_RING_SEGMENTS; ring++) {
+    if (a.ringCoreColor[ring] != b.ringCoreColor[ring]) {
+      return false;
+    }
+  }
+  
+  if (a.afterburnerActive != b.afterburnerActive) {
+    return false;
+  }
+  if (a.afterburnerActive) {
+    if (a.abColor != b.abColor) {
+      return false;
+    }
+    for (uint8_t ring = 0; ring < a.ringCount && ring < MAX_RING_SEGMENTS; ring++) {
+      if (a.ringAbIntensity[ring] != b.ringAbIntensity[ring]) {
+        return false;
+      }
+    }
+  }
+  
+  if (a.sparklesActive != b.sparklesActive) {
+    return false;
+  }
+  return !a.sparklesActive || (a.sparkleChance == b.sparkleChance && a.sparkleTime == b.sparkleTime);
+}
+
+void LinearEffect::prepareFrame(FrameContext& frame, const EffectInput& input) {
+  // Calculate target percentage of LEDs that should be lit (with minimum at idle)
+  float litPercentage = input.throttle;
+  litPercentage = constrain(litPercentage, 0.20f, 1.0f);  // 20% minimum at idle, up to 100%
+  
+  // Calculate threshold for noise-based selection
+  // Lower threshold = more LEDs lit, higher threshold = fewer LEDs lit
+  // We want: at 0.20 throttle -> ~20% lit, at 1.0 throttle -> ~100% lit
+  frame.noiseThreshold = (uint8_t)(255 - (255 * litPercentage));
+  
+  // Calculate flicker speed based on speedMs setting (faster flickering)
+  // Use multiplier to speed up the animation - faster speedMs = faster flicker
+  uint32_t flickerSpeedMultiplier = 5;  // Speed multiplier for faster flickering
+  frame.noiseTime = scaleTime(frame.now, speedToRate(input.settings->speedMs) * flickerSpeedMultiplier);
+  
+  // For color: use raw throttle (not eased) to ensure startColor at idle
+  // At throttle = 0, we want startColor; at throttle = 1, we want endColor
+  CRGB color = lerpColor(input.startColor, input.endColor, input.throttleQ16);
+  for (uint8_t ring = 0; ring < frame.ringCount; ring++) {
+    frame.ringCoreColor[ring] = color;
+  }
+}
+
+void LinearEffect::renderRing(const FrameContext& frame, uint8_t ring, CRGB* ringLeds, uint16_t numLeds) {
+  // LEDs light where per-LED noise exceeds the throttle threshold
+  CRGB color = frame.ringCoreColor[ring];
+  
+  // Use different seed offsets for each ring to ensure independence
+  uint32_t seedOffset = ring * 10000;
+  
+  for (uint16_t localIndex = 0; localIndex < numLeds; localIndex++) {
+    // Generate independent noise for this LED (time-based, so it flickers)
+    uint8_t noise = inoise8((localIndex * 37 + seedOffset), frame.noiseTime + (localIndex * 13));
+  
+    // If noise exceeds threshold, LED is lit
+    if (noise > frame.noiseThreshold) {
+      ringLeds[localIndex] = color;
+    } else {
+      // LED is off
+      ringLeds[localIndex] = CRGB::Black;
+    }
+  }
+}
+
+void EaseEffect::prepareFrame(FrameContext& frame, const EffectInput& input) {
+  // Breathing brightness per ring; use speedMs to control breathing frequency
+  uint16_t breathingAngle = scaleAngle(frame.now, speedToAngleRate(input.settings->speedMs));
+  
+  // Interpolate color based on eased throttle (SAME for both rings)
+  // This creates the transition from 0% to 100% throttle
+  CRGB color = lerpColor(input.startColor, input.endColor, easeQ16(input.throttleQ16));
+  
+  for (uint8_t ring = 0; ring < frame.ringCount; ring++) {
+    // Per-ring phase offset (180° on the second legacy ring) for contrast
+    uint16_t phaseOffset = frame.ringPhase[ring];
+    // Enhanced breathing effect: 0.7 to 1.0 range (30% variation for better visibility)
+    q16_16_t breathing = sinRangeQ16(breathingAngle + phaseOffset, Q16_16(0.7), Q16_16(0.3));
+    uint8_t currentBrightness = (uint8_t)((255 * breathing) >> 16);
+  
+    frame.ringCoreColor[ring] = color;
+    frame.ringCoreColor[ring].nscale8(currentBrightness);
+  }
+}
+
+void EaseEffect::renderRing(const FrameContext& frame, uint8_t ring, CRGB* ringLeds, uint16_t numLeds) {
+  // Breathing color is uniform per ring
+  fill_solid(ringLeds, numLeds, frame.ringCoreColor[ring]);
+}
+
+void PulseEffect::prepareFrame(FrameContext& frame, const EffectInput& input) {
+  EaseEffect::prepareFrame(frame, input);
+  if (!frame.afterburnerActive) {
+    return;
+  }
+  
+  // Pulse the afterburner overlay, each ring at its phase offset
+  uint16_t pulseAngle = scaleAngle(frame.now, speedToAngleRate(input.settings->speedMs));
+  for (uint8_t ring = 0; ring < frame.ringCount; ring++) {
+    uint16_t phaseOffset = frame.ringPhase[ring];
+    q16_16_t pulse = sinRangeQ16(pulseAngle + phaseOffset, Q16_16(0.6), Q16_16(0.4));
+    frame.ringAbIntensity[ring] = mulQ16(frame.ringAbIntensity[ring], pulse);
+  }
+}
@@ -0,0 +1,120 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "settings.h"
+#include "fixed_point.h"
+#include "ring_topology.h"
+
+struct EffectDescriptor;
+
+// Everything that depends only on the frame or the ring, computed once at the
+// start of render() so the per-LED loops only do per-LED work
+struct FrameContext {
+  unsigned long now;                    // Single animation timestamp for the frame (ms)
+  const EffectDescriptor* effect;       // Effect selected by settings.mode
+
+  // Rings (topology segments), fixed between begin() calls
+  uint8_t ringCount;
+  uint16_t ringPhase[MAX_RING_SEGMENTS];  // Breathing and pulse phase offset, 65536 == full turn
+
+  // Core effect
+  CRGB ringCoreColor[MAX_RING_SEGMENTS];  // Start->end blend with ring breathing applied
+  uint8_t noiseThreshold;               // Linear mode: LEDs with noise above this are lit
+  uint32_t noiseTime;                   // Linear mode noise clock
+
+  // Afterburner overlay
+  bool afterburnerActive;
+  CRGB abColor;                         // Blended afterburner core color
+  q16_16_t ringAbIntensity[MAX_RING_SEGMENTS];  // Overlay intensity with ring pulse applied
+
+  // Sparkles
+  bool sparklesActive;
+  uint16_t sparkleChance;               // Per-mille chance threshold
+  uint32_t sparkleTime;                 // Sparkle clock
+};
+
+// Per-frame inputs handed to an effect's prepareFrame()
+struct EffectInput {
+  const AfterburnerSettings* settings;
+  float throttle;
+  q16_16_t throttleQ16;
+  CRGB startColor;
+  CRGB endColor;
+};
+
+// An effect is a class with two static hooks:
+//
+//   prepareFrame(frame, input)  - once per frame, after the shared afterburner
+//                                 values are in frame; fills the core colour
+//                                 fields and may adjust the overlay intensity
+//   renderRing(frame, ring, leds, count)
+//                               - once per ring (topology segment); writes the
+//                                 core effect for every LED of the ring (the
+//                                 overlay and sparkles are added afterwards)
+//
+// The effect is looked up once per frame; the per-LED loops never branch on
+// the mode. Effects render at full scale: the brightness setting, gamma and
+// the power limit are applied afterwards by OutputStage::encode().
+
+// Mode 0: noise-selected LEDs, more of them lit as the throttle rises
+class LinearEffect {
+public:
+  static constexpr const char* NAME = "Linear";
+  static void prepareFrame(FrameContext& frame, const EffectInput& input);
+  static void renderRing(const FrameContext& frame, uint8_t ring, CRGB* ringLeds, uint16_t numLeds);
+};
+
+// Mode 1: eased colour blend, each ring breathing at its phase offset
+class EaseEffect {
+public:
+  static constexpr const char* NAME = "Ease";
+  static void prepareFrame(FrameContext& frame, const EffectInput& input);
+  static void renderRing(const FrameContext& frame, uint8_t ring, CRGB* ringLeds, uint16_t numLeds);
+};
+
+// Mode 2: Ease with the afterburner overlay pulsing at the speed setting
+class PulseEffect : public EaseEffect {
+public:
+  static constexpr const char* NAME = "Pulse";
+  static void prepareFrame(FrameContext& frame, const EffectInput& input);
+};
+
+// True if two prepared frames render the same LEDs on the same topology: the
+// effect, its phase (ring colours, noise clock) and the overlay all match
+bool sameFrameOutput(const FrameContext& a, const FrameContext& b);
+
+// Integer blend color1 -> color2 by a Q16.16 factor (clamped to [0, 1])
+CRGB lerpColor(CRGB color1, CRGB color2, q16_16_t factor);
+
+struct EffectDescriptor {
+  const char* name;
+  void (*prepareFrame)(FrameContext& frame, const EffectInput& input);
+  void (*renderRing)(const FrameContext& frame, uint8_t ring, CRGB* ringLeds, uint16_t numLeds);
+};
+
+template <typename Effect>
+constexpr EffectDescriptor registerEffect() {
+  return {Effect::NAME, &Effect::prepareFrame, &Effect::renderRing};
+}
+
+// The index is the mode number stored in NVS and sent over BLE: only append
+inline constexpr EffectDescriptor EFFECTS[] = {
+  registerEffect<LinearEffect>(),
+  registerEffect<EaseEffect>(),
+  registerEffect<PulseEffect>(),
+};
+
+inline constexpr uint8_t EFFECT_COUNT = sizeof(EFFECTS) / sizeof(EFFECTS[0]);
+
+inline bool isValidEffect(uint8_t mode) {
+  return mode < EFFECT_COUNT;
+}
+
+// Unknown modes (e.g. a record written by newer firmware) render as mode 0
+inline const EffectDescriptor& getEffect(uint8_t mode) {
+  return EFFECTS[isValidEffect(mode) ? mode : 0];
+}
+
+#endif // EFFECTS_H
@@ -0,0 +1,134 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <Arduino.h>
+
+// Fixed-point math for the LED render path.
+// The ESP32-C3 is a RISC-V core without an FPU, so anything evaluated per LED
+// stays in integers. Floats are only converted once per frame.
+//
+//   q16_16_t - signed Q16.16, 1.0 == 65536 (blend factors, intensities)
+//   angles   - uint16_t turns, 65536 == one full period (2*pi)
+
+typedef int32_t q16_16_t;
+
+#define Q16_16_ONE 65536L
+#define ANGLE_HALF_TURN 32768U
+
+// Compile-time conversion of a constant to Q16.16 (rounded)
+#define Q16_16(x) ((q16_16_t)((x) * 65536.0 + 0.5))
+
+// Sine table, one full period in 256 steps, Q1.15
+static const int16_t SIN_TABLE_Q15[256] = {
+       0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,
+    9512,  10278,  11039,  11793,  12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+   18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,  23170,  23731,  24279,  24811,
+   25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+   30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,
+   32609,  32678,  32728,  32757,  32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+   32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,  30273,  29956,  29621,  29268,
+   28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+   23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,
+   15446,  14732,  14010,  13279,  12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+    6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,      0,   -804,  -1608,  -2410,
+   -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+  -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159,
+  -20787, -21403, -22005, -22594, -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+  -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113,
+  -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+  -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580,
+  -31356, -31113, -30852, -30571, -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+  -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731, -23170, -22594, -22005, -21403,
+  -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+  -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,  -4808,  -4011,
+   -3212,  -2410,  -1608,   -804
+};
+
+// Easing curve pow(t, 1.2) sampled at t = i/256, Q16.16 (t = 1.0 is handled separately)
+static const uint16_t EASE_TABLE_Q16[256] = {
+       0,     84,    194,    315,    445,    582,    725,    872,   1024,   1179,   1338,   1500,
+    1665,   1833,   2004,   2177,   2352,   2530,   2709,   2891,   3074,   3260,   3447,   3636,
+    3826,   4019,   4212,   4407,   4604,   4802,   5001,   5202,   5404,   5608,   5812,   6018,
+    6225,   6433,   6642,   6852,   7064,   7276,   7490,   7704,   7920,   8136,   8354,   8572,
+    8791,   9012,   9233,   9455,   9678,   9902,  10126,  10352,  10578,  10805,  11033,  11261,
+   11491,  11721,  11952,  12184,  12416,  12649,  12883,  13118,  13353,  13589,  13826,  14063,
+   14301,  14540,  14779,  15019,  15260,  15501,  15743,  15986,  16229,  16473,  16717,  16962,
+   17207,  17453,  17700,  17947,  18195,  18444,  18693,  18942,  19192,  19443,  19694,  19946,
+   20198,  20451,  20704,  20958,  21212,  21467,  21722,  21978,  22234,  22491,  22748,  23006,
+   23264,  23523,  23782,  24042,  24302,  24563,  24824,  25085,  25347,  25610,  25873,  26136,
+   26400,  26664,  26929,  27194,  27459,  27725,  27992,  28258,  28526,  28793,  29061,  29330,
+   29599,  29868,  30138,  30408,  30678,  30949,  31221,  31492,  31764,  32037,  32310,  32583,
+   32856,  33130,  33405,  33680,  33955,  34230,  34506,  34782,  35059,  35336,  35613,  35891,
+   36169,  36447,  36726,  37005,  37285,  37564,  37845,  38125,  38406,  38687,  38969,  39251,
+   39533,  39815,  40098,  40381,  40665,  40949,  41233,  41518,  41802,  42088,  42373,  42659,
+   42945,  43232,  43518,  43805,  44093,  44381,  44669,  44957,  45246,  45535,  45824,  46113,
+   46403,  46693,  46984,  47275,  47566,  47857,  48149,  48441,  48733,  49026,  49318,  49612,
+   49905,  50199,  50493,  50787,  51082,  51376,  51671,  51967,  52263,  52559,  52855,  53151,
+   53448,  53745,  54043,  54340,  54638,  54936,  55235,  55533,  55832,  56132,  56431,  56731,
+   57031,  57331,  57632,  57933,  58234,  58535,  58837,  59138,  59441,  59743,  60046,  60348,
+   60652,  60955,  61259,  61562,  61867,  62171,  62476,  62781,  63086,  63391,  63697,  64003,
+   64309,  64615,  64922,  65228
+};
+
+// Converts a 0.0-1.0 float to Q16.16, clamping out-of-range and NaN inputs to the range
+inline q16_16_t unitFloatToQ16(float value) {
+  if (!(value > 0.0f)) return 0;
+  if (value >= 1.0f) return Q16_16_ONE;
+  return (q16_16_t)(value * 65536.0f);
+}
+
+inline q16_16_t mulQ16(q16_16_t a, q16_16_t b) {
+  return (q16_16_t)(((int64_t)a * b) >> 16);
+}
+
+// Sine of a 16-bit angle in Q1.15, linearly interpolated between table entries
+inline int16_t sinQ15(uint16_t angle) {
+  uint8_t index = angle >> 8;
+  int32_t frac = angle & 0xFF;
+  int32_t a = SIN_TABLE_Q15[index];
+  int32_t b = SIN_TABLE_Q15[(uint8_t)(index + 1)];
+  return (int16_t)(a + (((b - a) * frac) >> 8));
+}
+
+// center + amplitude * sin(angle), all Q16.16
+inline q16_16_t sinRangeQ16(uint16_t angle, q16_16_t center, q16_16_t amplitude) {
+  return center + (q16_16_t)(((int64_t)sinQ15(angle) * amplitude) >> 15);
+}
+
+// pow(t, 1.2) for t in Q16.16, linearly interpolated between table entries
+inline q16_16_t easeQ16(q16_16_t t) {
+  if (t <= 0) return 0;
+  if (t >= Q16_16_ONE) return Q16_16_ONE;
+  uint8_t index = t >> 8;
+  int32_t frac = t & 0xFF;
+  int32_t a = EASE_TABLE_Q16[index];
+  int32_t b = (index == 255) ? Q16_16_ONE : EASE_TABLE_Q16[index + 1];
+  return a + (((b - a) * frac) >> 8);
+}
+
+// Integer blend a -> b by a Q16.16 factor in [0, 1]
+inline uint8_t lerp8(uint8_t a, uint8_t b, q16_16_t factor) {
+  return (uint8_t)(a + ((((int32_t)b - (int32_t)a) * factor) >> 16));
+}
+
+// Animation clocks: a speedMs setting advances effects at 1000/speedMs units
+// per millisecond. Rates are Q16.16 so the per-LED math stays in integers.
+inline uint32_t speedToRate(uint16_t speedMs) {
+  return 65536000UL / speedMs;
+}
+
+inline uint32_t scaleTime(unsigned long ms, uint32_t rate) {
+  return (uint32_t)(((uint64_t)ms * rate) >> 16);
+}
+
+// The same rate for sine-driven effects: 1000/speedMs radians per millisecond,
+// expressed as 16-bit angle units per millisecond in Q16.16
+inline uint64_t speedToAngleRate(uint16_t speedMs) {
+  return 683565275576ULL / speedMs;  // 1000 * 65536 / (2*pi), Q16.16
+}
+
+inline uint16_t scaleAngle(unsigned long ms, uint64_t angleRate) {
+  return (uint16_t)(((uint64_t)ms * angleRate) >> 16);
+}
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,87 @@
+#include "frame_timings.h"
+
+FrameTimings::FrameTimings() {
+  reset();
+}
+
+void FrameTimings::reset() {
+  windowFrames = 0;
+  windowSentFrames = 0;
+  windowRenderUs = 0;
+  windowTransmitUs = 0;
+  windowWaitUs = 0;
+  windowIdleUs = 0;
+  windowSkipped = 0;
+  renderUs = 0;
+  transmitUs = 0;
+  waitUs = 0;
+  idleUs = 0;
+  skipPermille = 0;
+  maxTransmitUs = 0;
+}
+
+void FrameTimings::record(uint32_t frameRenderUs, uint32_t frameTransmitUs, uint32_t frameWaitUs, uint32_t framePeriodUs) {
+  windowSentFrames++;
+  windowTransmitUs += frameTransmitUs;
+  if (frameTransmitUs > maxTransmitUs) {
+    maxTransmitUs = frameTransmitUs;
+  }
+  addFrame(frameRenderUs, frameWaitUs, framePeriodUs);
+}
+
+void FrameTimings::recordSkipped(uint32_t frameRenderUs, uint32_t framePeriodUs) {
+  windowSkipped++;
+  addFrame(frameRenderUs, 0, framePeriodUs);
+}
+
+void FrameTimings::addFrame(uint32_t frameRenderUs, uint32_t frameWaitUs, uint32_t framePeriodUs) {
+  uint32_t busyUs = frameRenderUs + frameWaitUs;
+  uint32_t frameIdleUs = busyUs < framePeriodUs ? framePeriodUs - busyUs : 0;
+  
+  windowFrames++;
+  windowRenderUs += frameRenderUs;
+  windowWaitUs += frameWaitUs;
+  windowIdleUs += frameIdleUs;
+  
+  if (windowFrames >= FRAME_TIMINGS_WINDOW) {
+    renderUs = windowRenderUs / windowFrames;
+    if (windowSentFrames > 0) {
+      transmitUs = windowTransmitUs / windowSentFrames;
+    }
+    waitUs = windowWaitUs / windowFrames;
+    idleUs = windowIdleUs / windowFrames;
+    skipPermille = windowSkipped * 1000 / windowFrames;
+    
+    windowFrames = 0;
+    windowSentFrames = 0;
+    windowRenderUs = 0;
+    windowTransmitUs = 0;
+    windowWaitUs = 0;
+    windowIdleUs = 0;
+    windowSkipped = 0;
+  }
+}
+
+uint32_t FrameTimings::getRenderUs() const {
+  return renderUs;
+}
+
+uint32_t FrameTimings::getTransmitUs() const {
+  return transmitUs;
+}
+
+uint32_t FrameTimings::getWaitUs() const {
+  return waitUs;
+}
+
+uint32_t FrameTimings::getIdleUs() const {
+  return idleUs;
+}
+
+uint16_t FrameTimings::getSkipPermille() const {
+  return skipPermille;
+}
+
+uint32_t FrameTimings::getMaxTransmitUs() const {
+  return maxTransmitUs;
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_TIMINGS_H
+#define FRAME_TIMINGS_H
+
+#include <Arduino.h>
+
+#define FRAME_TIMINGS_WINDOW 60  // Frames per averaging window, 1 s at 60 FPS
+
+// Where each frame period goes in the double-buffered LED pipeline:
+//
+//   render    renderFrame() into the back buffer
+//   transmit  show() of the previous frame, in the show task
+//   wait      render task blocked on that transmission before swapping
+//   idle      the rest of the period
+//
+// Transmission overlaps the next render, so render + wait + idle make up the
+// frame period and transmit is not part of that sum. A skipped frame (nothing
+// changed, see LEDEffects::renderFrameIfChanged()) sends nothing and does not
+// wait, so it counts towards render, wait and idle but is left out of the
+// transmit average. Recorded by the render task; other tasks read the averages
+// of the last completed window.
+class FrameTimings {
+private:
+  // Current window
+  uint32_t windowFrames;
+  uint32_t windowSentFrames;
+  uint32_t windowRenderUs;
+  uint32_t windowTransmitUs;
+  uint32_t windowWaitUs;
+  uint32_t windowIdleUs;
+  uint32_t windowSkipped;
+
+  // Averages of the last completed window
+  uint32_t renderUs;
+  uint32_t transmitUs;
+  uint32_t waitUs;
+  uint32_t idleUs;
+  uint16_t skipPermille;
+
+  uint32_t maxTransmitUs;
+
+  void addFrame(uint32_t frameRenderUs, uint32_t frameWaitUs, uint32_t framePeriodUs);
+
+public:
+  FrameTimings();
+  void reset();
+
+  // One frame: transmitUs is the previous frame's show(), which had finished
+  // by the time the render task stopped waiting
+  void record(uint32_t frameRenderUs, uint32_t frameTransmitUs, uint32_t frameWaitUs, uint32_t framePeriodUs);
+  // One unchanged frame: renderUs is the time spent finding that out
+  void recordSkipped(uint32_t frameRenderUs, uint32_t framePeriodUs);
+
+  uint32_t getRenderUs() const;
+  uint32_t getTransmitUs() const;  // Per frame sent; kept if a whole window was skipped
+  uint32_t getWaitUs() const;
+  uint32_t getIdleUs() const;
+  uint16_t getSkipPermille() const;   // Share of frames skipped
+  uint32_t getMaxTransmitUs() const;  // Longest show() since reset()
+};
+
+#endif // FRAME_TIMINGS_H
@@ -1,5 +1,4 @@
 #include "led_effects.h"
-#include <math.h>
 
 /*
  * Speed Setting Usage:
@@ -26,16 +25,37 @@
  *    - 5000ms = Few sparkles
  */
 
-// Fallback for M_PI if not defined
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+// FastLED keeps every controller it has handed out, so each output is
+// registered once and later layouts only re-point it (setLeds)
+static CLEDController* ledOutputs[LED_OUTPUT_COUNT] = {};
+
+static CLEDController& addOutput(uint8_t output, CRGB* data, uint16_t count) {
+  switch (output) {
+    case 1:
+      return FastLED.addLeds<WS2812B, LED_OUTPUT_PIN_1, GRB>(data, count);
+    default:
+      return FastLED.addLeds<WS2812B, LED_OUTPUT_PIN_0, GRB>(data, count);
+  }
+}
 
 LEDEffects::LEDEffects() {
+  ledBuffers[0] = nullptr;
+  ledBuffers[1] = nullptr;
   leds = nullptr;
-  numLeds = 0;
+  backLeds = nullptr;
+  frontLeds = nullptr;
+  spatialProfile = nullptr;
+  memset(&topology, 0, sizeof(topology));
+  totalLeds = 0;
   lastUpdate = 0;
-  noiseOffset = 0;
+  frame = FrameContext();
+  frame.effect = &getEffect(DEFAULT_MODE);
+  frame.ringCount = 0;
+  frame.afterburnerActive = false;
+  frame.sparklesActive = false;
+  renderedFrame = frame;
+  renderedSettingsVersion = 0;
+  renderedFrameValid = false;
   
   // Initialize afterburner colors
   abCoreColor1 = CRGB(90, 60, 255);   // Violet-blue
@@ -43,274 +63,291 @@ LEDEffects::LEDEffects() {
 }
 
 LEDEffects::~LEDEffects() {
-  if (leds) {
-    delete[] leds;
+  freeBuffers();
+  if (spatialProfile) {
+    delete[] spatialProfile;
   }
 }
 
-void LEDEffects::begin(uint16_t totalLedCount) {
+void LEDEffects::freeBuffers() {
   if (leds) {
     delete[] leds;
+    leds = nullptr;
+  }
+  for (uint8_t i = 0; i < 2; i++) {
+    if (ledBuffers[i]) {
+      delete[] ledBuffers[i];
+      ledBuffers[i] = nullptr;
+    }
+  }
+}
+
+void LEDEffects::begin(const RingTopology& ringTopology) {
+  freeBuffers();
+  if (spatialProfile) {
+    delete[] spatialProfile;
+  }
+  
+  topology = ringTopology;
+  if (topology.segmentCount > MAX_RING_SEGMENTS) {
+    topology.segmentCount = MAX_RING_SEGMENTS;
   }
+  totalLeds = getTopologyLedCount(topology);
   
-  // Store LEDs per ring (total should be numLeds * 2 for dual turbines)
-  numLeds = totalLedCount / 2;
-  uint16_t actualTotalLeds = numLeds * 2;  // Ensure we use exactly 2 rings
+  // Effect colours, then the front buffer on the outputs and the back buffer for the next frame
+  leds = new CRGB[totalLeds];
+  fill_solid(leds, totalLeds, CRGB::Black);
+  for (uint8_t i = 0; i < 2; i++) {
+    ledBuffers[i] = new CRGB[totalLeds];
+    fill_solid(ledBuffers[i], totalLeds, CRGB::Black);
+  }
+  frontLeds = ledBuffers[0];
+  backLeds = ledBuffers[1];
+  output.begin(totalLeds);
+  spatialProfile = new uint8_t[totalLeds];
+  buildSpatialProfile();
   
-  leds = new CRGB[actualTotalLeds];
+  // Per-ring constants the effects read every frame
+  frame.ringCount = topology.segmentCount;
+  for (uint8_t ring = 0; ring < frame.ringCount; ring++) {
+    frame.ringPhase[ring] = topology.segments[ring].phaseOffset;
+  }
   
-  FastLED.addLeds<WS2812B, LED_STRIP_PIN, GRB>(leds, actualTotalLeds);
-  FastLED.setBrightness(200);
-  FastLED.clear();
+  // Brightness and dithering are done by the output stage
+  attachOutputs();
+  FastLED.setBrightness(255);
+  FastLED.setDither(DISABLE_DITHER);
   FastLED.show();
+  renderedFrameValid = false;
 }
 
-void LEDEffects::update(uint16_t newTotalLedCount) {
-  uint16_t newNumLeds = newTotalLedCount / 2;
-  if (newNumLeds != numLeds) {
-    begin(newTotalLedCount);
+// Each output sends only its own range of the front buffer. The ESP32 RMT driver
+// starts every channel before waiting on any, so show() takes as long as the
+// longest output.
+void LEDEffects::attachOutputs() {
+  for (uint8_t output = 0; output < LED_OUTPUT_COUNT; output++) {
+    uint16_t start, length;
+    getOutputRange(topology, output, start, length);  // Unused outputs get 0 LEDs
+    if (ledOutputs[output]) {
+      ledOutputs[output]->setLeds(frontLeds + start, length);
+    } else if (length > 0) {
+      ledOutputs[output] = &addOutput(output, frontLeds + start, length);
+    }
   }
 }
 
-void LEDEffects::render(const AfterburnerSettings& settings, float throttle) {
-  // Clear all LEDs
-  FastLED.clear();
+void LEDEffects::begin(uint16_t totalLedCount) {
+  RingTopology legacy;
+  makeLegacyTopology(totalLedCount / 2, legacy);
+  begin(legacy);
+}
+
+void LEDEffects::update(const RingTopology& ringTopology) {
+  if (!sameTopology(ringTopology, topology)) {
+    begin(ringTopology);
+  }
+}
+
+void LEDEffects::render(const AfterburnerSettings& settings, float throttle, unsigned long frameTimeMs) {
+  renderFrame(settings, throttle, frameTimeMs);
+  swapBuffers();
+  show();
+}
+
+void LEDEffects::renderFrame(const AfterburnerSettings& settings, float throttle, unsigned long frameTimeMs) {
+  // Compute all per-frame and per-ring values from a single timestamp
+  prepareFrame(settings, throttle, frameTimeMs);
+  drawFrame(settings);
   
-  // Render core effect
-  renderCoreEffect(settings, throttle);
+  // Rendered without a settings version, so the next change check must render
+  renderedFrameValid = false;
+}
+
+bool LEDEffects::renderFrameIfChanged(const AfterburnerSettings& settings, uint32_t settingsVersion,
+                                      float throttle, unsigned long frameTimeMs) {
+  prepareFrame(settings, throttle, frameTimeMs);
   
-  // Render afterburner overlay
-  renderAfterburnerOverlay(settings, throttle);
+  // Brightness is part of the settings version; a dark strip stays dark whatever the effect does
+  if (renderedFrameValid && settingsVersion == renderedSettingsVersion &&
+      (settings.brightness == 0 || sameFrameOutput(frame, renderedFrame))) {
+    // Same levels, but a dithered frame has to keep stepping through its cycle
+    if (!output.needsDither()) {
+      return false;
+    }
+    output.dither(backLeds);
+    return true;
+  }
   
-  // Update brightness
-  FastLED.setBrightness(settings.brightness);
+  drawFrame(settings);
+  renderedFrame = frame;
+  renderedSettingsVersion = settingsVersion;
+  renderedFrameValid = true;
+  return true;
+}
+
+void LEDEffects::drawFrame(const AfterburnerSettings& settings) {
+  fill_solid(leds, totalLeds, CRGB::Black);
   
-  // Show the LEDs
-  FastLED.show();
+  // Render core effect
+  renderCoreEffect();
   
-  // Update noise offset for flicker
-  noiseOffset++;
+  // Render afterburner overlay
+  renderAfterburnerOverlay();
+  
+  // Into the back buffer (the front one may still be going out), with this
+  // frame's brightness rather than the one being transmitted. The encode pass
+  // sums the channels, so the power limit costs no extra pass.
+  output.encode(leds, settings.brightness);
+  powerLimiter.setBudget(settings.powerBudgetMa);
+  output.setScale(powerLimiter.update(output.getChannelSums(), totalLeds));
+  output.dither(backLeds);
 }
 
-void LEDEffects::setBrightness(uint8_t brightness) {
-  FastLED.setBrightness(brightness);
+void LEDEffects::swapBuffers() {
+  CRGB* filled = backLeds;
+  backLeds = frontLeds;
+  frontLeds = filled;
+  attachOutputs();
 }
 
-// Helper methods for dual-ring support
-bool LEDEffects::isRing2(uint16_t ledIndex) const {
-  return ledIndex >= numLeds;
+void LEDEffects::show() {
+  FastLED.show();
 }
 
-uint16_t LEDEffects::getRingLocalIndex(uint16_t ledIndex) const {
-  return isRing2(ledIndex) ? (ledIndex - numLeds) : ledIndex;
+const CRGB* LEDEffects::getRenderedLeds() const {
+  return leds;
 }
 
-float LEDEffects::getRingPosition(uint16_t ledIndex) const {
-  uint16_t localIndex = getRingLocalIndex(ledIndex);
-  float position = (float)localIndex / numLeds;
-  // Reverse spatial position for ring 2 to create contrasting pattern
-  return isRing2(ledIndex) ? (1.0f - position) : position;
+const PowerLimiter& LEDEffects::getPowerLimiter() const {
+  return powerLimiter;
 }
 
-void LEDEffects::renderCoreEffect(const AfterburnerSettings& settings, float throttle) {
-  // Get eased throttle value based on mode
-  float easedThrottle = getEasedThrottle(throttle, settings.mode);
+// The afterburner's spatial profile depends only on the LED layout, so it is
+// computed here once per layout instead of once per LED per frame
+void LEDEffects::buildSpatialProfile() {
+  memset(spatialProfile, 0, totalLeds);  // LEDs between segments are never lit
   
-  // Create start and end colors
-  CRGB startColor = CRGB(settings.startColor[0], settings.startColor[1], settings.startColor[2]);
-  CRGB endColor = CRGB(settings.endColor[0], settings.endColor[1], settings.endColor[2]);
-  
-  // Use constant brightness from settings (full brightness for color rendering)
-  // FastLED.setBrightness(settings.brightness) handles overall brightness control
-  uint8_t baseBrightness = 255;  // Full brightness - constant, not throttle-dependent
-  
-  // Render each LED (both rings: total = numLeds * 2)
-  uint16_t totalLeds = numLeds * 2;
-  
-  // Special handling for Mode 0 (Linear mode): Random flickering LEDs
-  if (settings.mode == 0) {
-    // Calculate target percentage of LEDs that should be lit (with minimum at idle)
-    float litPercentage = throttle;
-    litPercentage = constrain(litPercentage, 0.20f, 1.0f);  // 20% minimum at idle, up to 100%
-    
-    // Calculate threshold for noise-based selection
-    // Lower threshold = more LEDs lit, higher threshold = fewer LEDs lit
-    // We want: at 0.20 throttle -> ~20% lit, at 1.0 throttle -> ~100% lit
-    uint8_t noiseThreshold = (uint8_t)(255 - (255 * litPercentage));
-    
-    // Calculate flicker speed based on speedMs setting (faster flickering)
-    // Use multiplier to speed up the animation - faster speedMs = faster flicker
-    float flickerSpeedMultiplier = 5.0f;  // Speed multiplier for faster flickering
-    float flickerSpeed = (1000.0f / (float)settings.speedMs) * flickerSpeedMultiplier;
-    uint32_t timeOffset = (uint32_t)(millis() * flickerSpeed);
+  for (uint8_t ring = 0; ring < topology.segmentCount; ring++) {
+    const RingSegment& segment = topology.segments[ring];
+    bool reversed = segment.flags & RING_SEGMENT_REVERSED;
     
-    for (uint16_t i = 0; i < totalLeds; i++) {
-      bool ring2 = isRing2(i);
-      uint16_t localIndex = getRingLocalIndex(i);
-      
-      // Generate independent noise for this LED (time-based, so it flickers)
-      // Use different seed offsets for each ring to ensure independence
-      uint32_t seedOffset = ring2 ? 10000 : 0;
-      uint8_t noise = inoise8((localIndex * 37 + seedOffset), timeOffset + (localIndex * 13));
-      
-      // If noise exceeds threshold, LED is lit
-      if (noise > noiseThreshold) {
-        // For color: use raw throttle (not eased) to ensure startColor at idle
-        // At throttle = 0, we want startColor; at throttle = 1, we want endColor
-        CRGB color = lerpColor(startColor, endColor, throttle);
-        
-        // Apply base brightness (full brightness for lit LEDs)
-        color.nscale8(baseBrightness);
-        
-        // Add flicker effect for extra realism
-        addFlicker(i, 35, settings);
-        
-        // Set the LED
-        leds[i] = color;
-      } else {
-        // LED is off
-        leds[i] = CRGB::Black;
-      }
-    }
-  } else {
-    // Mode 1 (Ease) and Mode 2 (Pulse): Original behavior
-    for (uint16_t i = 0; i < totalLeds; i++) {
-      bool ring2 = isRing2(i);
-      
-      // Calculate breathing effect with phase offset for ring 2 (enhanced visibility)
-      uint8_t currentBrightness = baseBrightness;
-      if (settings.mode == 1 || settings.mode == 2) {
-        // Use speedMs to control breathing frequency (Ease and Pulse modes)
-        float breathingSpeed = 1000.0f / (float)settings.speedMs;
-        // Add 180° phase offset for ring 2 to create contrasting effect
-        float phaseOffset = ring2 ? M_PI : 0.0f;
-        // Enhanced breathing effect: 0.7 to 1.0 range (30% variation for better visibility)
-        float breathing = 0.7f + 0.3f * sin(millis() * breathingSpeed + phaseOffset);
-        currentBrightness = (uint8_t)(baseBrightness * breathing);
+    for (uint16_t localIndex = 0; localIndex < segment.length; localIndex++) {
+      // 16-bit turn, 65536 == full ring; a reversed ring runs 1.0 - position (wrapping to 0)
+      uint16_t position = ((uint32_t)localIndex << 16) / segment.length;
+      if (reversed) {
+        position = (uint16_t)(0 - position);
       }
       
-      // Interpolate color based on eased throttle (SAME for both rings)
-      // This creates the transition from 0% to 100% throttle
-      CRGB color = lerpColor(startColor, endColor, easedThrottle);
-      
-      // Apply breathing brightness effect (for Ease and Pulse modes)
-      color.nscale8(currentBrightness);
-      
-      // Add flicker effect with increased intensity for better visibility (will have phase offset in addFlicker)
-      addFlicker(i, 35, settings);  // Increased from 20 to 35 for better visibility
-      
-      // Set the LED
-      leds[i] = color;
+      // Stronger in the middle of the ring: 0.65 + 0.35 * sin(2*pi*position)
+      q16_16_t profile = sinRangeQ16(position, Q16_16(0.65), Q16_16(0.35));
+      spatialProfile[segment.start + localIndex] = (uint8_t)((255 * profile + 32768) >> 16);
     }
   }
 }
 
-void LEDEffects::renderAfterburnerOverlay(const AfterburnerSettings& settings, float throttle) {
-  // Calculate afterburner threshold
-  float abThreshold = settings.abThreshold / 100.0f;
-  
-  if (throttle <= abThreshold) {
-    return; // No afterburner effect
+// Rounds the throttle to RENDER_THROTTLE_STEPS (NaN, a lost signal, passes through)
+static float quantizeThrottle(float throttle) {
+  if (isnan(throttle)) {
+    return throttle;
   }
+  float clamped = constrain(throttle, 0.0f, 1.0f);
+  return (float)(uint16_t)(clamped * RENDER_THROTTLE_STEPS + 0.5f) / RENDER_THROTTLE_STEPS;
+}
+
+void LEDEffects::prepareFrame(const AfterburnerSettings& settings, float throttle, unsigned long now) {
+  throttle = quantizeThrottle(throttle);
+  frame.now = now;
+  frame.effect = &getEffect(settings.mode);
   
-  // Calculate afterburner intensity
-  float abIntensity = (throttle - abThreshold) / (1.0f - abThreshold);
-  abIntensity = constrain(abIntensity, 0.0f, 1.0f);
+  // Convert throttle to fixed point once; everything per LED stays integer
+  EffectInput input;
+  input.settings = &settings;
+  input.throttle = throttle;
+  input.throttleQ16 = unitFloatToQ16(throttle);
+  input.startColor = CRGB(settings.startColor[0], settings.startColor[1], settings.startColor[2]);
+  input.endColor = CRGB(settings.endColor[0], settings.endColor[1], settings.endColor[2]);
   
-  // Render afterburner effect for both rings
-  uint16_t totalLeds = numLeds * 2;
-  for (uint16_t i = 0; i < totalLeds; i++) {
-    bool ring2 = isRing2(i);
-    float position = getRingPosition(i);  // Already reversed for ring 2
-    
-    // Calculate spatial profile (stronger in center for ring 1, reversed for ring 2)
-    float spatialProfile = 0.65f + 0.35f * sin(2.0f * M_PI * position);
-    
-    // Apply pulse modulation for Pulse mode with phase offset for ring 2
-    float currentAbIntensity = abIntensity;
-    if (settings.mode == 2) {
-      // Use speedMs to control pulse frequency (faster speed = faster pulse)
-      float pulseFrequency = 1000.0f / (float)settings.speedMs;
-      // Add 180° phase offset for ring 2 to create contrasting pulse
-      float phaseOffset = ring2 ? M_PI : 0.0f;
-      float pulse = 0.6f + 0.4f * sin(millis() * pulseFrequency + phaseOffset);
-      currentAbIntensity *= pulse;
-    }
+  // Calculate afterburner threshold
+  float abThreshold = settings.abThreshold / 100.0f;
+  frame.afterburnerActive = throttle > abThreshold;
+  frame.sparklesActive = false;
+  if (frame.afterburnerActive) {
+    // Calculate afterburner intensity
+    float abIntensity = (throttle - abThreshold) / (1.0f - abThreshold);
+    abIntensity = constrain(abIntensity, 0.0f, 1.0f);
+    q16_16_t abIntensityQ16 = unitFloatToQ16(abIntensity);
     
     // Blend afterburner colors based on throttle (SAME for both rings)
-    CRGB abColor = lerpColor(abCoreColor1, abCoreColor2, throttle);
-    
-    // Scale by intensity and spatial profile
-    uint8_t abBrightness = (uint8_t)(255 * currentAbIntensity * spatialProfile);
-    abColor.nscale8(abBrightness);
+    frame.abColor = lerpColor(abCoreColor1, abCoreColor2, input.throttleQ16);
+    for (uint8_t ring = 0; ring < frame.ringCount; ring++) {
+      frame.ringAbIntensity[ring] = abIntensityQ16;
+    }
     
-    // Add to existing LED color
-    leds[i] += abColor;
+    // Add sparkles when afterburner is strong (independent per ring)
+    // Use speedMs to control sparkle frequency (faster speed = more sparkles)
+    frame.sparklesActive = abIntensity > 0.4f;
+    if (frame.sparklesActive) {
+      float sparkleFrequency = 1000.0f / (float)settings.speedMs;
+      frame.sparkleChance = (uint16_t)(abIntensity * 50 * sparkleFrequency);
+      frame.sparkleTime = scaleTime(now, speedToRate(settings.speedMs));
+    }
   }
   
-  // Add sparkles when afterburner is strong (independent per ring)
-  if (abIntensity > 0.4f) {
-    addSparkles(abIntensity, settings);
-  }
+  // Effect-specific values last, so an effect can modulate the overlay
+  frame.effect->prepareFrame(frame, input);
 }
 
-float LEDEffects::getEasedThrottle(float throttle, uint8_t mode) {
-  switch (mode) {
-    case 0: // Linear
-      return throttle;
-    case 1: // Ease
-      return pow(throttle, 1.2f);
-    case 2: // Pulse
-      return pow(throttle, 1.2f);
-    default:
-      return throttle;
+void LEDEffects::renderCoreEffect() {
+  for (uint8_t ring = 0; ring < topology.segmentCount; ring++) {
+    const RingSegment& segment = topology.segments[ring];
+    frame.effect->renderRing(frame, ring, leds + segment.start, segment.length);
   }
 }
 
-void LEDEffects::addFlicker(uint16_t ledIndex, uint8_t intensity, const AfterburnerSettings& settings) {
-  bool ring2 = isRing2(ledIndex);
-  uint16_t localIndex = getRingLocalIndex(ledIndex);
-  
-  // Generate noise-based flicker using FastLED noise functions
-  // Use speedMs to control flicker speed (faster speed = faster flicker)
-  float flickerSpeed = 1000.0f / (float)settings.speedMs;
-  
-  // Add phase offset for ring 2 to create independent flicker pattern
-  uint32_t timeOffset = ring2 ? 1000 : 0;  // Different time offset for ring 2
-  uint8_t noise = inoise8(localIndex * 12, (millis() * flickerSpeed + localIndex * 7) * 8 + noiseOffset + timeOffset);
+void LEDEffects::renderAfterburnerOverlay() {
+  if (!frame.afterburnerActive) {
+    return; // No afterburner effect
+  }
   
-  // Map noise to flicker range (enhanced for better visibility during day)
-  int8_t flicker = map(noise, 0, 255, -intensity, intensity);
+  // Render afterburner effect for every ring
+  for (uint8_t ring = 0; ring < topology.segmentCount; ring++) {
+    uint16_t first = topology.segments[ring].start;
+    uint16_t end = first + topology.segments[ring].length;
+    q16_16_t ringIntensity = frame.ringAbIntensity[ring];
+    
+    for (uint16_t i = first; i < end; i++) {
+      // Scale by intensity and the precomputed spatial profile (255 * intensity * profile)
+      CRGB abColor = frame.abColor;
+      uint8_t abBrightness = (uint8_t)((ringIntensity * spatialProfile[i]) >> 16);
+      abColor.nscale8(abBrightness);
+      
+      // Add to existing LED color
+      leds[i] += abColor;
+    }
+  }
   
-  // Apply flicker to LED (additive for better visibility)
-  leds[ledIndex].addToRGB(flicker);
+  // Add sparkles when afterburner is strong (independent per ring)
+  if (frame.sparklesActive) {
+    addSparkles();
+  }
 }
 
-void LEDEffects::addSparkles(float abIntensity, const AfterburnerSettings& settings) {
+void LEDEffects::addSparkles() {
   // Add random white sparkles with independent patterns for each ring
-  // Use speedMs to control sparkle frequency (faster speed = more sparkles)
-  float sparkleFrequency = 1000.0f / (float)settings.speedMs;
-  uint16_t sparkleChance = (uint16_t)(abIntensity * 50 * sparkleFrequency);
-  
-  uint16_t totalLeds = numLeds * 2;
-  for (uint16_t i = 0; i < totalLeds; i++) {
+  for (uint8_t ring = 0; ring < topology.segmentCount; ring++) {
+    uint16_t first = topology.segments[ring].start;
+    uint16_t end = first + topology.segments[ring].length;
+    
     // Use LED index and ring offset to create independent sparkle patterns
     // Each ring gets different sparkle timing based on its index
-    uint32_t sparkleSeed = (millis() * sparkleFrequency) + (i * 17) + (isRing2(i) ? 5000 : 0);
-    if ((sparkleSeed % 1000) < sparkleChance) {
-      uint8_t sparkleIntensity = 50 + (sparkleSeed % 100);  // 50-150 range
-      leds[i] += CRGB(sparkleIntensity, sparkleIntensity, sparkleIntensity);
+    uint32_t ringSeed = frame.sparkleTime + ring * 5000;
+    
+    for (uint16_t i = first; i < end; i++) {
+      uint32_t sparkleSeed = ringSeed + (i * 17);
+      if ((sparkleSeed % 1000) < frame.sparkleChance) {
+        uint8_t sparkleIntensity = 50 + (sparkleSeed % 100);  // 50-150 range
+        leds[i] += CRGB(sparkleIntensity, sparkleIntensity, sparkleIntensity);
+      }
     }
   }
 }
-
-CRGB LEDEffects::lerpColor(CRGB color1, CRGB color2, float factor) {
-  factor = constrain(factor, 0.0f, 1.0f);
-  
-  CRGB result;
-  result.r = (uint8_t)(color1.r + (color2.r - color1.r) * factor);
-  result.g = (uint8_t)(color1.g + (color2.g - color1.g) * factor);
-  result.b = (uint8_t)(color1.b + (color2.b - color1.b) * factor);
-  
-  return result;
-}
@@ -5,38 +5,83 @@
 #include <FastLED.h>
 #include "settings.h"
 #include "constants.h"
+#include "fixed_point.h"
+#include "effects.h"
+#include "output_stage.h"
+#include "power_limiter.h"
 
+// Effects render 8-bit colour into leds; the output stage (output_stage.h)
+// turns it into the dithered frame the strip is sent, brightness included,
+// scaled down when the estimated current exceeds settings.powerBudgetMa.
+//
+// Output frames are double-buffered: renderFrame() writes the back buffer
+// while the outputs may still be sending the front one, swapBuffers() hands
+// the new frame to the outputs, and show() transmits it. swapBuffers() must
+// not run while show() is in progress (main.cpp runs show() in its own task).
+//
+// renderFrameIfChanged() first prepares the frame and compares it with the
+// last one rendered; when the settings version and the prepared effect state
+// match, the LEDs would come out the same and nothing needs rendering. Unless
+// the frame is still being dithered, nothing needs swapping or sending either.
+// Throttle is rendered in RENDER_THROTTLE_STEPS, so input noise
+// below a step cannot make a static scene dirty.
 class LEDEffects {
 private:
-  CRGB* leds;
-  uint16_t numLeds;  // LEDs per ring (total LEDs = numLeds * 2 for dual turbines)
+  CRGB* leds;               // Effect colours of the last frame rendered
+  CRGB* ledBuffers[2];      // Output frames
+  CRGB* backLeds;           // Back buffer, being filled
+  CRGB* frontLeds;          // Front buffer, attached to the outputs
+  OutputStage output;
+  PowerLimiter powerLimiter;
+  uint8_t* spatialProfile;  // Per-LED afterburner profile, 255 == 1.0 (rebuilt in begin())
+  RingTopology topology;    // Resolved ring layout (never empty)
+  uint16_t totalLeds;       // LEDs on the strip, gaps between segments included
   unsigned long lastUpdate;
-  uint8_t noiseOffset;
+  FrameContext frame;
   
+  // The last frame rendered by renderFrameIfChanged()
+  FrameContext renderedFrame;
+  uint32_t renderedSettingsVersion;
+  bool renderedFrameValid;  // Cleared by begin() and renderFrame()
+
   // Afterburner colors
   CRGB abCoreColor1;  // Violet-blue
   CRGB abCoreColor2;  // Magenta-purple
-  
+
 public:
   LEDEffects();
   ~LEDEffects();
-  void begin(uint16_t totalLedCount);  // Total LEDs (numLeds * 2 for dual turbines)
-  void update(uint16_t newTotalLedCount);
-  void render(const AfterburnerSettings& settings, float throttle);
-  void setBrightness(uint8_t brightness);
-  
+  void begin(const RingTopology& ringTopology);  // Resolved topology (see resolveTopology())
+  void begin(uint16_t totalLedCount);  // Legacy layout: two rings of totalLedCount / 2
+  void update(const RingTopology& ringTopology);  // Rebuilds only if the layout changed
+  // frameTimeMs is the animation timestamp of this frame (see RenderScheduler)
+  void renderFrame(const AfterburnerSettings& settings, float throttle, unsigned long frameTimeMs);
+  // settingsVersion identifies settings (see SettingsManager::getAcquiredVersion());
+  // returns false, with the back buffer untouched, if there is nothing new to send
+  bool renderFrameIfChanged(const AfterburnerSettings& settings, uint32_t settingsVersion,
+                            float throttle, unsigned long frameTimeMs);
+  void swapBuffers();
+  void show();  // Transmits the front buffer
+  // renderFrame(), swapBuffers() and show() in one call
+  void render(const AfterburnerSettings& settings, float throttle, unsigned long frameTimeMs);
+  const CRGB* getRenderedLeds() const;  // Effect colours, before the output stage
+  const PowerLimiter& getPowerLimiter() const;  // Current estimate of the last frame rendered
+
 private:
-  // Helper methods for dual-ring support
-  bool isRing2(uint16_t ledIndex) const;
-  uint16_t getRingLocalIndex(uint16_t ledIndex) const;
-  float getRingPosition(uint16_t ledIndex) const;
-  
-  void renderCoreEffect(const AfterburnerSettings& settings, float throttle);
-  void renderAfterburnerOverlay(const AfterburnerSettings& settings, float throttle);
-  float getEasedThrottle(float throttle, uint8_t mode);
-  void addFlicker(uint16_t ledIndex, uint8_t intensity, const AfterburnerSettings& settings);
-  void addSparkles(float abIntensity, const AfterburnerSettings& settings);
-  CRGB lerpColor(CRGB color1, CRGB color2, float factor);
+  void freeBuffers();
+  void buildSpatialProfile();
+  void attachOutputs();  // Points each LED output at its range of leds
+
+  void prepareFrame(const AfterburnerSettings& settings, float throttle, unsigned long now);
+  void drawFrame(const AfterburnerSettings& settings);  // The prepared frame through to the back buffer
+  void renderCoreEffect();  // Dispatches to the frame's effect (see effects.h)
+  void renderAfterburnerOverlay();
+  void addSparkles();
+
+#ifdef PIO_UNIT_TESTING
+  // Native benchmarks and tests drive the individual render stages
+  friend struct LEDEffectsTestAccess;
+#endif
 };
 
 #endif // LED_EFFECTS_H
@@ -0,0 +1,60 @@
+#include "log_buffer.h"
+
+#define LOG_BUFFER_MASK (LOG_BUFFER_LINES - 1)
+
+LogBuffer::LogBuffer() : writePosition(0), droppedLines(0) {
+  for (uint32_t i = 0; i < LOG_BUFFER_LINES; i++) {
+    lines[i].sequence.store(i, std::memory_order_relaxed);
+    lines[i].length = 0;
+  }
+  readPosition = 0;
+}
+
+bool LogBuffer::push(const char* text, size_t length) {
+  if (length > LOG_LINE_MAX) {
+    length = LOG_LINE_MAX;
+  }
+  
+  uint32_t position = writePosition.load(std::memory_order_relaxed);
+  Line* line;
+  while (true) {
+    line = &lines[position & LOG_BUFFER_MASK];
+    int32_t turn = (int32_t)(line->sequence.load(std::memory_order_acquire) - position);
+    if (turn == 0) {
+      // Slot is free for this position; claim it unless another task got there first
+      if (writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (turn < 0) {
+      // Slot still holds a line the consumer has not taken: full
+      droppedLines.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = writePosition.load(std::memory_order_relaxed);
+    }
+  }
+  
+  memcpy(line->text, text, length);
+  line->length = length;
+  line->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+size_t LogBuffer::pop(char* text) {
+  Line& line = lines[readPosition & LOG_BUFFER_MASK];
+  if (line.sequence.load(std::memory_order_acquire) != readPosition + 1) {
+    return 0;
+  }
+  
+  size_t length = line.length;
+  memcpy(text, line.text, length);
+  
+  // Hand the slot back to producers one lap ahead
+  line.sequence.store(readPosition + LOG_BUFFER_LINES, std::memory_order_release);
+  readPosition++;
+  return length;
+}
+
+uint32_t LogBuffer::getDroppedLines() const {
+  return droppedLines.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,41 @@
+#ifndef LOG_BUFFER_H
+#define LOG_BUFFER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define LOG_LINE_MAX 256       // Longer lines are truncated; fits the longest existing message
+#define LOG_BUFFER_LINES 32    // Power of two
+
+// Formatted log lines waiting for the log task.
+// Bounded multi-producer / single-consumer queue: any task can push without
+// locks (a line slot is claimed with a compare-and-swap on the write position),
+// only the log task pops. When it is full the new line is dropped and
+// counted, so a slow serial port can never block the caller.
+class LogBuffer {
+private:
+  struct Line {
+    std::atomic<uint32_t> sequence;  // Whose turn the slot is (write position or read position + 1)
+    uint16_t length;
+    char text[LOG_LINE_MAX];
+  };
+
+  Line lines[LOG_BUFFER_LINES];
+  std::atomic<uint32_t> writePosition;
+  uint32_t readPosition;             // Consumer only
+  std::atomic<uint32_t> droppedLines;
+
+public:
+  LogBuffer();
+
+  // Any task; returns false if the line was dropped
+  bool push(const char* text, size_t length);
+
+  // Consumer: copies the oldest line into text (LOG_LINE_MAX bytes, not
+  // terminated) and returns its length, 0 if the buffer is empty
+  size_t pop(char* text);
+
+  uint32_t getDroppedLines() const;
+};
+
+#endif // LOG_BUFFER_H
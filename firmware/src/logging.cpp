@@ -0,0 +1,57 @@
+#include "logging.h"
+#include <stdarg.h>
+#include "log_buffer.h"
+
+static LogBuffer logBuffer;
+static volatile bool logAsync = false;
+
+void logWrite(const char* format, ...) {
+  char line[LOG_LINE_MAX];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  
+  if (length <= 0) {
+    return;
+  }
+  if (length >= (int)sizeof(line)) {
+    // Truncated: keep the line break
+    length = sizeof(line) - 1;
+    line[length - 1] = '\n';
+  }
+  
+  if (logAsync) {
+    logBuffer.push(line, length);
+  } else {
+    Serial.write((const uint8_t*)line, length);
+  }
+}
+
+void logStartAsync() {
+  logAsync = true;
+}
+
+void logTask(void* parameter) {
+  char line[LOG_LINE_MAX];
+  uint32_t reportedDrops = 0;
+  
+  while (true) {
+    size_t length;
+    while ((length = logBuffer.pop(line)) > 0) {
+      Serial.write((const uint8_t*)line, length);
+    }
+    
+    uint32_t dropped = logBuffer.getDroppedLines();
+    if (dropped != reportedDrops) {
+      Serial.printf("Log: ⚠️ %lu line(s) dropped\n", (unsigned long)(dropped - reportedDrops));
+      reportedDrops = dropped;
+    }
+    
+    vTaskDelay(pdMS_TO_TICKS(LOG_TASK_PERIOD_MS));
+  }
+}
+
+uint32_t getDroppedLogLines() {
+  return logBuffer.getDroppedLines();
+}
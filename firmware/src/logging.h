@@ -0,0 +1,67 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <Arduino.h>
+
+// Log levels
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+// Highest level compiled in (override with -DLOG_LEVEL=... in build_flags)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Per-module switches, 1 = compiled in (override in build_flags)
+#ifndef LOG_MODULE_BLE
+#define LOG_MODULE_BLE 1
+#endif
+#ifndef LOG_MODULE_SETTINGS
+#define LOG_MODULE_SETTINGS 1
+#endif
+#ifndef LOG_MODULE_THROTTLE
+#define LOG_MODULE_THROTTLE 1
+#endif
+#ifndef LOG_MODULE_SYSTEM
+#define LOG_MODULE_SYSTEM 1
+#endif
+
+// Log task
+#define LOG_TASK_PRIORITY 0     // Below every other task; only runs when they are idle
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PERIOD_MS 20
+
+// LOG_INFO(BLE, "BLE: Mode changed: %d\n", mode);
+//
+// The level and module test is a compile-time constant: a disabled site emits
+// no code and no format string, but its arguments are still type-checked.
+// Enabled sites format into a LogBuffer line that the log task writes to
+// Serial, so a slow or disconnected USB-CDC port never stalls the caller.
+#define LOG_AT(level, module, ...)                                  \
+  do {                                                              \
+    if constexpr ((level) <= LOG_LEVEL && LOG_MODULE_##module) {    \
+      logWrite(__VA_ARGS__);                                        \
+    }                                                               \
+  } while (0)
+
+#define LOG_ERROR(module, ...) LOG_AT(LOG_LEVEL_ERROR, module, __VA_ARGS__)
+#define LOG_WARN(module, ...) LOG_AT(LOG_LEVEL_WARN, module, __VA_ARGS__)
+#define LOG_INFO(module, ...) LOG_AT(LOG_LEVEL_INFO, module, __VA_ARGS__)
+#define LOG_DEBUG(module, ...) LOG_AT(LOG_LEVEL_DEBUG, module, __VA_ARGS__)
+
+// Formats one line. Written straight to Serial until logStartAsync(), then
+// queued for the log task.
+void logWrite(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+// Called from setup() before the tasks start
+void logStartAsync();
+
+// Drains queued lines to Serial
+void logTask(void* parameter);
+
+uint32_t getDroppedLogLines();
+
+#endif // LOGGING_H
@@ -4,21 +4,78 @@
 #include "throttle.h"
 #include "led_effects.h"
 #include "ble_service.h"
+#include "render_scheduler.h"
+#include "snapshot.h"
+#include "telemetry.h"
+#include "frame_timings.h"
+#include "deferred_actions.h"
+#include "logging.h"
 
 // Global objects
 SettingsManager settingsManager;
 ThrottleReader throttleReader;
 LEDEffects ledEffects;
+RenderScheduler renderScheduler;
 AfterburnerBLEService bleService(&settingsManager, &throttleReader);
 
-// Global calibration flag
+// Throttle state shared by the input task with the render and system tasks
+SeqlockSnapshot<ThrottleState> throttleSnapshot;
+
+// Opt-in high-rate samples from the render task, sent over BLE by the system task
+TelemetryBuffer telemetry;
+
+// Double-buffered LED output: the render task fills the back buffer while the
+// show task sends the front one. showDone is given whenever no transmission
+// is in progress, i.e. when the render task may swap buffers.
+TaskHandle_t showTaskHandle = nullptr;
+SemaphoreHandle_t showDone = nullptr;
+volatile uint32_t lastTransmitUs = 0;
+FrameTimings frameTimings;
+
+// Estimated current of the last frame sent, before and after the power limit;
+// written by the render task, reported by the system task
+volatile uint16_t ledRequestedMa = 0;
+volatile uint16_t ledCurrentMa = 0;
+
+// Delayed work scheduled from BLE callbacks and the system task, run by the system task
+DeferredActions deferredActions;
+
+// Global calibration flags (set by BLE callbacks, consumed by the input task)
 volatile bool startCalibrationFlag = false;
+volatile bool resetCalibrationFlag = false;
+
+// Set by the input task when calibration finishes; the system task saves it
+volatile bool calibrationCompleteFlag = false;
 
 // Function to start throttle calibration (called from BLE service)
 void startThrottleCalibration() {
   startCalibrationFlag = true;
 }
 
+// Function to reset throttle calibration values (called from BLE service)
+void requestThrottleCalibrationReset() {
+  resetCalibrationFlag = true;
+}
+
+// Task layout: render gets its own core on dual-core chips, away from the
+// BLE stack and flash writes on core 0. The ESP32-C3 has a single core.
+#if CONFIG_FREERTOS_UNICORE || portNUM_PROCESSORS == 1
+#define RENDER_TASK_CORE 0
+#define SHOW_TASK_CORE 0
+#define INPUT_TASK_CORE 0
+#define SYSTEM_TASK_CORE 0
+#else
+#define RENDER_TASK_CORE 1
+#define SHOW_TASK_CORE 1
+#define INPUT_TASK_CORE 1
+#define SYSTEM_TASK_CORE 0
+#endif
+
+void renderTask(void* parameter);
+void showTask(void* parameter);
+void inputTask(void* parameter);
+void systemTask(void* parameter);
+
 // Debug: Check if BLE service object was created
 void checkBLEServiceObject() {
   // Removed excessive debug prints
@@ -36,17 +93,17 @@ void setup() {
   Serial.begin(SERIAL_BAUD_RATE);
   delay(INITIAL_DELAY_MS);
   
-  Serial.println("ESP32-C3 SuperMini Afterburner Starting...");
+  LOG_INFO(SYSTEM, "ESP32-C3 SuperMini Afterburner Starting...\n");
   
   // Initialize GPIO pins
   pinMode(ONBOARD_LED_PIN, OUTPUT);
   pinMode(THROTTLE_PIN, INPUT);
-  pinMode(LED_STRIP_PIN, OUTPUT);
+  // LED output pins are configured by FastLED, and only for outputs the topology uses
   
-  Serial.println("GPIO pins initialized");
+  LOG_INFO(SYSTEM, "GPIO pins initialized\n");
   
   // Initialize components
-  Serial.println("Initializing components...");
+  LOG_INFO(SYSTEM, "Initializing components...\n");
   
   settingsManager.begin();
   
@@ -55,17 +112,17 @@ void setup() {
   
   // Verify settings manager initialization
   if (settingsManager.isInitialized()) {
-    Serial.println("Settings manager initialized successfully");
+    LOG_INFO(SYSTEM, "Settings manager initialized successfully\n");
     
     if (settingsManager.hasSavedSettings()) {
-      Serial.println("Found saved settings in flash memory");
+      LOG_INFO(SYSTEM, "Found saved settings in flash memory\n");
       // Check flash memory status
       settingsManager.checkFlashStatus();
     } else {
-      Serial.println("No saved settings found - will use defaults (normal on first boot)");
+      LOG_INFO(SYSTEM, "No saved settings found - will use defaults (normal on first boot)\n");
     }
   } else {
-    Serial.println("Settings manager failed to initialize properly!");
+    LOG_ERROR(SYSTEM, "Settings manager failed to initialize properly!\n");
   }
   
   throttleReader.begin();
@@ -74,13 +131,13 @@ void setup() {
   if (settingsManager.isInitialized() && settingsManager.isThrottleCalibrated()) {
     uint16_t savedMin = settingsManager.getThrottleMin();
     uint16_t savedMax = settingsManager.getThrottleMax();
-    Serial.printf("Loading saved throttle calibration - Min: %u, Max: %u\n", savedMin, savedMax);
+    LOG_INFO(SYSTEM, "Loading saved throttle calibration - Min: %u, Max: %u\n", savedMin, savedMax);
     throttleReader.updateCalibrationValues(savedMin, savedMax);
     
     // Update BLE calibration status with saved values
     bleService.updateThrottleCalibrationStatus(true, savedMin, savedMax);
   } else {
-    Serial.println("No saved throttle calibration found, using defaults");
+    LOG_INFO(SYSTEM, "No saved throttle calibration found, using defaults\n");
     
     // Update BLE calibration status with default values
     bleService.updateThrottleCalibrationStatus(false, DEFAULT_THROTTLE_MIN, DEFAULT_THROTTLE_MAX);
@@ -89,146 +146,360 @@ void setup() {
   // Set demo mode if enabled
   throttleReader.setDemoMode(demoMode);
   
-  // Get LED count from settings (per ring) and initialize for dual turbines
-  // Total LEDs = numLeds * 2 (one ring continues the first)
-  uint16_t numLeds = settingsManager.getSettings().numLeds;
-  ledEffects.begin(numLeds * 2);  // Dual turbine support: 2 rings
+  // Ring layout from settings; without a stored topology, two rings of numLeds
+  const AfterburnerSettings& startupSettings = settingsManager.getSettings();
+  RingTopology topology;
+  resolveTopology(startupSettings.topology, startupSettings.numLeds, topology);
+  ledEffects.begin(topology);
   
   try {
     bleService.begin();
-    Serial.println("BLE service initialized successfully");
+    LOG_INFO(SYSTEM, "BLE service initialized successfully\n");
   } catch (...) {
-    Serial.println("BLE service initialization failed!");
+    LOG_ERROR(SYSTEM, "BLE service initialization failed!\n");
   }
   
-  Serial.printf("LED count: %d, Demo mode: %s\n", numLeds, demoMode ? "enabled" : "disabled");
-  Serial.println("ESP32-C3 SuperMini Afterburner Ready!");
+  LOG_INFO(SYSTEM, "LED count: %u in %u ring(s)%s, Demo mode: %s\n", getTopologyLedCount(topology),
+           topology.segmentCount, startupSettings.topology.segmentCount ? "" : " (legacy layout)",
+           demoMode ? "enabled" : "disabled");
+  // Outputs transmit in parallel: a frame takes as long as the longest one
+  uint16_t longestOutput = 0;
+  for (uint8_t output = 0; output < LED_OUTPUT_COUNT; output++) {
+    uint16_t start, length;
+    if (getOutputRange(topology, output, start, length)) {
+      LOG_INFO(SYSTEM, "LED output %u (GPIO%u): LEDs %u-%u\n", output,
+               output == 0 ? LED_OUTPUT_PIN_0 : LED_OUTPUT_PIN_1, start, start + length - 1);
+      if (length > longestOutput) {
+        longestOutput = length;
+      }
+    }
+  }
+  LOG_INFO(SYSTEM, "LED show time: ~%u us\n", (unsigned)longestOutput * LED_US_PER_LED);
+  LOG_INFO(SYSTEM, "ESP32-C3 SuperMini Afterburner Ready!\n");
   
   // Initial LED test
   digitalWrite(ONBOARD_LED_PIN, HIGH);
   delay(LED_TEST_DELAY_MS);
   digitalWrite(ONBOARD_LED_PIN, LOW);
+  
+  // Start the frame clock last so setup time is not counted as dropped frames
+  renderScheduler.begin(TARGET_FPS);
+  LOG_INFO(SYSTEM, "Render scheduler: %u FPS target\n", renderScheduler.getTargetFps());
+  
+  // Publish an initial throttle state before anything reads it
+  ThrottleState initialState = {};
+  initialState.calibrationMin = throttleReader.getCalibratedMin();
+  initialState.calibrationMax = throttleReader.getCalibratedMax();
+  throttleSnapshot.publish(initialState);
+  
+  // Setup logs went straight to Serial; from here on they are queued
+  xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK, nullptr,
+                          LOG_TASK_PRIORITY, nullptr, SYSTEM_TASK_CORE);
+  logStartAsync();
+  
+  showDone = xSemaphoreCreateBinary();
+  xSemaphoreGive(showDone);  // Nothing is being sent yet
+  xTaskCreatePinnedToCore(showTask, "show", SHOW_TASK_STACK, nullptr,
+                          SHOW_TASK_PRIORITY, &showTaskHandle, SHOW_TASK_CORE);
+  xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK, nullptr,
+                          RENDER_TASK_PRIORITY, nullptr, RENDER_TASK_CORE);
+  xTaskCreatePinnedToCore(inputTask, "input", INPUT_TASK_STACK, nullptr,
+                          INPUT_TASK_PRIORITY, nullptr, INPUT_TASK_CORE);
+  xTaskCreatePinnedToCore(systemTask, "system", SYSTEM_TASK_STACK, nullptr,
+                          SYSTEM_TASK_PRIORITY, nullptr, SYSTEM_TASK_CORE);
+  LOG_INFO(SYSTEM, "Tasks started: log, show, render, input, system\n");
 }
 
 void loop() {
-  // Read throttle
-  float throttle = throttleReader.readThrottle();
-  
-  // Debug: Log throttle value every 2 seconds (only if NaN)
-  static unsigned long lastThrottleLog = 0;
-  if (millis() - lastThrottleLog > 2000) {
-    if (isnan(throttle)) {
-      Serial.println("Throttle reading: NaN (calibration may be needed)");
-      // Also debug the calibration state when we get NaN
-      throttleReader.debugCalibrationState();
-    }
-    lastThrottleLog = millis();
+  // All work runs in the tasks started from setup()
+  vTaskDelete(nullptr);
+}
+
+// Highest priority: renders on the scheduler's fixed cadence from snapshots,
+// so BLE callbacks and flash writes can never stall or tear a frame
+void renderTask(void* parameter) {
+  ThrottleState input = {};
+  
+  while (true) {
+    if (renderScheduler.frameDue()) {
+      // Latest settings version, held (not copied) for the whole frame
+      const AfterburnerSettings& settings = settingsManager.acquireSettings(SETTINGS_READER_RENDER);
+      
+      // On a failed read the previous frame's throttle is reused
+      throttleSnapshot.tryRead(input);
+      
+      // Update LED effects using render method
+      // The speedMs setting from settings controls animation timing for:
+      // - Pulse mode afterburner effects
+      // - Breathing effects in Ease and Pulse modes  
+      // - Flicker animation speed
+      // - Sparkle frequency during afterburner
+      unsigned long renderStart = micros();
+      bool changed = ledEffects.renderFrameIfChanged(settings, settingsManager.getAcquiredVersion(SETTINGS_READER_RENDER),
+                                                     input.throttle, renderScheduler.getFrameTime());
+      unsigned long renderUs = micros() - renderStart;
+      
+      if (changed) {
+        // Swap once the previous frame is out, then hand the new one to the show task
+        unsigned long waitStart = micros();
+        xSemaphoreTake(showDone, portMAX_DELAY);
+        unsigned long waitUs = micros() - waitStart;
+        ledEffects.swapBuffers();
+        xTaskNotifyGive(showTaskHandle);
+        frameTimings.record(renderUs, lastTransmitUs, waitUs, renderScheduler.getFramePeriodUs());
+        
+        const PowerLimiter& power = ledEffects.getPowerLimiter();
+        ledRequestedMa = power.getRequestedMa() > 0xFFFF ? 0xFFFF : power.getRequestedMa();
+        ledCurrentMa = power.getEstimatedMa() > 0xFFFF ? 0xFFFF : power.getEstimatedMa();
+      } else {
+        // The LEDs already show this frame
+        frameTimings.recordSkipped(renderUs, renderScheduler.getFramePeriodUs());
+      }
+      
+      if (telemetry.isEnabled()) {
+        TelemetrySample sample;
+        sample.timeMs = renderScheduler.getFrameTime() & 0xFFFF;
+        sample.pulseUs = input.pulseUs;
+        sample.throttlePermille = throttleToPermille(input.throttle);
+        sample.renderUs = renderUs > 0xFFFF ? 0xFFFF : renderUs;
+        telemetry.push(sample);
+      }
+    }
+    
+    // Sleep until the next frame is due
+    renderScheduler.waitForNextFrame();
+  }
+}
+
+// Sends each swapped-in frame; the CPU is free for the next render while the
+// RMT clocks the LEDs out
+void showTask(void* parameter) {
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    unsigned long transmitStart = micros();
+    ledEffects.show();
+    lastTransmitUs = micros() - transmitStart;
+    xSemaphoreGive(showDone);
   }
+}
+
+// Reads the throttle and runs calibration; owns throttleReader
+void inputTask(void* parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
   
-  // Check if calibration should start
-  if (startCalibrationFlag) {
-    Serial.println("Starting throttle calibration from BLE command...");
-    throttleReader.startCalibration();
-    startCalibrationFlag = false;
+  while (true) {
+    // Read throttle
+    float throttle = throttleReader.readThrottle();
+    
+    // Debug: Log throttle value every 2 seconds (only if NaN)
+    static unsigned long lastThrottleLog = 0;
+    if (millis() - lastThrottleLog > 2000) {
+      if (isnan(throttle)) {
+        LOG_WARN(SYSTEM, "Throttle reading: NaN (calibration may be needed)\n");
+        // Also debug the calibration state when we get NaN
+        throttleReader.debugCalibrationState();
+      }
+      lastThrottleLog = millis();
+    }
+    
+    // Check if calibration should start
+    if (startCalibrationFlag) {
+      LOG_INFO(SYSTEM, "Starting throttle calibration from BLE command...\n");
+      throttleReader.startCalibration();
+      startCalibrationFlag = false;
+    }
+    
+    // Check if calibration values should be reset
+    if (resetCalibrationFlag) {
+      throttleReader.resetCalibrationToDefaults();
+      resetCalibrationFlag = false;
+    }
+    
+    // Update throttle calibration if active
+    bool completed = false;
+    if (throttleReader.isCalibrating()) {
+      throttleReader.updateCalibration();
+      
+      // Check if calibration is complete
+      if (throttleReader.isCalibrated()) {
+        // Update throttle reader with the new calibration values
+        throttleReader.updateCalibrationValues(throttleReader.getCalibratedMin(),
+                                               throttleReader.getCalibratedMax());
+        completed = true;
+      }
+    }
+    
+    ThrottleState state;
+    state.throttle = throttle;
+    state.pulseUs = throttleReader.getLastPulse();
+    state.calibrating = throttleReader.isCalibrating();
+    state.calibrationMin = throttleReader.getCalibratedMin();
+    state.calibrationMax = throttleReader.getCalibratedMax();
+    state.minVisits = throttleReader.getMinVisits();
+    state.maxVisits = throttleReader.getMaxVisits();
+    throttleSnapshot.publish(state);
+    
+    // Saving and notifying happen in the system task
+    if (completed) {
+      calibrationCompleteFlag = true;
+    }
+    
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(INPUT_TASK_PERIOD_MS));
   }
+}
+
+static void notifyCalibrationStatusAction(void* context) {
+  bleService.notifyCalibrationStatus();
+}
+
+// Lowest priority: BLE notifications, persistence and housekeeping
+void systemTask(void* parameter) {
+  ThrottleState input = {};
+  TickType_t lastWake = xTaskGetTickCount();
   
-  // Update throttle calibration if active
-  if (throttleReader.isCalibrating()) {
-    throttleReader.updateCalibration();
+  while (true) {
+    const AfterburnerSettings& settings = settingsManager.acquireSettings(SETTINGS_READER_SYSTEM);
+    throttleSnapshot.tryRead(input);
     
     // Send periodic calibration status updates during calibration
     static unsigned long lastCalibrationStatusUpdate = 0;
-    if (millis() - lastCalibrationStatusUpdate > 1000) { // Update every second during calibration
-      uint16_t currentMin = throttleReader.getCalibratedMin();
-      uint16_t currentMax = throttleReader.getCalibratedMax();
-      uint8_t minVisits = throttleReader.getMinVisits();
-      uint8_t maxVisits = throttleReader.getMaxVisits();
-      bleService.updateThrottleCalibrationProgress(currentMin, currentMax, minVisits, maxVisits);
+    if (input.calibrating && millis() - lastCalibrationStatusUpdate > 1000) { // Update every second during calibration
+      bleService.updateThrottleCalibrationProgress(input.calibrationMin, input.calibrationMax,
+                                                   input.minVisits, input.maxVisits);
       lastCalibrationStatusUpdate = millis();
     }
     
-    // Check if calibration is complete
-    if (throttleReader.isCalibrated()) {
-      uint16_t minPWM = throttleReader.getCalibratedMin();
-      uint16_t maxPWM = throttleReader.getCalibratedMax();
+    // Calibration finished in the input task
+    if (calibrationCompleteFlag) {
+      // The flag is set after the final values were published
+      throttleSnapshot.tryRead(input);
+      uint16_t minPWM = input.calibrationMin;
+      uint16_t maxPWM = input.calibrationMax;
+      calibrationCompleteFlag = false;
       
-      Serial.printf("Calibration complete! Min: %u, Max: %u\n", minPWM, maxPWM);
+      LOG_INFO(SYSTEM, "Calibration complete! Min: %u, Max: %u\n", minPWM, maxPWM);
       
       // Save calibration to settings
       settingsManager.updateThrottleCalibration(minPWM, maxPWM);
       
-      // Update throttle reader with the new calibration values
-      throttleReader.updateCalibrationValues(minPWM, maxPWM);
-      
       // Update BLE calibration status characteristic with final values
       bleService.updateThrottleCalibrationStatus(true, minPWM, maxPWM);
       
-      // Send an additional notification to ensure the app gets the update
-      delay(100); // Small delay to ensure the first update is processed
-      bleService.notifyCalibrationStatus();
-      
-      // Stop calibration
-      throttleReader.stopCalibration();
+      // Send an additional notification to ensure the app gets the update,
+      // after the first one has been processed
+      if (!deferredActions.schedule(notifyCalibrationStatusAction, nullptr, CALIBRATION_NOTIFY_DELAY_MS)) {
+        bleService.notifyCalibrationStatus();
+      }
     }
-  }
-  
-  // Update LED effects using render method
-  // The speedMs setting from settings controls animation timing for:
-  // - Pulse mode afterburner effects
-  // - Breathing effects in Ease and Pulse modes  
-  // - Flicker animation speed
-  // - Sparkle frequency during afterburner
-  ledEffects.render(settingsManager.getSettings(), throttle);
-  
-  // Update BLE service
-  uint8_t currentMode = settingsManager.getSettings().mode;
-  bleService.updateStatus(throttle, currentMode);
-  
-  // Log mode changes only when they occur
-  static unsigned long lastModeLog = 0;
-  static uint8_t lastLoggedMode = 255; // Track if mode changed
-  if (millis() - lastModeLog > 5000) {
-    if (currentMode != lastLoggedMode) {
-      Serial.printf("Mode changed: %d -> %d\n", lastLoggedMode, currentMode);
-      lastLoggedMode = currentMode;
-    }
-    lastModeLog = millis();
-  }
-  
-  // Check flash memory status every 30 seconds
-  static unsigned long lastFlashCheck = 0;
-  if (millis() - lastFlashCheck > 30000) {
-    // Only check if settings manager is properly initialized
-    if (settingsManager.isInitialized()) {
-      if (settingsManager.hasSavedSettings()) {
-        settingsManager.checkFlashStatus();
+    
+    // Update BLE service
+    uint8_t currentMode = settings.mode;
+    uint8_t statusFlags = 0;
+    if (input.calibrating) {
+      statusFlags |= STATUS_FLAG_CALIBRATING;
+    }
+    if (settings.throttleCalibrated) {
+      statusFlags |= STATUS_FLAG_CALIBRATED;
+    }
+    if (!isnan(input.throttle) && input.throttle * 100.0f > settings.abThreshold) {
+      statusFlags |= STATUS_FLAG_AFTERBURNER;
+    }
+    if (settingsManager.isDirty()) {
+      statusFlags |= STATUS_FLAG_SETTINGS_DIRTY;
+    }
+    if (ledCurrentMa < ledRequestedMa) {
+      statusFlags |= STATUS_FLAG_POWER_LIMITED;
+    }
+    bleService.updateStatus(input.throttle, currentMode, statusFlags, ledCurrentMa);
+    bleService.updateTelemetry();
+    
+    // Short connection interval while the app is tuning, calibrating or streaming
+    static uint32_t lastSettingsVersion = 0;
+    uint32_t settingsVersion = settingsManager.getSettingsVersion();
+    bool linkActive = telemetry.isEnabled() || input.calibrating || settingsVersion != lastSettingsVersion;
+    lastSettingsVersion = settingsVersion;
+    bleService.updateConnection(linkActive);
+    
+    // Log mode changes only when they occur
+    static unsigned long lastModeLog = 0;
+    static uint8_t lastLoggedMode = 255; // Track if mode changed
+    if (millis() - lastModeLog > 5000) {
+      if (currentMode != lastLoggedMode) {
+        LOG_INFO(SYSTEM, "Mode changed: %d -> %d\n", lastLoggedMode, currentMode);
+        lastLoggedMode = currentMode;
       }
+      lastModeLog = millis();
     }
-    lastFlashCheck = millis();
-  }
-  
-  // Blink onboard LED every 2 seconds to show activity
-  static unsigned long lastBlink = 0;
-  static bool ledState = false;
-  unsigned long currentTime = millis();
-  
-  if (currentTime - lastBlink > STATUS_UPDATE_INTERVAL_MS) {
-    ledState = !ledState;
-    digitalWrite(ONBOARD_LED_PIN, ledState);
-    lastBlink = currentTime;
     
-    // // Print status every 2 seconds
-    // Serial.printf("Status - Throttle: %.1f%%, Mode: %d, Free Heap: %lu bytes\n", 
-    //               throttle * 100, settingsManager.getSettings().mode, ESP.getFreeHeap());
+    // Log render cadence statistics
+    static unsigned long lastRenderStatsLog = 0;
+    if (millis() - lastRenderStatsLog > RENDER_STATS_INTERVAL_MS) {
+      LOG_INFO(SYSTEM, "Render: %u/%u FPS, jitter avg %lu us max %lu us, dropped %lu of %lu frames\n",
+                    renderScheduler.getAchievedFps(), renderScheduler.getTargetFps(),
+                    (unsigned long)renderScheduler.getAverageJitterUs(),
+                    (unsigned long)renderScheduler.getMaxJitterUs(),
+                    (unsigned long)renderScheduler.getFramesDropped(),
+                    (unsigned long)(renderScheduler.getFramesRendered() + renderScheduler.getFramesDropped()));
+      LOG_INFO(SYSTEM, "Frame: render %lu us, transmit %lu us (max %lu), wait %lu us, idle %lu us, skipped %u.%u%%\n",
+                    (unsigned long)frameTimings.getRenderUs(), (unsigned long)frameTimings.getTransmitUs(),
+                    (unsigned long)frameTimings.getMaxTransmitUs(), (unsigned long)frameTimings.getWaitUs(),
+                    (unsigned long)frameTimings.getIdleUs(),
+                    frameTimings.getSkipPermille() / 10, frameTimings.getSkipPermille() % 10);
+      LOG_INFO(SYSTEM, "LED power: ~%u mA of %u mA requested, budget %u mA\n",
+                    ledCurrentMa, ledRequestedMa, settings.powerBudgetMa);
+      lastRenderStatsLog = millis();
+    }
     
-    // Show BLE connection status
-    if (bleService.isConnected()) {
-      Serial.println("BLE: Client connected");
-    } else {
-      bleService.ensureAdvertising();
+    // Delayed BLE work (connect status, advertising restarts, notifications)
+    deferredActions.run(millis());
+    
+    // Write coalesced settings changes once they have settled (or on SAVE)
+    settingsManager.processPendingCommit();
+    
+    // Check flash memory status every 30 seconds
+    static unsigned long lastFlashCheck = 0;
+    if (millis() - lastFlashCheck > 30000) {
+      // Only check if settings manager is properly initialized
+      if (settingsManager.isInitialized()) {
+        if (settingsManager.hasSavedSettings()) {
+          settingsManager.checkFlashStatus();
+        }
+      }
+      
+      // Lowest free heap since boot is the heap high-water mark; BLE writes
+      // should never change the free heap
+      const HeapWatermark& heap = bleService.getHeapWatermark();
+      LOG_INFO(SYSTEM, "Heap: %lu free, %lu lowest, %lu largest block; BLE writes %lu, %lu changed heap (max %ld bytes)\n",
+                    (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap(),
+                    (unsigned long)ESP.getMaxAllocHeap(), (unsigned long)heap.getWrites(),
+                    (unsigned long)heap.getChangedWrites(), (long)heap.getLargestChange());
+      lastFlashCheck = millis();
+    }
+    
+    // Blink onboard LED every 2 seconds to show activity
+    static unsigned long lastBlink = 0;
+    static bool ledState = false;
+    unsigned long currentTime = millis();
+    
+    if (currentTime - lastBlink > STATUS_UPDATE_INTERVAL_MS) {
+      ledState = !ledState;
+      digitalWrite(ONBOARD_LED_PIN, ledState);
+      lastBlink = currentTime;
+      
+      // // Print status every 2 seconds
+      // Serial.printf("Status - Throttle: %.1f%%, Mode: %d, Free Heap: %lu bytes\n", 
+      //               throttle * 100, settingsManager.getSettings().mode, ESP.getFreeHeap());
+      
+      // Show BLE connection status
+      if (bleService.isConnected()) {
+        LOG_DEBUG(SYSTEM, "BLE: Client connected\n");
+      } else {
+        bleService.ensureAdvertising();
+      }
+     
     }
-   
+    
+    // Fixed period so the binary status keeps its 50 Hz rate
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(SYSTEM_TASK_PERIOD_MS));
   }
-  
-  delay(LOOP_DELAY_MS); // Small delay for stability
 }
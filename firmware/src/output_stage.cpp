@@ -0,0 +1,101 @@
+#include "output_stage.h"
+
+// Bit-reversed frame counter: any run of 2^k aligned frames spreads its
+// thresholds evenly, so short windows average close to the target too
+static uint8_t reverseBits(uint8_t value) {
+  value = (value & 0xF0) >> 4 | (value & 0x0F) << 4;
+  value = (value & 0xCC) >> 2 | (value & 0x33) << 2;
+  value = (value & 0xAA) >> 1 | (value & 0x55) << 1;
+  return value;
+}
+
+OutputStage::OutputStage() {
+  levels = nullptr;
+  ledCount = 0;
+  memset(channelSums, 0, sizeof(channelSums));
+  scale = Q16_16_ONE;
+  ditherFrame = 0;
+  fractional = false;
+  for (uint16_t i = 0; i < 256; i++) {
+    gammaTable[i] = i << 8;
+  }
+}
+
+OutputStage::~OutputStage() {
+  if (levels) {
+    delete[] levels;
+  }
+}
+
+void OutputStage::begin(uint16_t count, float gamma) {
+  if (levels) {
+    delete[] levels;
+  }
+  ledCount = count;
+  levels = new uint16_t[count * 3];
+  memset(levels, 0, count * 3 * sizeof(uint16_t));
+  memset(channelSums, 0, sizeof(channelSums));
+  scale = Q16_16_ONE;
+  ditherFrame = 0;
+  fractional = false;
+  
+  for (uint16_t i = 0; i < 256; i++) {
+    gammaTable[i] = (uint16_t)(powf(i / 255.0f, gamma) * OUTPUT_LEVEL_MAX + 0.5f);
+  }
+}
+
+void OutputStage::encode(const CRGB* leds, uint8_t brightness) {
+  uint16_t lowBits = 0;
+  uint32_t sums[3] = {0, 0, 0};
+  uint16_t* level = levels;
+  for (uint16_t i = 0; i < ledCount; i++) {
+    for (uint8_t c = 0; c < 3; c++) {
+      uint32_t value = ((uint32_t)gammaTable[leds[i].raw[c]] * brightness + 127) / 255;
+      *level++ = value;
+      lowBits |= value & 0xFF;
+      sums[c] += value;
+    }
+  }
+  fractional = lowBits != 0;
+  memcpy(channelSums, sums, sizeof(channelSums));
+}
+
+void OutputStage::setScale(q16_16_t levelScale) {
+  scale = constrain(levelScale, 0, Q16_16_ONE);
+}
+
+void OutputStage::dither(CRGB* leds) {
+#if OUTPUT_DITHER
+  uint8_t frameThreshold = reverseBits(ditherFrame++);
+#endif
+  const uint16_t* level = levels;
+  for (uint16_t i = 0; i < ledCount; i++) {
+    for (uint8_t c = 0; c < 3; c++) {
+#if OUTPUT_DITHER
+      // Offset per LED and channel, so neighbours do not step up together
+      uint8_t threshold = frameThreshold ^ (uint8_t)(i * 113 + c * 71);
+#else
+      uint8_t threshold = 0x80;
+#endif
+      uint16_t value = ((uint32_t)*level++ * scale) >> 16;
+      leds[i].raw[c] = (value + threshold) >> 8;
+    }
+  }
+}
+
+bool OutputStage::needsDither() const {
+  // Scaled levels rarely land on 8-bit steps
+  return OUTPUT_DITHER && (fractional || scale < Q16_16_ONE);
+}
+
+const uint16_t* OutputStage::getLevels() const {
+  return levels;
+}
+
+const uint32_t* OutputStage::getChannelSums() const {
+  return channelSums;
+}
+
+uint16_t OutputStage::getGammaLevel(uint8_t value) const {
+  return gammaTable[value];
+}
@@ -0,0 +1,54 @@
+#ifndef OUTPUT_STAGE_H
+#define OUTPUT_STAGE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "constants.h"
+#include "fixed_point.h"
+
+// Turns rendered colours into what the strip is sent.
+//
+// Effects work in 8-bit, perceptually spaced colour. encode() maps every
+// channel through a gamma table to 16-bit linear light and applies the
+// brightness setting there, so a dim setting keeps every step of a gradient
+// instead of folding it onto a handful of 8-bit levels. dither() rounds the
+// 16-bit frame to 8 bits against a threshold that moves every frame: over
+// OUTPUT_DITHER_FRAMES consecutive frames each channel averages exactly its
+// 16-bit value.
+//
+// encode() also sums each channel's levels over the frame for the power
+// limiter, whose scale dither() applies on the way out.
+//
+// 16-bit levels run 0-OUTPUT_LEVEL_MAX (8-bit level << 8); a level with a zero
+// low byte is an exact 8-bit level and is sent the same every frame.
+#define OUTPUT_LEVEL_MAX 0xFF00
+#define OUTPUT_DITHER_FRAMES 256
+
+class OutputStage {
+private:
+  uint16_t gammaTable[256];  // 8-bit colour -> 16-bit linear level
+  uint16_t* levels;          // r, g, b per LED
+  uint16_t ledCount;
+  uint32_t channelSums[3];   // Red, green, blue levels of the last encode()
+  q16_16_t scale;            // Applied by dither(), Q16_16_ONE = as encoded
+  uint8_t ditherFrame;       // Position in the dither cycle
+  bool fractional;           // Some channel lies between two 8-bit levels
+
+public:
+  OutputStage();
+  ~OutputStage();
+  void begin(uint16_t count, float gamma = OUTPUT_GAMMA);
+
+  void encode(const CRGB* leds, uint8_t brightness);
+  void setScale(q16_16_t levelScale);  // 0 to Q16_16_ONE, until changed
+  void dither(CRGB* leds);   // Next frame of the dither cycle, ledCount LEDs
+
+  // False if every channel is an exact 8-bit level: dither() would repeat the last frame
+  bool needsDither() const;
+
+  const uint16_t* getLevels() const;
+  const uint32_t* getChannelSums() const;
+  uint16_t getGammaLevel(uint8_t value) const;
+};
+
+#endif // OUTPUT_STAGE_H
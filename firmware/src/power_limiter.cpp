@@ -0,0 +1,64 @@
+#include "power_limiter.h"
+#include "output_stage.h"
+#include "constants.h"
+
+PowerLimiter::PowerLimiter() {
+  channelMa[0] = LED_MA_RED;
+  channelMa[1] = LED_MA_GREEN;
+  channelMa[2] = LED_MA_BLUE;
+  idleMa = LED_MA_IDLE;
+  budgetMa = 0;
+  requestedMa = 0;
+  estimatedMa = 0;
+  scale = Q16_16_ONE;
+}
+
+void PowerLimiter::setChannelCurrents(uint16_t redMa, uint16_t greenMa, uint16_t blueMa, uint16_t ledIdleMa) {
+  channelMa[0] = redMa;
+  channelMa[1] = greenMa;
+  channelMa[2] = blueMa;
+  idleMa = ledIdleMa;
+}
+
+void PowerLimiter::setBudget(uint16_t limitMa) {
+  budgetMa = limitMa;
+}
+
+q16_16_t PowerLimiter::update(const uint32_t* channelSums, uint16_t ledCount) {
+  uint64_t levelMa = 0;  // mA * OUTPUT_LEVEL_MAX
+  for (uint8_t c = 0; c < 3; c++) {
+    levelMa += (uint64_t)channelSums[c] * channelMa[c];
+  }
+  uint32_t activeMa = (uint32_t)(levelMa / OUTPUT_LEVEL_MAX);
+  uint32_t ledIdleMa = (uint32_t)ledCount * idleMa;
+  requestedMa = ledIdleMa + activeMa;
+  
+  if (budgetMa == 0 || requestedMa <= budgetMa || activeMa == 0) {
+    scale = Q16_16_ONE;
+    estimatedMa = requestedMa;
+  } else if (budgetMa <= ledIdleMa) {
+    // Not even a dark strip fits; send it dark rather than not at all
+    scale = 0;
+    estimatedMa = ledIdleMa;
+  } else {
+    scale = (q16_16_t)(((uint64_t)(budgetMa - ledIdleMa) << 16) / activeMa);
+    estimatedMa = ledIdleMa + (uint32_t)(((uint64_t)activeMa * scale) >> 16);
+  }
+  return scale;
+}
+
+q16_16_t PowerLimiter::getScale() const {
+  return scale;
+}
+
+uint32_t PowerLimiter::getRequestedMa() const {
+  return requestedMa;
+}
+
+uint32_t PowerLimiter::getEstimatedMa() const {
+  return estimatedMa;
+}
+
+bool PowerLimiter::isLimiting() const {
+  return scale < Q16_16_ONE;
+}
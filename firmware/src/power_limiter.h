@@ -0,0 +1,39 @@
+#ifndef POWER_LIMITER_H
+#define POWER_LIMITER_H
+
+#include <Arduino.h>
+#include "fixed_point.h"
+
+// Keeps the strip's estimated current within a budget.
+//
+// The estimate is linear in the output levels: each channel draws its full
+// current (channelMa) at OUTPUT_LEVEL_MAX, and every LED draws idleMa with all
+// channels off. update() takes the per-channel sums of the 16-bit levels that
+// OutputStage::encode() accumulates, so no extra pass over the frame is
+// needed; the scale it returns is applied by OutputStage::dither(). Idle
+// current cannot be dimmed away, so only the channel current is scaled.
+class PowerLimiter {
+private:
+  uint16_t channelMa[3];  // One LED's red, green, blue at full level
+  uint16_t idleMa;        // One LED, all channels off
+  uint16_t budgetMa;      // 0 = no limit
+  uint32_t requestedMa;   // Last frame, as rendered
+  uint32_t estimatedMa;   // Last frame, as sent
+  q16_16_t scale;
+
+public:
+  PowerLimiter();
+  void setChannelCurrents(uint16_t redMa, uint16_t greenMa, uint16_t blueMa, uint16_t ledIdleMa);
+  void setBudget(uint16_t limitMa);
+
+  // channelSums: red, green and blue levels summed over ledCount LEDs.
+  // Returns the scale for the levels, Q16_16_ONE when within budget.
+  q16_16_t update(const uint32_t* channelSums, uint16_t ledCount);
+
+  q16_16_t getScale() const;
+  uint32_t getRequestedMa() const;
+  uint32_t getEstimatedMa() const;
+  bool isLimiting() const;
+};
+
+#endif // POWER_LIMITER_H
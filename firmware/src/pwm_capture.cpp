@@ -0,0 +1,97 @@
+#include "pwm_capture.h"
+
+#define PWM_CAPTURE_BUFFER_MASK (PWM_CAPTURE_BUFFER_SIZE - 1)
+
+uint8_t PwmCapture::capturePin = THROTTLE_PIN;
+volatile uint32_t PwmCapture::riseTimeUs = 0;
+volatile bool PwmCapture::risePending = false;
+volatile uint16_t PwmCapture::latestPulseUs = 0;
+volatile uint32_t PwmCapture::latestPulseTimeUs = 0;
+uint16_t PwmCapture::pulseBuffer[PWM_CAPTURE_BUFFER_SIZE];
+std::atomic<uint8_t> PwmCapture::head(0);
+std::atomic<uint8_t> PwmCapture::tail(0);
+volatile uint32_t PwmCapture::pulseCount = 0;
+volatile uint32_t PwmCapture::droppedPulses = 0;
+
+void PwmCapture::begin(uint8_t pin) {
+  capturePin = pin;
+  risePending = false;
+  latestPulseUs = 0;
+  head.store(0);
+  tail.store(0);
+  
+  pinMode(capturePin, INPUT);
+  attachInterrupt(digitalPinToInterrupt(capturePin), handleEdge, CHANGE);
+}
+
+void IRAM_ATTR PwmCapture::handleEdge() {
+  uint32_t now = micros();
+  
+  if (digitalRead(capturePin) == HIGH) {
+    riseTimeUs = now;
+    risePending = true;
+    return;
+  }
+  
+  // Falling edge without a matching rising edge (e.g. first edge after begin)
+  if (!risePending) {
+    return;
+  }
+  risePending = false;
+  
+  // Same acceptance window as pulseIn(HIGH, PWM_TIMEOUT)
+  uint32_t width = now - riseTimeUs;
+  if (width == 0 || width > PWM_TIMEOUT) {
+    return;
+  }
+  
+  latestPulseUs = width;
+  latestPulseTimeUs = now;
+  pulseCount++;
+  
+  uint8_t currentHead = head.load(std::memory_order_relaxed);
+  uint8_t nextHead = (currentHead + 1) & PWM_CAPTURE_BUFFER_MASK;
+  if (nextHead == tail.load(std::memory_order_acquire)) {
+    // Full: drop the newest pulse, the consumer owns the tail
+    droppedPulses++;
+    return;
+  }
+  pulseBuffer[currentHead] = width;
+  head.store(nextHead, std::memory_order_release);
+}
+
+uint16_t PwmCapture::getLatestPulse() {
+  // Read the timestamp before micros() so a pulse landing in between cannot
+  // make the age wrap around. Width and timestamp may come from consecutive
+  // pulses, which only shifts the staleness check by one period.
+  uint32_t pulseTime = latestPulseTimeUs;
+  uint16_t pulseUs = latestPulseUs;
+  uint32_t age = micros() - pulseTime;
+  
+  if (pulseUs == 0 || age > PWM_TIMEOUT) {
+    return 0;
+  }
+  return pulseUs;
+}
+
+bool PwmCapture::popPulse(uint16_t& pulseUs) {
+  uint8_t currentTail = tail.load(std::memory_order_relaxed);
+  if (currentTail == head.load(std::memory_order_acquire)) {
+    return false;
+  }
+  pulseUs = pulseBuffer[currentTail];
+  tail.store((currentTail + 1) & PWM_CAPTURE_BUFFER_MASK, std::memory_order_release);
+  return true;
+}
+
+void PwmCapture::flush() {
+  tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint32_t PwmCapture::getPulseCount() {
+  return pulseCount;
+}
+
+uint32_t PwmCapture::getDroppedPulses() {
+  return droppedPulses;
+}
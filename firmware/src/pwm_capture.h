@@ -0,0 +1,52 @@
+#ifndef PWM_CAPTURE_H
+#define PWM_CAPTURE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "constants.h"
+
+#define PWM_CAPTURE_BUFFER_SIZE 16  // Pulses queued for calibration (power of two)
+
+// Interrupt-driven RC PWM capture.
+// A CHANGE interrupt timestamps the rising edge and measures the pulse on the
+// falling edge, so reading the throttle never blocks the main loop the way
+// pulseIn() does. Each pulse updates the latest-pulse snapshot and is pushed
+// into a single-producer (ISR) / single-consumer (loop) lock-free ring buffer.
+// There is one throttle input, so the state is static and shared with the ISR.
+class PwmCapture {
+private:
+  static uint8_t capturePin;
+  static volatile uint32_t riseTimeUs;
+  static volatile bool risePending;
+
+  // Latest pulse: width and the time its falling edge was seen
+  static volatile uint16_t latestPulseUs;
+  static volatile uint32_t latestPulseTimeUs;
+
+  // SPSC ring buffer: head is written only by the ISR, tail only by the loop
+  static uint16_t pulseBuffer[PWM_CAPTURE_BUFFER_SIZE];
+  static std::atomic<uint8_t> head;
+  static std::atomic<uint8_t> tail;
+  static volatile uint32_t pulseCount;
+  static volatile uint32_t droppedPulses;
+
+  static void IRAM_ATTR handleEdge();
+
+public:
+  static void begin(uint8_t pin);
+
+  // Most recent pulse width in microseconds, or 0 if no pulse arrived within
+  // PWM_TIMEOUT (signal lost). O(1), never blocks.
+  static uint16_t getLatestPulse();
+
+  // Oldest queued pulse; returns false when the buffer is empty
+  static bool popPulse(uint16_t& pulseUs);
+
+  // Discards queued pulses (e.g. before starting calibration)
+  static void flush();
+
+  static uint32_t getPulseCount();
+  static uint32_t getDroppedPulses();  // Pulses lost because the buffer was full
+};
+
+#endif // PWM_CAPTURE_H
@@ -0,0 +1,138 @@
+#include "render_scheduler.h"
+
+#define STATS_WINDOW_US 1000000UL  // Achieved FPS and jitter are measured over 1 s windows
+
+RenderScheduler::RenderScheduler() {
+  targetFps = TARGET_FPS;
+  framePeriodUs = 1000000UL / TARGET_FPS;
+  nextDeadlineUs = 0;
+  
+  frameTimeMs = 0;
+  frameTimeRemainderUs = 0;
+  clockStarted = false;
+  
+  windowStartUs = 0;
+  windowFrames = 0;
+  windowJitterSumUs = 0;
+  windowJitterMaxUs = 0;
+  
+  achievedFps = 0;
+  averageJitterUs = 0;
+  maxJitterUs = 0;
+  
+  framesRendered = 0;
+  framesDropped = 0;
+}
+
+void RenderScheduler::begin(uint16_t fps) {
+  setTargetFps(fps);
+  
+  // First frame is due immediately; the animation clock starts at the current time
+  uint32_t now = micros();
+  nextDeadlineUs = now;
+  frameTimeMs = millis();
+  frameTimeRemainderUs = 0;
+  clockStarted = false;
+  windowStartUs = now;
+}
+
+void RenderScheduler::setTargetFps(uint16_t fps) {
+  targetFps = constrain(fps, MIN_TARGET_FPS, MAX_TARGET_FPS);
+  framePeriodUs = 1000000UL / targetFps;
+}
+
+uint16_t RenderScheduler::getTargetFps() {
+  return targetFps;
+}
+
+uint32_t RenderScheduler::getFramePeriodUs() {
+  return framePeriodUs;
+}
+
+bool RenderScheduler::frameDue() {
+  uint32_t now = micros();
+  int32_t lateness = (int32_t)(now - nextDeadlineUs);
+  if (lateness < 0) {
+    return false;
+  }
+  
+  // Drop every deadline that has already passed and render only the latest one,
+  // so a slow iteration costs frames instead of a burst of catch-up renders
+  uint32_t missed = (uint32_t)lateness / framePeriodUs;
+  uint32_t jitterUs = (uint32_t)lateness - missed * framePeriodUs;
+  framesDropped += missed;
+  nextDeadlineUs += (missed + 1) * framePeriodUs;
+  
+  // The animation clock follows the deadlines, not the actual start time
+  advanceClock(clockStarted ? missed + 1 : missed);
+  clockStarted = true;
+  
+  framesRendered++;
+  updateStats(now, jitterUs);
+  return true;
+}
+
+void RenderScheduler::waitForNextFrame() {
+  int32_t remaining = (int32_t)(nextDeadlineUs - micros());
+  if (remaining <= 0) {
+    return;
+  }
+  
+  if (remaining >= 1000) {
+    // Sleep (rounded up to whole ticks) so other tasks can run; waking up to
+    // 1 ms late shows up as jitter rather than as an early, skipped frame
+    delay((remaining + 999) / 1000);
+  } else {
+    delayMicroseconds(remaining);
+  }
+}
+
+unsigned long RenderScheduler::getFrameTime() {
+  return frameTimeMs;
+}
+
+void RenderScheduler::advanceClock(uint32_t periods) {
+  frameTimeRemainderUs += periods * framePeriodUs;
+  frameTimeMs += frameTimeRemainderUs / 1000;
+  frameTimeRemainderUs %= 1000;
+}
+
+void RenderScheduler::updateStats(uint32_t nowUs, uint32_t jitterUs) {
+  windowFrames++;
+  windowJitterSumUs += jitterUs;
+  if (jitterUs > windowJitterMaxUs) {
+    windowJitterMaxUs = jitterUs;
+  }
+  
+  uint32_t elapsedUs = nowUs - windowStartUs;
+  if (elapsedUs >= STATS_WINDOW_US) {
+    achievedFps = (windowFrames * 1000000UL + elapsedUs / 2) / elapsedUs;
+    averageJitterUs = windowJitterSumUs / windowFrames;
+    maxJitterUs = windowJitterMaxUs;
+    
+    windowStartUs = nowUs;
+    windowFrames = 0;
+    windowJitterSumUs = 0;
+    windowJitterMaxUs = 0;
+  }
+}
+
+uint16_t RenderScheduler::getAchievedFps() {
+  return achievedFps;
+}
+
+uint32_t RenderScheduler::getAverageJitterUs() {
+  return averageJitterUs;
+}
+
+uint32_t RenderScheduler::getMaxJitterUs() {
+  return maxJitterUs;
+}
+
+uint32_t RenderScheduler::getFramesRendered() {
+  return framesRendered;
+}
+
+uint32_t RenderScheduler::getFramesDropped() {
+  return framesDropped;
+}
@@ -0,0 +1,64 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+// Fixed-cadence frame scheduler.
+// Frames are due on micros() deadlines spaced 1/targetFps apart. When the loop
+// falls behind, missed deadlines are dropped instead of rendered back to back,
+// so the cadence (and animation speed) stays constant.
+// The frame timestamp advances by exactly one period per frame and is the
+// only clock the renderer should animate from.
+class RenderScheduler {
+private:
+  uint16_t targetFps;
+  uint32_t framePeriodUs;
+  uint32_t nextDeadlineUs;
+
+  // Animation clock: advanced by whole frame periods
+  unsigned long frameTimeMs;
+  uint32_t frameTimeRemainderUs;
+  bool clockStarted;
+
+  // Statistics for the current reporting window
+  uint32_t windowStartUs;
+  uint32_t windowFrames;
+  uint32_t windowJitterSumUs;
+  uint32_t windowJitterMaxUs;
+
+  // Statistics from the last completed window
+  uint16_t achievedFps;
+  uint32_t averageJitterUs;
+  uint32_t maxJitterUs;
+
+  uint32_t framesRendered;
+  uint32_t framesDropped;
+
+  void advanceClock(uint32_t periods);
+  void updateStats(uint32_t nowUs, uint32_t jitterUs);
+
+public:
+  RenderScheduler();
+  void begin(uint16_t fps);
+  void setTargetFps(uint16_t fps);
+  uint16_t getTargetFps();
+  uint32_t getFramePeriodUs();
+
+  // Returns true when a frame should be rendered now
+  bool frameDue();
+
+  // Sleeps until the next frame deadline (yields to other tasks)
+  void waitForNextFrame();
+
+  // Animation timestamp of the current frame in milliseconds
+  unsigned long getFrameTime();
+
+  uint16_t getAchievedFps();
+  uint32_t getAverageJitterUs();
+  uint32_t getMaxJitterUs();
+  uint32_t getFramesRendered();
+  uint32_t getFramesDropped();
+};
+
+#endif // RENDER_SCHEDULER_H
@@ -0,0 +1,201 @@
+#include "ring_topology.h"
+
+static void putUint16(uint8_t* data, uint16_t value) {
+  data[0] = value & 0xFF;
+  data[1] = value >> 8;
+}
+
+static uint16_t getUint16(const uint8_t* data) {
+  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+void makeLegacyTopology(uint16_t ledsPerRing, RingTopology& topology) {
+  memset(&topology, 0, sizeof(topology));
+  topology.segmentCount = LEGACY_RING_COUNT;
+  for (uint8_t ring = 0; ring < LEGACY_RING_COUNT; ring++) {
+    topology.segments[ring].start = ring * ledsPerRing;
+    topology.segments[ring].length = ledsPerRing;
+  }
+  // Second ring runs the other way and half a turn behind for contrast
+  topology.segments[1].flags = RING_SEGMENT_REVERSED;
+  topology.segments[1].phaseOffset = 32768;  // Half a turn
+#if LEGACY_RING_OUTPUTS > 1
+  topology.segments[1].flags |= RING_SEGMENT_OUTPUT(1);
+#endif
+}
+
+void resolveTopology(const RingTopology& configured, uint16_t ledsPerRing, RingTopology& resolved) {
+  if (configured.segmentCount == 0) {
+    makeLegacyTopology(ledsPerRing, resolved);
+  } else {
+    resolved = configured;
+  }
+}
+
+uint16_t getTopologyLedCount(const RingTopology& topology) {
+  uint16_t count = 0;
+  for (uint8_t i = 0; i < topology.segmentCount && i < MAX_RING_SEGMENTS; i++) {
+    uint16_t end = topology.segments[i].start + topology.segments[i].length;
+    if (end > count) {
+      count = end;
+    }
+  }
+  return count;
+}
+
+bool getOutputRange(const RingTopology& topology, uint8_t output, uint16_t& start, uint16_t& length) {
+  uint16_t first = 0;
+  uint16_t end = 0;
+  bool used = false;
+  for (uint8_t i = 0; i < topology.segmentCount && i < MAX_RING_SEGMENTS; i++) {
+    const RingSegment& segment = topology.segments[i];
+    if (getSegmentOutput(segment) != output) {
+      continue;
+    }
+    if (!used || segment.start < first) {
+      first = segment.start;
+    }
+    if (!used || segment.start + segment.length > end) {
+      end = segment.start + segment.length;
+    }
+    used = true;
+  }
+  start = first;
+  length = end - first;
+  return used;
+}
+
+TopologyStatus validateTopology(const RingTopology& topology) {
+  if (topology.segmentCount > MAX_RING_SEGMENTS) {
+    return TOPOLOGY_TOO_MANY_SEGMENTS;
+  }
+  
+  for (uint8_t i = 0; i < topology.segmentCount; i++) {
+    const RingSegment& segment = topology.segments[i];
+    if (segment.length == 0) {
+      return TOPOLOGY_EMPTY_SEGMENT;
+    }
+    if ((uint32_t)segment.start + segment.length > MAX_TOPOLOGY_LEDS) {
+      return TOPOLOGY_OUT_OF_RANGE;
+    }
+    if (segment.flags & ~RING_SEGMENT_FLAGS) {
+      return TOPOLOGY_BAD_FLAGS;
+    }
+    if (getSegmentOutput(segment) >= LED_OUTPUT_COUNT) {
+      return TOPOLOGY_BAD_OUTPUT;
+    }
+    for (uint8_t j = 0; j < i; j++) {
+      const RingSegment& other = topology.segments[j];
+      if (segment.start < other.start + other.length && other.start < segment.start + segment.length) {
+        return TOPOLOGY_OVERLAP;
+      }
+    }
+  }
+  
+  // Each output sends one contiguous run of the strip
+  for (uint8_t output = 0; output < LED_OUTPUT_COUNT; output++) {
+    uint16_t start, length;
+    if (!getOutputRange(topology, output, start, length)) {
+      continue;
+    }
+    for (uint8_t i = 0; i < topology.segmentCount; i++) {
+      const RingSegment& segment = topology.segments[i];
+      if (getSegmentOutput(segment) != output && segment.start < start + length && start < segment.start + segment.length) {
+        return TOPOLOGY_OUTPUT_INTERLEAVED;
+      }
+    }
+  }
+  return TOPOLOGY_OK;
+}
+
+bool sameTopology(const RingTopology& a, const RingTopology& b) {
+  if (a.segmentCount != b.segmentCount) {
+    return false;
+  }
+  for (uint8_t i = 0; i < a.segmentCount && i < MAX_RING_SEGMENTS; i++) {
+    const RingSegment& x = a.segments[i];
+    const RingSegment& y = b.segments[i];
+    if (x.start != y.start || x.length != y.length || x.flags != y.flags || x.phaseOffset != y.phaseOffset) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t encodeTopology(const RingTopology& topology, uint8_t* data) {
+  uint8_t count = topology.segmentCount > MAX_RING_SEGMENTS ? MAX_RING_SEGMENTS : topology.segmentCount;
+  data[0] = TOPOLOGY_VERSION;
+  data[1] = count;
+  
+  uint8_t* segmentData = data + TOPOLOGY_HEADER_SIZE;
+  for (uint8_t i = 0; i < count; i++) {
+    const RingSegment& segment = topology.segments[i];
+    putUint16(segmentData, segment.start);
+    putUint16(segmentData + 2, segment.length);
+    segmentData[4] = segment.flags;
+    putUint16(segmentData + 5, segment.phaseOffset);
+    segmentData += TOPOLOGY_SEGMENT_SIZE;
+  }
+  return TOPOLOGY_HEADER_SIZE + count * TOPOLOGY_SEGMENT_SIZE;
+}
+
+TopologyStatus decodeTopology(const uint8_t* data, size_t length, RingTopology& topology) {
+  if (length < TOPOLOGY_HEADER_SIZE) {
+    return TOPOLOGY_BAD_LENGTH;
+  }
+  if (data[0] != TOPOLOGY_VERSION) {
+    return TOPOLOGY_BAD_VERSION;
+  }
+  uint8_t count = data[1];
+  if (count > MAX_RING_SEGMENTS) {
+    return TOPOLOGY_TOO_MANY_SEGMENTS;
+  }
+  if (length != TOPOLOGY_HEADER_SIZE + (size_t)count * TOPOLOGY_SEGMENT_SIZE) {
+    return TOPOLOGY_BAD_LENGTH;
+  }
+  
+  RingTopology decoded;
+  memset(&decoded, 0, sizeof(decoded));
+  decoded.segmentCount = count;
+  const uint8_t* segmentData = data + TOPOLOGY_HEADER_SIZE;
+  for (uint8_t i = 0; i < count; i++) {
+    RingSegment& segment = decoded.segments[i];
+    segment.start = getUint16(segmentData);
+    segment.length = getUint16(segmentData + 2);
+    segment.flags = segmentData[4];
+    segment.phaseOffset = getUint16(segmentData + 5);
+    segmentData += TOPOLOGY_SEGMENT_SIZE;
+  }
+  
+  TopologyStatus status = validateTopology(decoded);
+  if (status == TOPOLOGY_OK) {
+    topology = decoded;
+  }
+  return status;
+}
+
+const char* topologyStatusName(TopologyStatus status) {
+  switch (status) {
+    case TOPOLOGY_OK:
+      return "ok";
+    case TOPOLOGY_BAD_LENGTH:
+      return "bad length";
+    case TOPOLOGY_BAD_VERSION:
+      return "bad version";
+    case TOPOLOGY_TOO_MANY_SEGMENTS:
+      return "too many segments";
+    case TOPOLOGY_EMPTY_SEGMENT:
+      return "empty segment";
+    case TOPOLOGY_OUT_OF_RANGE:
+      return "out of range";
+    case TOPOLOGY_OVERLAP:
+      return "overlapping segments";
+    case TOPOLOGY_BAD_FLAGS:
+      return "bad flags";
+    case TOPOLOGY_BAD_OUTPUT:
+      return "bad output";
+    case TOPOLOGY_OUTPUT_INTERLEAVED:
+      return "interleaved outputs";
+  }
+  return "unknown";
+}
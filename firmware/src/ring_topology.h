@@ -0,0 +1,89 @@
+#ifndef RING_TOPOLOGY_H
+#define RING_TOPOLOGY_H
+
+#include <Arduino.h>
+#include "constants.h"
+
+// Which LEDs of the strip form which engine ring.
+//
+// Each segment is `length` consecutive LEDs starting at `start`. Ring
+// positions (the afterburner's spatial profile) run backwards on a reversed
+// segment, and the phase offset shifts the ring's breathing and pulse. An
+// empty topology is the original layout: two rings of settings.numLeds, the
+// second reversed and half a turn out of phase.
+//
+// Each segment is driven from one of LED_OUTPUT_COUNT outputs (flag bits 4-5,
+// 0 on older layouts). An output owns the strip from the start of its first
+// segment to the end of its last, so outputs may not interleave.
+#define MAX_RING_SEGMENTS 4          // Up to four engines
+#define MAX_TOPOLOGY_LEDS 600        // Same total as two rings of MAX_NUM_LEDS
+#define LEGACY_RING_COUNT 2
+
+#define RING_SEGMENT_REVERSED 0x01
+#define RING_SEGMENT_OUTPUT_SHIFT 4
+#define RING_SEGMENT_OUTPUT_MASK 0x30
+#define RING_SEGMENT_OUTPUT(n) (((n) << RING_SEGMENT_OUTPUT_SHIFT) & RING_SEGMENT_OUTPUT_MASK)
+#define RING_SEGMENT_FLAGS (RING_SEGMENT_REVERSED | RING_SEGMENT_OUTPUT_MASK)  // All defined flags
+
+struct RingSegment {
+  uint16_t start;        // First LED on the strip
+  uint16_t length;       // LEDs in the ring
+  uint8_t flags;         // RING_SEGMENT_*
+  uint16_t phaseOffset;  // Added to the breathing and pulse angle, 65536 == full turn
+};
+
+struct RingTopology {
+  uint8_t segmentCount;  // 0 = legacy two-ring layout
+  RingSegment segments[MAX_RING_SEGMENTS];
+};
+
+// Encoded form (TOPOLOGY_UUID and the settings record), little-endian:
+//
+//   version (1) | segment count (1) | per segment: start (2) | length (2) | flags (1) | phase offset (2)
+#define TOPOLOGY_VERSION 1
+#define TOPOLOGY_HEADER_SIZE 2
+#define TOPOLOGY_SEGMENT_SIZE 7
+#define TOPOLOGY_MAX_SIZE (TOPOLOGY_HEADER_SIZE + MAX_RING_SEGMENTS * TOPOLOGY_SEGMENT_SIZE)
+
+enum TopologyStatus : uint8_t {
+  TOPOLOGY_OK,
+  TOPOLOGY_BAD_LENGTH,
+  TOPOLOGY_BAD_VERSION,
+  TOPOLOGY_TOO_MANY_SEGMENTS,
+  TOPOLOGY_EMPTY_SEGMENT,
+  TOPOLOGY_OUT_OF_RANGE,     // Ends past MAX_TOPOLOGY_LEDS
+  TOPOLOGY_OVERLAP,
+  TOPOLOGY_BAD_FLAGS,
+  TOPOLOGY_BAD_OUTPUT,       // Output index >= LED_OUTPUT_COUNT
+  TOPOLOGY_OUTPUT_INTERLEAVED  // Another output's segment lies inside this output's range
+};
+
+inline uint8_t getSegmentOutput(const RingSegment& segment) {
+  return (segment.flags & RING_SEGMENT_OUTPUT_MASK) >> RING_SEGMENT_OUTPUT_SHIFT;
+}
+
+// Two rings of ledsPerRing, as rendered before topologies existed
+void makeLegacyTopology(uint16_t ledsPerRing, RingTopology& topology);
+
+// The layout to render: configured, or the legacy layout if it is empty
+void resolveTopology(const RingTopology& configured, uint16_t ledsPerRing, RingTopology& resolved);
+
+// LEDs the strip needs (end of the last segment); gaps between segments stay dark
+uint16_t getTopologyLedCount(const RingTopology& topology);
+
+// LEDs an output drives: from its first segment's start to its last segment's
+// end. Returns false (start and length 0) if no segment uses the output.
+bool getOutputRange(const RingTopology& topology, uint8_t output, uint16_t& start, uint16_t& length);
+
+TopologyStatus validateTopology(const RingTopology& topology);
+bool sameTopology(const RingTopology& a, const RingTopology& b);
+
+// Writes up to TOPOLOGY_MAX_SIZE bytes; returns the length
+size_t encodeTopology(const RingTopology& topology, uint8_t* data);
+
+// length must match the segment count exactly; topology is only written on TOPOLOGY_OK
+TopologyStatus decodeTopology(const uint8_t* data, size_t length, RingTopology& topology);
+
+const char* topologyStatusName(TopologyStatus status);
+
+#endif // RING_TOPOLOGY_H
@@ -1,46 +1,110 @@
 #include "settings.h"
+#include "settings_record.h"
 #include "constants.h"
+#include "logging.h"
+
+// Per-key layout used before the single settings record (migrated once)
+static const char* LEGACY_KEYS[] = {
+  "mode", "startR", "startG", "startB", "endR", "endG", "endB",
+  "speed", "bright", "numLeds", "abThresh", "throttleMin", "throttleMax", "throttleCal"
+};
+#define LEGACY_KEY_COUNT (sizeof(LEGACY_KEYS) / sizeof(LEGACY_KEYS[0]))
+
+static bool sameSettings(const AfterburnerSettings& a, const AfterburnerSettings& b) {
+  return a.mode == b.mode &&
+         memcmp(a.startColor, b.startColor, 3) == 0 && memcmp(a.endColor, b.endColor, 3) == 0 &&
+         a.speedMs == b.speedMs && a.brightness == b.brightness && a.numLeds == b.numLeds &&
+         a.abThreshold == b.abThreshold && a.throttleMin == b.throttleMin &&
+         a.throttleMax == b.throttleMax && a.throttleCalibrated == b.throttleCalibrated &&
+         sameTopology(a.topology, b.topology) && a.powerBudgetMa == b.powerBudgetMa;
+}
 
 SettingsManager::SettingsManager() {
   // Initialize with defaults
-  settings.mode = DEFAULT_MODE;
-  settings.startColor[0] = DEFAULT_START_COLOR_R;
-  settings.startColor[1] = DEFAULT_START_COLOR_G;
-  settings.startColor[2] = DEFAULT_START_COLOR_B;
-  settings.endColor[0] = DEFAULT_END_COLOR_R;
-  settings.endColor[1] = DEFAULT_END_COLOR_G;
-  settings.endColor[2] = DEFAULT_END_COLOR_B;
-  settings.speedMs = DEFAULT_SPEED_MS;
-  settings.brightness = DEFAULT_BRIGHTNESS;
-  settings.numLeds = DEFAULT_NUM_LEDS;
-  settings.abThreshold = DEFAULT_AB_THRESHOLD;
-  settings.throttleMin = DEFAULT_THROTTLE_MIN;
-  settings.throttleMax = DEFAULT_THROTTLE_MAX;
-  settings.throttleCalibrated = DEFAULT_THROTTLE_CALIBRATED;
+  getDefaultSettings(settings);
   
   // Initialize flag
   initialized = false;
+  
+  publishMutex = nullptr;
+  publishSettings();
+  
+  // Initialize persistence state
+  dirty = false;
+  commitRequested = false;
+  lastChangeMs = 0;
+  pendingChanges = 0;
+  commitCount = 0;
+  nvsWriteCount = 0;
+  lastCommitUs = 0;
+  maxCommitUs = 0;
 }
 
 void SettingsManager::begin() {
+  publishMutex = xSemaphoreCreateMutex();
+  
   // Initialize preferences with namespace "afterburner"
   if (preferences.begin("afterburner", false)) {
-    // Check if we can access the preferences
-    if (preferences.getBytesLength("mode") > 0) {
-      Serial.println("Settings: Existing settings found in flash memory");
-    } else {
-      Serial.println("Settings: No existing settings found - will use defaults");
-    }
-    
-    loadSettings();
     initialized = true; // Mark as successfully initialized
+    loadSettings();
   } else {
-    Serial.println("Settings: Failed to initialize preferences!");
+    LOG_ERROR(SETTINGS, "Settings: Failed to initialize preferences!\n");
     initialized = false;
   }
 }
 
 void SettingsManager::loadSettings() {
+  // Runs from begin(), before the tasks that modify settings start.
+  // One NVS read for the whole record
+  AfterburnerSettings loaded;
+  uint8_t schemaVersion = 0;
+  SettingsRecordStatus status = SETTINGS_RECORD_BAD_LENGTH;
+  bool found = readStoredSettings(loaded, &status, &schemaVersion);
+  
+  if (found && status == SETTINGS_RECORD_OK) {
+    LOG_INFO(SETTINGS, "Settings: Loaded settings record (schema %u)\n", schemaVersion);
+    settings = loaded;
+    if (schemaVersion < SETTINGS_SCHEMA_VERSION) {
+      // Rewrite in the current schema; new fields start at their defaults
+      markDirty();
+    }
+  } else if (found) {
+    LOG_ERROR(SETTINGS, "Settings: ❌ Settings record rejected (%s) - using defaults\n",
+                  settingsRecordStatusName(status));
+    getDefaultSettings(settings);
+  } else if (hasLegacySettings()) {
+    migrateLegacySettings();
+  } else {
+    LOG_INFO(SETTINGS, "Settings: No existing settings found - will use defaults\n");
+    getDefaultSettings(settings);
+  }
+  
+  publishSettings();
+}
+
+bool SettingsManager::readStoredSettings(AfterburnerSettings& stored, SettingsRecordStatus* status,
+                                         uint8_t* schemaVersion) {
+  uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+  size_t length = preferences.getBytes(SETTINGS_RECORD_KEY, record, sizeof(record));
+  if (length == 0) {
+    getDefaultSettings(stored);
+    return false;
+  }
+  
+  SettingsRecordStatus result = decodeSettingsRecord(record, length, stored, schemaVersion);
+  if (status) {
+    *status = result;
+  }
+  return true;
+}
+
+bool SettingsManager::hasLegacySettings() {
+  return preferences.isKey("mode");
+}
+
+void SettingsManager::migrateLegacySettings() {
+  LOG_INFO(SETTINGS, "Settings: 🔄 Migrating per-key settings to a single record...\n");
+  
   settings.mode = preferences.getUChar("mode", DEFAULT_MODE);
   settings.startColor[0] = preferences.getUChar("startR", DEFAULT_START_COLOR_R);
   settings.startColor[1] = preferences.getUChar("startG", DEFAULT_START_COLOR_G);
@@ -55,151 +119,176 @@ void SettingsManager::loadSettings() {
   settings.throttleMin = preferences.getUShort("throttleMin", DEFAULT_THROTTLE_MIN);
   settings.throttleMax = preferences.getUShort("throttleMax", DEFAULT_THROTTLE_MAX);
   settings.throttleCalibrated = preferences.getBool("throttleCal", DEFAULT_THROTTLE_CALIBRATED);
-}
-
-void SettingsManager::saveSettings() {
-  // Save all settings with individual error checking
-  bool allSuccess = true;
-  int failedCount = 0;
-  
-  // Save each setting individually and track results
-  if (!preferences.putUChar("mode", settings.mode)) {
-    failedCount++;
-    allSuccess = false;
-  }
-  
-  if (!preferences.putUChar("startR", settings.startColor[0])) {
-    failedCount++;
-    allSuccess = false;
-  }
-  
-  if (!preferences.putUChar("startG", settings.startColor[1])) {
-    failedCount++;
-    allSuccess = false;
-  }
-  
-  if (!preferences.putUChar("startB", settings.startColor[2])) {
-    failedCount++;
-    allSuccess = false;
-  }
-  
-  if (!preferences.putUChar("endR", settings.endColor[0])) {
-    failedCount++;
-    allSuccess = false;
-  }
-  
-  if (!preferences.putUChar("endG", settings.endColor[1])) {
-    failedCount++;
-    allSuccess = false;
-  }
   
-  if (!preferences.putUChar("endB", settings.endColor[2])) {
-    failedCount++;
-    allSuccess = false;
+  // Only drop the old keys once the record is safely written
+  AfterburnerSettings written;
+  if (saveSettings() && readStoredSettings(written) && sameSettings(written, settings)) {
+    for (size_t i = 0; i < LEGACY_KEY_COUNT; i++) {
+      preferences.remove(LEGACY_KEYS[i]);
+    }
+    LOG_INFO(SETTINGS, "Settings: ✅ Migration complete - legacy keys removed\n");
+  } else {
+    LOG_ERROR(SETTINGS, "Settings: ⚠️ Migration write failed - keeping legacy keys\n");
   }
-  
-  if (!preferences.putUShort("speed", settings.speedMs)) {
-    failedCount++;
-    allSuccess = false;
+}
+
+bool SettingsManager::saveSettings() {
+  // Write a consistent copy; BLE callbacks may update settings meanwhile
+  AfterburnerSettings values = copySettings();
+  
+  // One NVS write for the whole record
+  uint8_t record[SETTINGS_RECORD_SIZE];
+  size_t length = encodeSettingsRecord(values, record);
+  bool success = preferences.putBytes(SETTINGS_RECORD_KEY, record, length) == length;
+  nvsWriteCount++;
+  
+  if (success) {
+    LOG_INFO(SETTINGS, "Settings: ✅ All settings saved successfully - mode=%d, startColor=[%d,%d,%d], endColor=[%d,%d,%d], speed=%d, brightness=%d, numLeds=%d, abThreshold=%d, throttleMin=%d, throttleMax=%d\n",
+                  values.mode,
+                  values.startColor[0], values.startColor[1], values.startColor[2],
+                  values.endColor[0], values.endColor[1], values.endColor[2],
+                  values.speedMs, values.brightness, values.numLeds, values.abThreshold,
+                  values.throttleMin, values.throttleMax);
+  } else {
+    LOG_ERROR(SETTINGS, "Settings: ⚠️ Failed to write settings record\n");
   }
-  
-  if (!preferences.putUChar("bright", settings.brightness)) {
-    Serial.println("Settings: ⚠️ Failed to save brightness");
-    failedCount++;
-    allSuccess = false;
+  return success;
+}
+
+const AfterburnerSettings& SettingsManager::getSettings() {
+  return settings;
+}
+
+const AfterburnerSettings& SettingsManager::acquireSettings(uint8_t reader) {
+  return publishedSettings.acquire(reader);
+}
+
+uint32_t SettingsManager::getSettingsVersion() {
+  return publishedSettings.getVersion();
+}
+
+uint32_t SettingsManager::getAcquiredVersion(uint8_t reader) {
+  return publishedSettings.getAcquiredVersion(reader);
+}
+
+void SettingsManager::lockSettings() {
+  // No mutex before begin(); nothing else runs yet
+  if (publishMutex) {
+    xSemaphoreTake(publishMutex, portMAX_DELAY);
   }
-  
-  if (!preferences.putUShort("numLeds", settings.numLeds)) {
-    Serial.println("Settings: ⚠️ Failed to save numLeds");
-    failedCount++;
-    allSuccess = false;
+}
+
+void SettingsManager::unlockSettings() {
+  if (publishMutex) {
+    xSemaphoreGive(publishMutex);
   }
-  
-  if (!preferences.putUChar("abThresh", settings.abThreshold)) {
-    Serial.println("Settings: ⚠️ Failed to save abThresh");
-    failedCount++;
-    allSuccess = false;
+}
+
+void SettingsManager::publishSettings() {
+  lockSettings();
+  publishedSettings.publish(settings);
+  unlockSettings();
+}
+
+AfterburnerSettings SettingsManager::copySettings() {
+  lockSettings();
+  AfterburnerSettings copy = settings;
+  unlockSettings();
+  return copy;
+}
+
+void SettingsManager::markDirty() {
+  pendingChanges++;
+  lastChangeMs = millis();
+  dirty = true;
+}
+
+void SettingsManager::requestCommit() {
+  commitRequested = true;
+}
+
+bool SettingsManager::processPendingCommit() {
+  if (commitRequested || (dirty && millis() - lastChangeMs >= SETTINGS_COMMIT_DELAY_MS)) {
+    commit();
+    return true;
   }
-  
-  if (!preferences.putUShort("throttleMin", settings.throttleMin)) {
-    Serial.println("Settings: ⚠️ Failed to save throttleMin");
-    failedCount++;
-    allSuccess = false;
+  return false;
+}
+
+void SettingsManager::commit() {
+  if (!initialized) {
+    LOG_WARN(SETTINGS, "Settings: ⚠️ Commit skipped - preferences not initialized\n");
+    return;
   }
   
-  if (!preferences.putUShort("throttleMax", settings.throttleMax)) {
-    Serial.println("Settings: ⚠️ Failed to save throttleMax");
-    failedCount++;
-    allSuccess = false;
-  }
+  // Clear first: a change that lands during the write marks dirty again
+  lockSettings();
+  dirty = false;
+  commitRequested = false;
+  uint32_t changes = pendingChanges;
+  pendingChanges = 0;
+  unlockSettings();
   
-  if (!preferences.putBool("throttleCal", settings.throttleCalibrated)) {
-    Serial.println("Settings: ⚠️ Failed to save throttleCal");
-    failedCount++;
-    allSuccess = false;
+  unsigned long start = micros();
+  saveSettings();
+  lastCommitUs = micros() - start;
+  if (lastCommitUs > maxCommitUs) {
+    maxCommitUs = lastCommitUs;
   }
+  commitCount++;
   
-  // Force write to flash memory - ESP32 Preferences automatically commits after each put operation
-  // Add a small delay to ensure the write completes
-  delay(10);
-  
-  if (allSuccess) {
-    Serial.printf("Settings: ✅ All settings saved successfully - mode=%d, startColor=[%d,%d,%d], endColor=[%d,%d,%d], speed=%d, brightness=%d, numLeds=%d, abThreshold=%d, throttleMin=%d, throttleMax=%d\n",
-                  settings.mode,
-                  settings.startColor[0], settings.startColor[1], settings.startColor[2],
-                  settings.endColor[0], settings.endColor[1], settings.endColor[2],
-                  settings.speedMs, settings.brightness, settings.numLeds, settings.abThreshold,
-                  settings.throttleMin, settings.throttleMax);
-  } else {
-    Serial.printf("Settings: ⚠️ %d settings failed to save, but some may have succeeded. Check individual results above.\n", failedCount);
-  }
+  LOG_INFO(SETTINGS, "Settings: 💾 Commit #%lu - %lu change(s) in %lu us (max %lu us, %lu NVS writes total)\n",
+                (unsigned long)commitCount, (unsigned long)changes, (unsigned long)lastCommitUs,
+                (unsigned long)maxCommitUs, (unsigned long)nvsWriteCount);
 }
 
-AfterburnerSettings& SettingsManager::getSettings() {
-  return settings;
+bool SettingsManager::isDirty() {
+  return dirty;
 }
 
-void SettingsManager::updateSettings(const AfterburnerSettings& newSettings) {
-  settings = newSettings;
-  saveSettings();
+uint32_t SettingsManager::getCommitCount() {
+  return commitCount;
+}
+
+uint32_t SettingsManager::getNvsWriteCount() {
+  return nvsWriteCount;
+}
+
+uint32_t SettingsManager::getLastCommitUs() {
+  return lastCommitUs;
+}
+
+uint32_t SettingsManager::getMaxCommitUs() {
+  return maxCommitUs;
 }
 
 void SettingsManager::verifySettings() {
-  Serial.println("Settings: Verifying saved settings...");
-  
-  // Read back from preferences to verify they were saved
-  uint8_t savedMode = preferences.getUChar("mode", 255);
-  uint8_t savedStartR = preferences.getUChar("startR", 255);
-  uint8_t savedStartG = preferences.getUChar("startG", 255);
-  uint8_t savedStartB = preferences.getUChar("startB", 255);
-  uint8_t savedEndR = preferences.getUChar("endR", 255);
-  uint8_t savedEndG = preferences.getUChar("endG", 255);
-  uint8_t savedEndB = preferences.getUChar("endB", 255);
-  uint16_t savedSpeed = preferences.getUShort("speed", 65535);
-  uint8_t savedBrightness = preferences.getUChar("bright", 255);
-  uint16_t savedNumLeds = preferences.getUShort("numLeds", 65535);
-  uint8_t savedAbThreshold = preferences.getUChar("abThresh", 255);
-  
-  Serial.printf("Settings: Verification - mode=%d, startColor=[%d,%d,%d], endColor=[%d,%d,%d], speed=%d, brightness=%d, numLeds=%d, abThreshold=%d\n",
-                savedMode,
-                savedStartR, savedStartG, savedStartB,
-                savedEndR, savedEndG, savedEndB,
-                savedSpeed, savedBrightness, savedNumLeds, savedAbThreshold);
+  LOG_DEBUG(SETTINGS, "Settings: Verifying saved settings...\n");
+  
+  // Read back the record to verify it was saved
+  AfterburnerSettings saved;
+  SettingsRecordStatus status = SETTINGS_RECORD_BAD_LENGTH;
+  if (!readStoredSettings(saved, &status) || status != SETTINGS_RECORD_OK) {
+    LOG_ERROR(SETTINGS, "Settings: ❌ Verification failed - record unreadable (%s)\n", settingsRecordStatusName(status));
+    return;
+  }
+  
+  LOG_DEBUG(SETTINGS, "Settings: Verification - mode=%d, startColor=[%d,%d,%d], endColor=[%d,%d,%d], speed=%d, brightness=%d, numLeds=%d, abThreshold=%d\n",
+                saved.mode,
+                saved.startColor[0], saved.startColor[1], saved.startColor[2],
+                saved.endColor[0], saved.endColor[1], saved.endColor[2],
+                saved.speedMs, saved.brightness, saved.numLeds, saved.abThreshold);
                 
   // Check if verification matches current settings
-  if (savedMode == settings.mode && 
-      savedStartR == settings.startColor[0] && savedStartG == settings.startColor[1] && savedStartB == settings.startColor[2] &&
-      savedEndR == settings.endColor[0] && savedEndG == settings.endColor[1] && savedEndB == settings.endColor[2] &&
-      savedSpeed == settings.speedMs && savedBrightness == settings.brightness && 
-      savedNumLeds == settings.numLeds && savedAbThreshold == settings.abThreshold) {
-    Serial.println("Settings: ✅ Verification successful - all settings match!");
+  if (sameSettings(saved, copySettings())) {
+    LOG_DEBUG(SETTINGS, "Settings: ✅ Verification successful - all settings match!\n");
   } else {
-    Serial.println("Settings: ❌ Verification failed - settings mismatch detected!");
+    LOG_ERROR(SETTINGS, "Settings: ❌ Verification failed - settings mismatch detected!\n");
   }
 }
 
 void SettingsManager::resetToDefaults() {
-  Serial.println("Settings: Resetting all settings to defaults...");
+  LOG_INFO(SETTINGS, "Settings: Resetting all settings to defaults...\n");
   
   // Clear all preferences
   preferences.clear();
@@ -207,90 +296,96 @@ void SettingsManager::resetToDefaults() {
   // Add a small delay to ensure the clear operation completes
   delay(10);
   
-  // Reset settings to defaults
-  settings.mode = DEFAULT_MODE;
-  settings.startColor[0] = DEFAULT_START_COLOR_R;
-  settings.startColor[1] = DEFAULT_START_COLOR_G;
-  settings.startColor[2] = DEFAULT_START_COLOR_B;
-  settings.endColor[0] = DEFAULT_END_COLOR_R;
-  settings.endColor[1] = DEFAULT_END_COLOR_G;
-  settings.endColor[2] = DEFAULT_END_COLOR_B;
-  settings.speedMs = DEFAULT_SPEED_MS;
-  settings.brightness = DEFAULT_BRIGHTNESS;
-  settings.numLeds = DEFAULT_NUM_LEDS;
-  settings.abThreshold = DEFAULT_AB_THRESHOLD;
+  // Reset settings to defaults; the throttle calibration and topology stay
+  modifySettings([](AfterburnerSettings& current) {
+    current.mode = DEFAULT_MODE;
+    current.startColor[0] = DEFAULT_START_COLOR_R;
+    current.startColor[1] = DEFAULT_START_COLOR_G;
+    current.startColor[2] = DEFAULT_START_COLOR_B;
+    current.endColor[0] = DEFAULT_END_COLOR_R;
+    current.endColor[1] = DEFAULT_END_COLOR_G;
+    current.endColor[2] = DEFAULT_END_COLOR_B;
+    current.speedMs = DEFAULT_SPEED_MS;
+    current.brightness = DEFAULT_BRIGHTNESS;
+    current.numLeds = DEFAULT_NUM_LEDS;
+    current.abThreshold = DEFAULT_AB_THRESHOLD;
+    current.powerBudgetMa = DEFAULT_POWER_BUDGET_MA;
+    return true;
+  });
   
   // Save the defaults
-  saveSettings();
+  commit();
   
-  Serial.println("Settings: Reset to defaults completed");
+  LOG_INFO(SETTINGS, "Settings: Reset to defaults completed\n");
 }
 
 void SettingsManager::checkFlashStatus() {
-  Serial.println("Settings: Checking flash memory status...");
+  LOG_DEBUG(SETTINGS, "Settings: Checking flash memory status...\n");
   
   // Since preferences are already initialized in read-write mode, we can use them directly
-  if (preferences.getBytesLength("mode") > 0) {
-    Serial.println("Settings: ✅ Settings found in flash memory");
+  if (hasSavedSettings()) {
+    LOG_DEBUG(SETTINGS, "Settings: ✅ Settings found in flash memory\n");
     
-    // Try to read a value to verify it's accessible
-    uint8_t testMode = preferences.getUChar("mode", 255);
-    if (testMode != 255) {
-      Serial.printf("Settings: ✅ Mode value readable: %d\n", testMode);
+    // Try to read the record to verify it's accessible
+    AfterburnerSettings stored;
+    SettingsRecordStatus status = SETTINGS_RECORD_BAD_LENGTH;
+    if (readStoredSettings(stored, &status) && status == SETTINGS_RECORD_OK) {
+      LOG_DEBUG(SETTINGS, "Settings: ✅ Settings record readable - mode: %d\n", stored.mode);
     } else {
-      Serial.println("Settings: ⚠️ Mode value not readable");
+      LOG_WARN(SETTINGS, "Settings: ⚠️ Settings record not readable (%s)\n", settingsRecordStatusName(status));
     }
     
     // Check flash memory usage
     size_t freeEntries = preferences.freeEntries();
-    Serial.printf("Settings: Flash memory - Free entries: %d\n", freeEntries);
+    LOG_DEBUG(SETTINGS, "Settings: Flash memory - Free entries: %u\n", (unsigned)freeEntries);
     
     if (freeEntries < 10) {
-      Serial.println("Settings: ⚠️ Low flash memory - consider clearing some preferences");
+      LOG_WARN(SETTINGS, "Settings: ⚠️ Low flash memory - consider clearing some preferences\n");
     }
     
     // Check if we can write a test value
-    Serial.println("Settings: Testing flash write capability...");
+    LOG_DEBUG(SETTINGS, "Settings: Testing flash write capability...\n");
     if (preferences.putUChar("test_write", 123)) {
-      Serial.println("Settings: ✅ Flash write test successful");
+      LOG_DEBUG(SETTINGS, "Settings: ✅ Flash write test successful\n");
       // Clean up test value
       preferences.remove("test_write");
     } else {
-      Serial.println("Settings: ❌ Flash write test failed - this indicates a serious problem");
+      LOG_ERROR(SETTINGS, "Settings: ❌ Flash write test failed - this indicates a serious problem\n");
     }
     
   } else {
-    Serial.println("Settings: ⚠️ No settings found in flash memory");
+    LOG_WARN(SETTINGS, "Settings: ⚠️ No settings found in flash memory\n");
   }
   
   // Check if preferences namespace is accessible
   if (preferences.begin("afterburner", true)) { // Try read-only mode
-    Serial.println("Settings: ✅ Preferences namespace accessible in read mode");
+    LOG_DEBUG(SETTINGS, "Settings: ✅ Preferences namespace accessible in read mode\n");
     preferences.end();
   } else {
-    Serial.println("Settings: ❌ Preferences namespace not accessible in read mode");
+    LOG_ERROR(SETTINGS, "Settings: ❌ Preferences namespace not accessible in read mode\n");
   }
   
   // Reopen in read-write mode
   if (preferences.begin("afterburner", false)) {
-    Serial.println("Settings: ✅ Preferences namespace accessible in read-write mode");
+    LOG_DEBUG(SETTINGS, "Settings: ✅ Preferences namespace accessible in read-write mode\n");
   } else {
-    Serial.println("Settings: ❌ Preferences namespace not accessible in read-write mode");
+    LOG_ERROR(SETTINGS, "Settings: ❌ Preferences namespace not accessible in read-write mode\n");
   }
 }
 
 void SettingsManager::printPreferencesInfo() {
-  Serial.println("Settings: Preferences information...");
+  LOG_DEBUG(SETTINGS, "Settings: Preferences information...\n");
   
   // Since preferences are already initialized in read-write mode, we can use them directly
-  Serial.println("Settings: ✅ Preferences namespace accessible");
+  LOG_DEBUG(SETTINGS, "Settings: ✅ Preferences namespace accessible\n");
   
-  // Try to read a value to verify it's accessible
-  uint8_t testMode = preferences.getUChar("mode", 255);
-  if (testMode != 255) {
-    Serial.printf("Settings: ✅ Mode value readable: %d\n", testMode);
+  // Try to read the record to verify it's accessible
+  AfterburnerSettings stored;
+  SettingsRecordStatus status = SETTINGS_RECORD_BAD_LENGTH;
+  if (readStoredSettings(stored, &status) && status == SETTINGS_RECORD_OK) {
+    LOG_DEBUG(SETTINGS, "Settings: ✅ Settings record readable - mode: %d\n", stored.mode);
   } else {
-    Serial.println("Settings: ⚠️ Mode value not readable");
+    LOG_WARN(SETTINGS, "Settings: ⚠️ Settings record not readable\n");
   }
 }
 
@@ -305,66 +400,70 @@ bool SettingsManager::hasSavedSettings() {
     return false;
   }
   
-  // Check if the mode key exists and has a value
-  size_t keyLength = preferences.getBytesLength("mode");
-  return keyLength > 0;
+  // Check if the settings record exists
+  return preferences.isKey(SETTINGS_RECORD_KEY);
 }
 
 // Throttle calibration methods
 void SettingsManager::startThrottleCalibration() {
-  Serial.println("Settings: 🎯 Starting throttle calibration...");
+  LOG_INFO(SETTINGS, "Settings: 🎯 Starting throttle calibration...\n");
   // This method is called when calibration starts
   // The actual calibration is handled by the ThrottleReader class
 }
 
 void SettingsManager::updateThrottleCalibration(uint16_t minValue, uint16_t maxValue) {
-  Serial.printf("Settings: 🎯 Updating throttle calibration - Min: %u, Max: %u\n", minValue, maxValue);
+  LOG_INFO(SETTINGS, "Settings: 🎯 Updating throttle calibration - Min: %u, Max: %u\n", minValue, maxValue);
   
   // Validate calibration values
   if (minValue >= maxValue || minValue < MIN_PWM_VALUE || maxValue > MAX_PWM_VALUE) {
-    Serial.println("Settings: ❌ Invalid calibration values!");
+    LOG_ERROR(SETTINGS, "Settings: ❌ Invalid calibration values!\n");
     return;
   }
   
-  // Update settings
-  settings.throttleMin = minValue;
-  settings.throttleMax = maxValue;
-  settings.throttleCalibrated = true;
+  // Only the throttle fields; a BLE write landing meanwhile keeps its own
+  modifySettings([minValue, maxValue](AfterburnerSettings& current) {
+    current.throttleMin = minValue;
+    current.throttleMax = maxValue;
+    current.throttleCalibrated = true;
+    return true;
+  });
   
-  // Save to flash memory
-  saveSettings();
+  // Save to flash memory right away (calibration is rare and verified below)
+  commit();
   
   // Verify the throttle calibration values were saved correctly
-  uint16_t savedMin = preferences.getUShort("throttleMin", 0);
-  uint16_t savedMax = preferences.getUShort("throttleMax", 0);
-  bool savedCalibrated = preferences.getBool("throttleCal", false);
+  AfterburnerSettings saved;
+  readStoredSettings(saved);
+  uint16_t savedMin = saved.throttleMin;
+  uint16_t savedMax = saved.throttleMax;
+  bool savedCalibrated = saved.throttleCalibrated;
   
   if (savedMin == minValue && savedMax == maxValue && savedCalibrated) {
-    Serial.printf("Settings: ✅ Throttle calibration verified in flash - Min: %u, Max: %u\n", 
+    LOG_INFO(SETTINGS, "Settings: ✅ Throttle calibration verified in flash - Min: %u, Max: %u\n", 
                   savedMin, savedMax);
   } else {
-    Serial.printf("Settings: ⚠️ Throttle calibration verification failed! Expected: Min=%u, Max=%u, Got: Min=%u, Max=%u, Calibrated=%s\n",
+    LOG_ERROR(SETTINGS, "Settings: ⚠️ Throttle calibration verification failed! Expected: Min=%u, Max=%u, Got: Min=%u, Max=%u, Calibrated=%s\n",
                   minValue, maxValue, savedMin, savedMax, savedCalibrated ? "true" : "false");
     
     // If verification failed, check flash status for debugging
-    Serial.println("Settings: 🔍 Checking flash status after verification failure...");
+    LOG_INFO(SETTINGS, "Settings: 🔍 Checking flash status after verification failure...\n");
     checkFlashStatus();
   }
 }
 
 void SettingsManager::resetThrottleCalibration() {
-  Serial.println("Settings: 🎯 Resetting throttle calibration to defaults...");
-  
-  // Reset to default values
-  settings.throttleMin = DEFAULT_THROTTLE_MIN;
-  settings.throttleMax = DEFAULT_THROTTLE_MAX;
-  settings.throttleCalibrated = DEFAULT_THROTTLE_CALIBRATED;
-  
-  // Save to flash memory
-  saveSettings();
-  
-  Serial.printf("Settings: ✅ Throttle calibration reset - Min: %u, Max: %u\n", 
-                settings.throttleMin, settings.throttleMax);
+  LOG_INFO(SETTINGS, "Settings: 🎯 Resetting throttle calibration to defaults...\n");
+  
+  // Reset to default values; saved with the next commit (called from a BLE callback)
+  modifySettings([](AfterburnerSettings& current) {
+    current.throttleMin = DEFAULT_THROTTLE_MIN;
+    current.throttleMax = DEFAULT_THROTTLE_MAX;
+    current.throttleCalibrated = DEFAULT_THROTTLE_CALIBRATED;
+    return true;
+  });
+  
+  LOG_INFO(SETTINGS, "Settings: ✅ Throttle calibration reset - Min: %u, Max: %u\n", 
+                DEFAULT_THROTTLE_MIN, DEFAULT_THROTTLE_MAX);
 }
 
 bool SettingsManager::isThrottleCalibrating() {
@@ -373,40 +472,44 @@ bool SettingsManager::isThrottleCalibrating() {
   return false;
 }
 
+// The system task calls these while BLE writes may be modifying settings
 bool SettingsManager::isThrottleCalibrated() {
-  return settings.throttleCalibrated;
+  return copySettings().throttleCalibrated;
 }
 
 uint16_t SettingsManager::getThrottleMin() {
-  return settings.throttleMin;
+  return copySettings().throttleMin;
 }
 
 uint16_t SettingsManager::getThrottleMax() {
-  return settings.throttleMax;
+  return copySettings().throttleMax;
 }
 
 // Debug method to check throttle calibration values in flash
 void SettingsManager::debugThrottleCalibration() {
-  Serial.println("Settings: 🔍 Debugging throttle calibration values...");
+  LOG_DEBUG(SETTINGS, "Settings: 🔍 Debugging throttle calibration values...\n");
+  AfterburnerSettings current = copySettings();
   
   // Check in-memory values
-  Serial.printf("Settings: In-memory - Min: %u, Max: %u, Calibrated: %s\n",
-                settings.throttleMin, settings.throttleMax, 
-                settings.throttleCalibrated ? "true" : "false");
-  
-  // Check flash memory values
-  uint16_t flashMin = preferences.getUShort("throttleMin", 0);
-  uint16_t flashMax = preferences.getUShort("throttleMax", 0);
-  bool flashCalibrated = preferences.getBool("throttleCal", false);
-  
-  Serial.printf("Settings: Flash memory - Min: %u, Max: %u, Calibrated: %s\n",
+  LOG_DEBUG(SETTINGS, "Settings: In-memory - Min: %u, Max: %u, Calibrated: %s\n",
+                current.throttleMin, current.throttleMax, 
+                current.throttleCalibrated ? "true" : "false");
+  
+  // Check flash memory values (defaults if the record is missing or invalid)
+  AfterburnerSettings stored;
+  readStoredSettings(stored);
+  uint16_t flashMin = stored.throttleMin;
+  uint16_t flashMax = stored.throttleMax;
+  bool flashCalibrated = stored.throttleCalibrated;
+  
+  LOG_DEBUG(SETTINGS, "Settings: Flash memory - Min: %u, Max: %u, Calibrated: %s\n",
                 flashMin, flashMax, flashCalibrated ? "true" : "false");
   
   // Check if values match
-  if (settings.throttleMin == flashMin && settings.throttleMax == flashMax && 
-      settings.throttleCalibrated == flashCalibrated) {
-    Serial.println("Settings: ✅ In-memory and flash values match");
+  if (current.throttleMin == flashMin && current.throttleMax == flashMax && 
+      current.throttleCalibrated == flashCalibrated) {
+    LOG_DEBUG(SETTINGS, "Settings: ✅ In-memory and flash values match\n");
   } else {
-    Serial.println("Settings: ❌ In-memory and flash values do not match");
+    LOG_ERROR(SETTINGS, "Settings: ❌ In-memory and flash values do not match\n");
   }
 }
@@ -4,6 +4,10 @@
 #include <Arduino.h>
 #include <Preferences.h>
 #include <Arduino.h>
+#include "snapshot.h"
+#include "ring_topology.h"
+
+enum SettingsRecordStatus : uint8_t;
 
 // Afterburner settings structure
 struct AfterburnerSettings {
@@ -12,13 +16,20 @@ struct AfterburnerSettings {
   uint8_t endColor[3];    // RGB end color
   uint16_t speedMs;       // Animation speed in milliseconds
   uint8_t brightness;     // Brightness cap (10-255)
-  uint16_t numLeds;       // Number of LEDs
+  uint16_t numLeds;       // LEDs per ring (legacy two-ring layout)
   uint8_t abThreshold;    // Afterburner threshold (0-100%)
   uint16_t throttleMin;   // Calibrated min throttle PWM value
   uint16_t throttleMax;   // Calibrated max throttle PWM value
   bool throttleCalibrated; // Whether throttle has been calibrated
+  RingTopology topology;  // Ring segments; empty = two rings of numLeds (applied at start-up)
+  uint16_t powerBudgetMa; // Estimated LED current limit, 0 = no limit (power_limiter.h)
 };
 
+// Tasks that read the published settings (one held slot each)
+#define SETTINGS_READER_RENDER 0
+#define SETTINGS_READER_SYSTEM 1
+#define SETTINGS_READERS 2
+
 // Default settings
 #define DEFAULT_MODE 1
 #define DEFAULT_START_COLOR_R 255
@@ -34,20 +45,90 @@ struct AfterburnerSettings {
 #define DEFAULT_THROTTLE_MIN 900
 #define DEFAULT_THROTTLE_MAX 2000
 #define DEFAULT_THROTTLE_CALIBRATED false
+#define DEFAULT_POWER_BUDGET_MA 2500        // Leaves headroom on a 3 A BEC
+
+// Valid ranges; BLE writes outside them are rejected (valid modes come from effects.h)
+#define MIN_SPEED_MS 100
+#define MAX_SPEED_MS 5000
+#define MIN_BRIGHTNESS 10
+#define MIN_NUM_LEDS 1
+#define MAX_NUM_LEDS 300
+#define MAX_AB_THRESHOLD 100
+#define MAX_POWER_BUDGET_MA 20000
+
+// NVS key of the settings record (see settings_record.h)
+#define SETTINGS_RECORD_KEY "settings"
+
+// Deferred persistence
+#define SETTINGS_COMMIT_DELAY_MS 2000  // Quiet period before pending changes are written to NVS
 
 class SettingsManager {
 private:
   Preferences preferences;
   AfterburnerSettings settings;
   bool initialized;
+  
+  // Versions of settings published to the other tasks after every change;
+  // settings above is the writers' working copy
+  VersionedBuffer<AfterburnerSettings, SETTINGS_READERS> publishedSettings;
+  SemaphoreHandle_t publishMutex;  // BLE callbacks and the system task both write
+  void lockSettings();
+  void unlockSettings();
+  void publishSettings();
+  
+  // Deferred persistence: changes apply in memory at once and are written to
+  // NVS in one batch after SETTINGS_COMMIT_DELAY_MS without further changes
+  volatile bool dirty;
+  volatile bool commitRequested;
+  volatile unsigned long lastChangeMs;
+  uint32_t pendingChanges;  // Updates coalesced into the next commit
+  uint32_t commitCount;
+  uint32_t nvsWriteCount;   // Individual NVS put operations
+  uint32_t lastCommitUs;
+  uint32_t maxCommitUs;
+  void markDirty();  // Called with publishMutex held (or before the tasks start)
+  
+  // Settings record storage
+  bool readStoredSettings(AfterburnerSettings& stored, SettingsRecordStatus* status = nullptr,
+                          uint8_t* schemaVersion = nullptr);
+  bool hasLegacySettings();
+  void migrateLegacySettings();
 
 public:
   SettingsManager();
   void begin();
   void loadSettings();
-  void saveSettings();
-  AfterburnerSettings& getSettings();
-  void updateSettings(const AfterburnerSettings& newSettings);
+  bool saveSettings();
+  // Writers' working copy; change settings with modifySettings(). Only for
+  // setup(): once the tasks run, read through copySettings() or acquireSettings()
+  const AfterburnerSettings& getSettings();
+  AfterburnerSettings copySettings();  // Consistent copy, taken under publishMutex
+  
+  // Latest published settings for a reader task, without locks or copying.
+  // The reference stays valid until the same reader acquires again.
+  const AfterburnerSettings& acquireSettings(uint8_t reader);
+  uint32_t getSettingsVersion();
+  uint32_t getAcquiredVersion(uint8_t reader);  // Version of the reader's last acquireSettings()
+  
+  // The only way to change settings once the tasks run. change(settings)
+  // edits a copy of the current settings and returns true to keep it; the
+  // read, change, publish and dirty mark all happen under publishMutex, so a
+  // BLE write and the system task cannot overwrite each other's fields.
+  // Applied and published immediately, persisted by the next commit. result
+  // receives the settings as they stand afterwards, changed or not.
+  template <typename Change>
+  bool modifySettings(Change change, AfterburnerSettings* result = nullptr);
+  
+  // Commit scheduling (the system task calls processPendingCommit())
+  void requestCommit();          // Commit on the next pass instead of after the quiet period
+  bool processPendingCommit();   // Returns true if a commit was written
+  void commit();                 // Writes settings to NVS now
+  bool isDirty();
+  uint32_t getCommitCount();
+  uint32_t getNvsWriteCount();
+  uint32_t getLastCommitUs();
+  uint32_t getMaxCommitUs();
+  
   void verifySettings();
   void resetToDefaults();
   void checkFlashStatus();
@@ -68,4 +149,21 @@ public:
   void debugThrottleCalibration();
 };
 
+template <typename Change>
+bool SettingsManager::modifySettings(Change change, AfterburnerSettings* result) {
+  lockSettings();
+  AfterburnerSettings changed = settings;
+  bool applied = change(changed);
+  if (applied) {
+    settings = changed;
+    publishedSettings.publish(settings);
+    markDirty();
+  }
+  if (result) {
+    *result = settings;
+  }
+  unlockSettings();
+  return applied;
+}
+
 #endif // SETTINGS_H
@@ -0,0 +1,94 @@
+#include "settings_fields.h"
+#include "effects.h"
+
+bool isValidModeValue(uint16_t value) {
+  return isValidEffect(value);
+}
+
+static uint8_t* fieldData(const SettingsField& field, AfterburnerSettings& settings) {
+  return (uint8_t*)&settings + field.offset;
+}
+
+static const uint8_t* fieldData(const SettingsField& field, const AfterburnerSettings& settings) {
+  return (const uint8_t*)&settings + field.offset;
+}
+
+static bool valueInRange(const SettingsField& field, uint16_t value) {
+  return value >= field.min && value <= field.max && (!field.validator || field.validator(value));
+}
+
+// data is field.width bytes in the characteristic layout
+static bool fieldInRange(const SettingsField& field, const uint8_t* data) {
+  if (field.width == 2) {
+    return valueInRange(field, (uint16_t)data[0] | ((uint16_t)data[1] << 8));
+  }
+  
+  // Single byte or RGB triple: every byte must be in range
+  for (uint8_t i = 0; i < field.width; i++) {
+    if (!valueInRange(field, data[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+WriteStatus applyFieldWrite(const SettingsField& field, const uint8_t* data, size_t length,
+                            AfterburnerSettings& settings) {
+  if (length != field.width) {
+    return WRITE_BAD_LENGTH;
+  }
+  if (!fieldInRange(field, data)) {
+    return WRITE_OUT_OF_RANGE;
+  }
+  
+  if (field.width == 2) {
+    uint16_t value = (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+    memcpy(fieldData(field, settings), &value, 2);
+  } else {
+    memcpy(fieldData(field, settings), data, field.width);
+  }
+  return WRITE_OK;
+}
+
+const SettingsField* findSettingsField(uint8_t offset) {
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    if (SETTINGS_FIELDS[i].offset == offset) {
+      return &SETTINGS_FIELDS[i];
+    }
+  }
+  return nullptr;
+}
+
+uint8_t resetInvalidFields(AfterburnerSettings& settings, const AfterburnerSettings& defaults) {
+  uint8_t reset = 0;
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    const SettingsField& field = SETTINGS_FIELDS[i];
+    uint8_t value[SETTINGS_FIELD_MAX_WIDTH];
+    encodeField(field, settings, value);
+    if (!fieldInRange(field, value)) {
+      memcpy(fieldData(field, settings), fieldData(field, defaults), field.width);
+      reset++;
+    }
+  }
+  return reset;
+}
+
+size_t encodeField(const SettingsField& field, const AfterburnerSettings& settings, uint8_t* data) {
+  if (field.width == 2) {
+    uint16_t value = getFieldValue(field, settings);
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+  } else {
+    memcpy(data, fieldData(field, settings), field.width);
+  }
+  return field.width;
+}
+
+uint16_t getFieldValue(const SettingsField& field, const AfterburnerSettings& settings) {
+  if (field.width == 2) {
+    uint16_t value;
+    memcpy(&value, fieldData(field, settings), 2);
+    return value;
+  }
+  return fieldData(field, settings)[0];
+}
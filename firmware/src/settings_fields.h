@@ -0,0 +1,74 @@
+#ifndef SETTINGS_FIELDS_H
+#define SETTINGS_FIELDS_H
+
+#include <Arduino.h>
+#include <stddef.h>
+#include "settings.h"
+#include "constants.h"
+#include "ble_write.h"
+
+// One GATT characteristic per setting, described by a row of SETTINGS_FIELDS.
+// The BLE service creates the characteristics, routes writes and refreshes
+// their values from this table, so a new setting is one row (plus its UUID).
+//
+// The characteristic value is the field itself: 1 byte, a little-endian
+// uint16 (width 2) or an RGB triple (width 3). min and max bound the value,
+// or each byte of a triple; the validator, if any, runs after that.
+
+// Characteristic properties, mapped to BLECharacteristic::PROPERTY_* by the service
+#define FIELD_PROP_READ 0x01
+#define FIELD_PROP_WRITE 0x02
+#define FIELD_PROP_NOTIFY 0x04
+
+typedef bool (*FieldValidator)(uint16_t value);
+
+struct SettingsField {
+  const char* uuid;
+  const char* name;          // For logs
+  uint8_t properties;        // FIELD_PROP_*
+  uint8_t offset;            // offsetof(AfterburnerSettings, field)
+  uint8_t width;             // 1, 2 or 3 bytes
+  uint16_t min;
+  uint16_t max;
+  FieldValidator validator;  // Extra check, or nullptr
+};
+
+bool isValidModeValue(uint16_t value);
+
+#define FIELD_RW (FIELD_PROP_READ | FIELD_PROP_WRITE)
+
+// Order is only used for logs and the characteristic creation order
+inline constexpr SettingsField SETTINGS_FIELDS[] = {
+  {MODE_UUID, "mode", FIELD_RW, offsetof(AfterburnerSettings, mode), 1, 0, 255, isValidModeValue},
+  {START_COLOR_UUID, "start color", FIELD_RW, offsetof(AfterburnerSettings, startColor), 3, 0, 255, nullptr},
+  {END_COLOR_UUID, "end color", FIELD_RW, offsetof(AfterburnerSettings, endColor), 3, 0, 255, nullptr},
+  {SPEED_MS_UUID, "speed ms", FIELD_RW, offsetof(AfterburnerSettings, speedMs), 2, MIN_SPEED_MS, MAX_SPEED_MS, nullptr},
+  {BRIGHTNESS_UUID, "brightness", FIELD_RW, offsetof(AfterburnerSettings, brightness), 1, MIN_BRIGHTNESS, 255, nullptr},
+  {NUM_LEDS_UUID, "LED count", FIELD_RW, offsetof(AfterburnerSettings, numLeds), 2, MIN_NUM_LEDS, MAX_NUM_LEDS, nullptr},
+  {AB_THRESHOLD_UUID, "AB threshold", FIELD_RW, offsetof(AfterburnerSettings, abThreshold), 1, 0, MAX_AB_THRESHOLD, nullptr},
+  {POWER_BUDGET_UUID, "power budget mA", FIELD_RW, offsetof(AfterburnerSettings, powerBudgetMa), 2, 0, MAX_POWER_BUDGET_MA, nullptr},
+};
+
+inline constexpr uint8_t SETTINGS_FIELD_COUNT = sizeof(SETTINGS_FIELDS) / sizeof(SETTINGS_FIELDS[0]);
+
+#define SETTINGS_FIELD_MAX_WIDTH 3
+
+// Checks the write and copies it into settings; settings is only written on WRITE_OK
+WriteStatus applyFieldWrite(const SettingsField& field, const uint8_t* data, size_t length,
+                            AfterburnerSettings& settings);
+
+// Row of the field at offsetof(AfterburnerSettings, field), or nullptr
+const SettingsField* findSettingsField(uint8_t offset);
+
+// Sets every field that applyFieldWrite() would reject to its value in
+// defaults, for settings that did not arrive over BLE (a stored record).
+// Returns how many fields were reset.
+uint8_t resetInvalidFields(AfterburnerSettings& settings, const AfterburnerSettings& defaults);
+
+// Writes the characteristic value (field.width bytes); returns the length
+size_t encodeField(const SettingsField& field, const AfterburnerSettings& settings, uint8_t* data);
+
+// Numeric value of a 1- or 2-byte field (the first byte of a triple)
+uint16_t getFieldValue(const SettingsField& field, const AfterburnerSettings& settings);
+
+#endif // SETTINGS_FIELDS_H
@@ -0,0 +1,121 @@
+#include "settings_packet.h"
+#include "settings_fields.h"
+
+static void putUint16(uint8_t* data, uint16_t value) {
+  data[0] = value & 0xFF;
+  data[1] = value >> 8;
+}
+
+static uint16_t getUint16(const uint8_t* data) {
+  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+// Where each mask bit's value sits in the payload and in AfterburnerSettings.
+// Each value has its characteristic's layout, so validating and copying it
+// goes through the SETTINGS_FIELDS row, the same as a single-field write.
+struct PacketField {
+  uint16_t mask;
+  uint8_t payloadOffset;
+  uint8_t settingsOffset;
+};
+
+static const PacketField PACKET_FIELDS[] = {
+  {SETTINGS_FIELD_MODE, 0, offsetof(AfterburnerSettings, mode)},
+  {SETTINGS_FIELD_START_COLOR, 1, offsetof(AfterburnerSettings, startColor)},
+  {SETTINGS_FIELD_END_COLOR, 4, offsetof(AfterburnerSettings, endColor)},
+  {SETTINGS_FIELD_SPEED, 7, offsetof(AfterburnerSettings, speedMs)},
+  {SETTINGS_FIELD_BRIGHTNESS, 9, offsetof(AfterburnerSettings, brightness)},
+  {SETTINGS_FIELD_NUM_LEDS, 10, offsetof(AfterburnerSettings, numLeds)},
+  {SETTINGS_FIELD_AB_THRESHOLD, 12, offsetof(AfterburnerSettings, abThreshold)},
+};
+
+#define PACKET_FIELD_COUNT (sizeof(PACKET_FIELDS) / sizeof(PACKET_FIELDS[0]))
+
+// Applies the selected fields to candidate; returns the first one its row
+// rejects, 0 if all were applied
+static uint16_t applyPacketFields(const uint8_t* payload, uint16_t mask, AfterburnerSettings& candidate) {
+  for (size_t i = 0; i < PACKET_FIELD_COUNT; i++) {
+    const PacketField& packetField = PACKET_FIELDS[i];
+    if (!(mask & packetField.mask)) {
+      continue;
+    }
+    const SettingsField* field = findSettingsField(packetField.settingsOffset);
+    if (!field || applyFieldWrite(*field, payload + packetField.payloadOffset, field->width, candidate) != WRITE_OK) {
+      return packetField.mask;
+    }
+  }
+  return 0;
+}
+
+SettingsPacketResult applySettingsPacket(const uint8_t* packet, size_t length, AfterburnerSettings& settings) {
+  SettingsPacketResult result = {SETTINGS_PACKET_OK, 0, 0, 0};
+  
+  if (length < SETTINGS_PACKET_HEADER_SIZE) {
+    result.status = SETTINGS_PACKET_BAD_LENGTH;
+    return result;
+  }
+  if (packet[0] < SETTINGS_PACKET_VERSION) {
+    result.status = SETTINGS_PACKET_BAD_VERSION;
+    return result;
+  }
+  result.flags = packet[1];
+  result.mask = getUint16(packet + 2);
+  
+  if (length < SETTINGS_PACKET_SIZE) {
+    result.status = SETTINGS_PACKET_BAD_LENGTH;
+    return result;
+  }
+  if (result.mask & ~SETTINGS_FIELD_ALL) {
+    result.status = SETTINGS_PACKET_BAD_MASK;
+    return result;
+  }
+  
+  // All fields go into a copy; settings only changes if every one is valid
+  const uint8_t* payload = packet + SETTINGS_PACKET_HEADER_SIZE;
+  AfterburnerSettings candidate = settings;
+  result.rejectedField = applyPacketFields(payload, result.mask, candidate);
+  if (result.rejectedField) {
+    result.status = SETTINGS_PACKET_BAD_VALUE;
+    return result;
+  }
+  settings = candidate;
+  return result;
+}
+
+size_t encodeSettingsPacket(const AfterburnerSettings& settings, uint16_t mask, uint8_t flags, uint8_t* packet) {
+  packet[0] = SETTINGS_PACKET_VERSION;
+  packet[1] = flags;
+  putUint16(packet + 2, mask);
+  
+  uint8_t* payload = packet + SETTINGS_PACKET_HEADER_SIZE;
+  payload[0] = settings.mode;
+  memcpy(payload + 1, settings.startColor, 3);
+  memcpy(payload + 4, settings.endColor, 3);
+  putUint16(payload + 7, settings.speedMs);
+  payload[9] = settings.brightness;
+  putUint16(payload + 10, settings.numLeds);
+  payload[12] = settings.abThreshold;
+  return SETTINGS_PACKET_SIZE;
+}
+
+size_t encodeSettingsPacketResult(const SettingsPacketResult& result, uint8_t* frame) {
+  frame[0] = result.status;
+  frame[1] = result.rejectedField & 0xFF;
+  return SETTINGS_PACKET_RESULT_SIZE;
+}
+
+const char* settingsPacketStatusName(SettingsPacketStatus status) {
+  switch (status) {
+    case SETTINGS_PACKET_OK:
+      return "ok";
+    case SETTINGS_PACKET_BAD_LENGTH:
+      return "bad length";
+    case SETTINGS_PACKET_BAD_VERSION:
+      return "bad version";
+    case SETTINGS_PACKET_BAD_MASK:
+      return "unknown fields";
+    case SETTINGS_PACKET_BAD_VALUE:
+      return "value out of range";
+  }
+  return "unknown";
+}
@@ -0,0 +1,62 @@
+#ifndef SETTINGS_PACKET_H
+#define SETTINGS_PACKET_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// Several settings in one write (APPLY_SETTINGS_UUID), little-endian:
+//
+//   version (1) | flags (1) | field mask (2) |
+//   mode (1) | start RGB (3) | end RGB (3) | speed ms (2) | brightness (1) | LEDs per ring (2) | AB threshold (1)
+//
+// Every field is always present; the mask selects the ones to apply. Fields
+// are only ever appended: longer packets from newer apps are accepted, but
+// mask bits this firmware does not know are rejected. Either every selected
+// field is valid and all of them apply together, or nothing changes.
+#define SETTINGS_PACKET_VERSION 1
+#define SETTINGS_PACKET_HEADER_SIZE 4
+#define SETTINGS_PACKET_SIZE 18          // Version 1
+#define SETTINGS_PACKET_RESULT_SIZE 2    // status (1) | rejected field mask, low byte (1)
+
+// Field mask
+#define SETTINGS_FIELD_MODE 0x0001
+#define SETTINGS_FIELD_START_COLOR 0x0002
+#define SETTINGS_FIELD_END_COLOR 0x0004
+#define SETTINGS_FIELD_SPEED 0x0008
+#define SETTINGS_FIELD_BRIGHTNESS 0x0010
+#define SETTINGS_FIELD_NUM_LEDS 0x0020
+#define SETTINGS_FIELD_AB_THRESHOLD 0x0040
+#define SETTINGS_FIELD_ALL 0x007F
+
+// Flags
+#define SETTINGS_PACKET_FLAG_SAVE 0x01   // Write to flash now instead of after the quiet period
+
+// Result of applying a packet, reported back on the characteristic
+enum SettingsPacketStatus : uint8_t {
+  SETTINGS_PACKET_OK,
+  SETTINGS_PACKET_BAD_LENGTH,
+  SETTINGS_PACKET_BAD_VERSION,
+  SETTINGS_PACKET_BAD_MASK,
+  SETTINGS_PACKET_BAD_VALUE
+};
+
+struct SettingsPacketResult {
+  SettingsPacketStatus status;
+  uint16_t mask;          // Fields selected by the packet
+  uint8_t flags;
+  uint16_t rejectedField; // SETTINGS_FIELD_* that failed validation, 0 otherwise
+};
+
+// Validates the whole packet, then copies the selected fields into settings.
+// settings is left untouched unless the status is SETTINGS_PACKET_OK.
+SettingsPacketResult applySettingsPacket(const uint8_t* packet, size_t length, AfterburnerSettings& settings);
+
+// Writes a packet selecting the given fields of settings; returns its length
+size_t encodeSettingsPacket(const AfterburnerSettings& settings, uint16_t mask, uint8_t flags, uint8_t* packet);
+
+// Writes a SETTINGS_PACKET_RESULT_SIZE-byte result; returns its length
+size_t encodeSettingsPacketResult(const SettingsPacketResult& result, uint8_t* frame);
+
+const char* settingsPacketStatusName(SettingsPacketStatus status);
+
+#endif // SETTINGS_PACKET_H
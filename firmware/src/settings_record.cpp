@@ -0,0 +1,184 @@
+#include "settings_record.h"
+#include "settings_fields.h"
+#include "constants.h"
+
+void getDefaultSettings(AfterburnerSettings& settings) {
+  memset(&settings, 0, sizeof(settings));  // Deterministic padding for comparisons
+  settings.mode = DEFAULT_MODE;
+  settings.startColor[0] = DEFAULT_START_COLOR_R;
+  settings.startColor[1] = DEFAULT_START_COLOR_G;
+  settings.startColor[2] = DEFAULT_START_COLOR_B;
+  settings.endColor[0] = DEFAULT_END_COLOR_R;
+  settings.endColor[1] = DEFAULT_END_COLOR_G;
+  settings.endColor[2] = DEFAULT_END_COLOR_B;
+  settings.speedMs = DEFAULT_SPEED_MS;
+  settings.brightness = DEFAULT_BRIGHTNESS;
+  settings.numLeds = DEFAULT_NUM_LEDS;
+  settings.abThreshold = DEFAULT_AB_THRESHOLD;
+  settings.throttleMin = DEFAULT_THROTTLE_MIN;
+  settings.throttleMax = DEFAULT_THROTTLE_MAX;
+  settings.throttleCalibrated = DEFAULT_THROTTLE_CALIBRATED;
+  settings.powerBudgetMa = DEFAULT_POWER_BUDGET_MA;
+}
+
+uint32_t settingsCrc32(const uint8_t* data, size_t length) {
+  // Nibble table: small, and a record is only checksummed at boot and on commit
+  static const uint32_t CRC_TABLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+  };
+  
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+    crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
+static void putUint16(uint8_t* data, uint16_t value) {
+  data[0] = value & 0xFF;
+  data[1] = value >> 8;
+}
+
+static uint16_t getUint16(const uint8_t* data) {
+  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+size_t encodeSettingsRecord(const AfterburnerSettings& settings, uint8_t* record) {
+  putUint16(record, SETTINGS_RECORD_MAGIC);
+  record[2] = SETTINGS_SCHEMA_VERSION;
+  record[3] = SETTINGS_PAYLOAD_SIZE;
+  
+  // Payload - append new fields at the end only
+  uint8_t* payload = record + SETTINGS_RECORD_HEADER_SIZE;
+  payload[0] = settings.mode;
+  payload[1] = settings.startColor[0];
+  payload[2] = settings.startColor[1];
+  payload[3] = settings.startColor[2];
+  payload[4] = settings.endColor[0];
+  payload[5] = settings.endColor[1];
+  payload[6] = settings.endColor[2];
+  putUint16(payload + 7, settings.speedMs);
+  payload[9] = settings.brightness;
+  putUint16(payload + 10, settings.numLeds);
+  payload[12] = settings.abThreshold;
+  putUint16(payload + 13, settings.throttleMin);
+  putUint16(payload + 15, settings.throttleMax);
+  payload[17] = settings.throttleCalibrated ? 1 : 0;
+  
+  // Schema 2: topology in its encoded form, zero-padded to the largest size
+  memset(payload + 18, 0, TOPOLOGY_MAX_SIZE);
+  encodeTopology(settings.topology, payload + 18);
+  
+  // Schema 3
+  putUint16(payload + 18 + TOPOLOGY_MAX_SIZE, settings.powerBudgetMa);
+  
+  size_t crcOffset = SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE;
+  uint32_t crc = settingsCrc32(record, crcOffset);
+  putUint16(record + crcOffset, crc & 0xFFFF);
+  putUint16(record + crcOffset + 2, crc >> 16);
+  return SETTINGS_RECORD_SIZE;
+}
+
+SettingsRecordStatus decodeSettingsRecord(const uint8_t* record, size_t length,
+                                          AfterburnerSettings& settings, uint8_t* schemaVersion) {
+  getDefaultSettings(settings);
+  if (schemaVersion) {
+    *schemaVersion = 0;
+  }
+  
+  if (length < SETTINGS_RECORD_HEADER_SIZE + SETTINGS_RECORD_CRC_SIZE) {
+    return SETTINGS_RECORD_BAD_LENGTH;
+  }
+  if (getUint16(record) != SETTINGS_RECORD_MAGIC) {
+    return SETTINGS_RECORD_BAD_MAGIC;
+  }
+  size_t payloadSize = record[3];
+  if (length != SETTINGS_RECORD_HEADER_SIZE + payloadSize + SETTINGS_RECORD_CRC_SIZE) {
+    return SETTINGS_RECORD_BAD_LENGTH;
+  }
+  
+  size_t crcOffset = SETTINGS_RECORD_HEADER_SIZE + payloadSize;
+  uint32_t storedCrc = (uint32_t)getUint16(record + crcOffset) | ((uint32_t)getUint16(record + crcOffset + 2) << 16);
+  if (settingsCrc32(record, crcOffset) != storedCrc) {
+    return SETTINGS_RECORD_BAD_CRC;
+  }
+  
+  // Fields missing from an older, shorter payload keep their defaults
+  AfterburnerSettings decoded;
+  getDefaultSettings(decoded);
+  const uint8_t* payload = record + SETTINGS_RECORD_HEADER_SIZE;
+  if (payloadSize >= 1) {
+    decoded.mode = payload[0];
+  }
+  if (payloadSize >= 7) {
+    decoded.startColor[0] = payload[1];
+    decoded.startColor[1] = payload[2];
+    decoded.startColor[2] = payload[3];
+    decoded.endColor[0] = payload[4];
+    decoded.endColor[1] = payload[5];
+    decoded.endColor[2] = payload[6];
+  }
+  if (payloadSize >= 9) {
+    decoded.speedMs = getUint16(payload + 7);
+  }
+  if (payloadSize >= 10) {
+    decoded.brightness = payload[9];
+  }
+  if (payloadSize >= 12) {
+    decoded.numLeds = getUint16(payload + 10);
+  }
+  if (payloadSize >= 13) {
+    decoded.abThreshold = payload[12];
+  }
+  if (payloadSize >= 18) {
+    decoded.throttleMin = getUint16(payload + 13);
+    decoded.throttleMax = getUint16(payload + 15);
+    decoded.throttleCalibrated = payload[17] != 0;
+  }
+  if (payloadSize >= 18 + TOPOLOGY_MAX_SIZE) {
+    // An unusable topology falls back to the legacy layout; the rest of the record still applies
+    size_t topologyLength = TOPOLOGY_HEADER_SIZE + (size_t)payload[19] * TOPOLOGY_SEGMENT_SIZE;
+    if (topologyLength <= TOPOLOGY_MAX_SIZE) {
+      decodeTopology(payload + 18, topologyLength, decoded.topology);
+    }
+  }
+  if (payloadSize >= 18 + TOPOLOGY_MAX_SIZE + 2) {
+    decoded.powerBudgetMa = getUint16(payload + 18 + TOPOLOGY_MAX_SIZE);
+  }
+  
+  // The CRC proves the record is intact, not that its writer used this
+  // firmware's ranges (a zero speedMs would divide by zero in the effects)
+  AfterburnerSettings defaults;
+  getDefaultSettings(defaults);
+  resetInvalidFields(decoded, defaults);
+  if (decoded.throttleMin >= decoded.throttleMax || decoded.throttleMin < MIN_PWM_VALUE ||
+      decoded.throttleMax > MAX_PWM_VALUE) {
+    // Same check as a new calibration (SettingsManager::updateThrottleCalibration())
+    decoded.throttleMin = defaults.throttleMin;
+    decoded.throttleMax = defaults.throttleMax;
+    decoded.throttleCalibrated = defaults.throttleCalibrated;
+  }
+  
+  settings = decoded;
+  if (schemaVersion) {
+    *schemaVersion = record[2];
+  }
+  return SETTINGS_RECORD_OK;
+}
+
+const char* settingsRecordStatusName(SettingsRecordStatus status) {
+  switch (status) {
+    case SETTINGS_RECORD_OK:
+      return "ok";
+    case SETTINGS_RECORD_BAD_LENGTH:
+      return "bad length";
+    case SETTINGS_RECORD_BAD_MAGIC:
+      return "bad magic";
+    case SETTINGS_RECORD_BAD_CRC:
+      return "CRC mismatch";
+  }
+  return "unknown";
+}
@@ -0,0 +1,47 @@
+#ifndef SETTINGS_RECORD_H
+#define SETTINGS_RECORD_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+// AfterburnerSettings as a single NVS blob:
+//
+//   magic (2) | schema version (1) | payload length (1) | payload | CRC32 (4)
+//
+// The payload is a fixed little-endian field layout, independent of struct
+// padding. Fields are only ever appended: a record written by an older schema
+// decodes with defaults for the fields it lacks, and a newer record decodes
+// the fields this firmware knows about. Decoded values outside the ranges a
+// BLE write accepts also fall back to their defaults.
+#define SETTINGS_RECORD_MAGIC 0x4241     // "AB"
+#define SETTINGS_SCHEMA_VERSION 3
+#define SETTINGS_RECORD_HEADER_SIZE 4
+#define SETTINGS_RECORD_CRC_SIZE 4
+#define SETTINGS_PAYLOAD_SIZE 50         // Schema 3: schema 1 (18) + ring topology (30) + power budget (2)
+#define SETTINGS_RECORD_SIZE (SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE + SETTINGS_RECORD_CRC_SIZE)
+#define SETTINGS_PAYLOAD_MAX_SIZE 255    // The length is one byte
+#define SETTINGS_RECORD_MAX_SIZE (SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_MAX_SIZE + SETTINGS_RECORD_CRC_SIZE)
+
+// Result of decoding a stored record
+enum SettingsRecordStatus : uint8_t {
+  SETTINGS_RECORD_OK,
+  SETTINGS_RECORD_BAD_LENGTH,
+  SETTINGS_RECORD_BAD_MAGIC,
+  SETTINGS_RECORD_BAD_CRC
+};
+
+void getDefaultSettings(AfterburnerSettings& settings);
+
+// Standard CRC-32 (IEEE 802.3, reflected, as used by zlib)
+uint32_t settingsCrc32(const uint8_t* data, size_t length);
+
+// Writes a SETTINGS_RECORD_SIZE-byte record; returns its length
+size_t encodeSettingsRecord(const AfterburnerSettings& settings, uint8_t* record);
+
+// On any status other than SETTINGS_RECORD_OK, settings is set to defaults
+SettingsRecordStatus decodeSettingsRecord(const uint8_t* record, size_t length,
+                                          AfterburnerSettings& settings, uint8_t* schemaVersion);
+
+const char* settingsRecordStatusName(SettingsRecordStatus status);
+
+#endif // SETTINGS_RECORD_H
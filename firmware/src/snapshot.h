@@ -0,0 +1,148 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+// Seqlock-protected value shared between FreeRTOS tasks.
+// One writer publishes complete copies; any number of readers take consistent
+// copies without locks. The sequence is odd while a write is in progress and
+// readers retry if it changed under them.
+// On a single core a reader that preempted the writer mid-publish can never
+// see the write finish, so reads are bounded: tryRead() gives up after
+// SNAPSHOT_READ_RETRIES attempts and the caller keeps its previous copy.
+// T must be trivially copyable.
+#define SNAPSHOT_READ_RETRIES 4
+
+template <typename T>
+class SeqlockSnapshot {
+private:
+  std::atomic<uint32_t> sequence;
+  T value;
+
+public:
+  SeqlockSnapshot() {
+    sequence.store(0);
+    memset(&value, 0, sizeof(value));
+  }
+
+  // Single writer only
+  void publish(const T& newValue) {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&value, &newValue, sizeof(T));
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  // Returns false (leaving out untouched) if no consistent copy was obtained
+  bool tryRead(T& out) const {
+    for (int attempt = 0; attempt < SNAPSHOT_READ_RETRIES; attempt++) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1) {
+        continue;
+      }
+      T copy;
+      memcpy(&copy, &value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        out = copy;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Number of completed publishes
+  uint32_t getVersion() const {
+    return sequence.load(std::memory_order_acquire) >> 1;
+  }
+};
+
+// Versioned publication of a value to a fixed set of readers.
+// Writers build a complete copy in a free slot and publish it with one atomic
+// index swap. Each reader acquires the latest slot by reference and keeps
+// using it, without copying or locking, until its next acquire().
+// Every reader may hold a slot, so READERS + 2 slots guarantee a writer always
+// finds one that is neither published nor held and never waits for a reader.
+// Writers must be serialized by the caller; readers are wait-free apart from
+// a retry when a publish races with their acquire.
+template <typename T, uint8_t READERS>
+class VersionedBuffer {
+private:
+  static const uint8_t SLOT_COUNT = READERS + 2;
+  static const uint8_t NO_SLOT = 0xFF;
+
+  T slots[SLOT_COUNT];
+  uint32_t slotVersions[SLOT_COUNT];
+  std::atomic<uint8_t> activeSlot;
+  std::atomic<uint8_t> heldSlots[READERS];
+  uint32_t version;  // Writer side only
+
+public:
+  VersionedBuffer() {
+    memset(slots, 0, sizeof(slots));
+    memset(slotVersions, 0, sizeof(slotVersions));
+    activeSlot.store(0);
+    for (uint8_t r = 0; r < READERS; r++) {
+      heldSlots[r].store(NO_SLOT);
+    }
+    version = 0;
+  }
+
+  // Writer: publishes a new version. Returns false (and publishes nothing) if
+  // the value is byte-identical to the current one, so unchanged saves and
+  // reloads do not bump the version.
+  bool publish(const T& newValue) {
+    uint8_t current = activeSlot.load(std::memory_order_seq_cst);
+    if (version > 0 && memcmp(&slots[current], &newValue, sizeof(T)) == 0) {
+      return false;
+    }
+    
+    uint8_t target = NO_SLOT;
+    for (uint8_t slot = 0; slot < SLOT_COUNT && target == NO_SLOT; slot++) {
+      if (slot == current) {
+        continue;
+      }
+      bool held = false;
+      for (uint8_t r = 0; r < READERS; r++) {
+        if (heldSlots[r].load(std::memory_order_seq_cst) == slot) {
+          held = true;
+        }
+      }
+      if (!held) {
+        target = slot;
+      }
+    }
+    
+    memcpy(&slots[target], &newValue, sizeof(T));
+    slotVersions[target] = ++version;
+    activeSlot.store(target, std::memory_order_seq_cst);
+    return true;
+  }
+
+  // Reader: latest value, valid until this reader's next acquire()
+  const T& acquire(uint8_t reader) {
+    uint8_t slot;
+    do {
+      slot = activeSlot.load(std::memory_order_seq_cst);
+      heldSlots[reader].store(slot, std::memory_order_seq_cst);
+      // A publish between the load and the store may not have seen our claim
+    } while (activeSlot.load(std::memory_order_seq_cst) != slot);
+    return slots[slot];
+  }
+
+  // Version of the slot this reader holds (0 before the first publish)
+  uint32_t getAcquiredVersion(uint8_t reader) const {
+    uint8_t slot = heldSlots[reader].load(std::memory_order_acquire);
+    return slot == NO_SLOT ? 0 : slotVersions[slot];
+  }
+
+  // Latest published version (any task)
+  uint32_t getVersion() const {
+    return slotVersions[activeSlot.load(std::memory_order_acquire)];
+  }
+};
+
+#endif // SNAPSHOT_H
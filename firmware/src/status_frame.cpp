@@ -0,0 +1,28 @@
+#include "status_frame.h"
+
+uint16_t throttleToPermille(float throttle) {
+  if (isnan(throttle)) {
+    return STATUS_THROTTLE_INVALID;
+  }
+  if (throttle <= 0.0f) {
+    return 0;
+  }
+  if (throttle >= 1.0f) {
+    return 1000;
+  }
+  return (uint16_t)(throttle * 1000.0f + 0.5f);
+}
+
+size_t encodeStatusFrame(const StatusFrame& status, uint8_t* frame) {
+  frame[0] = STATUS_FRAME_VERSION;
+  frame[1] = STATUS_FRAME_SIZE;
+  frame[2] = status.sequence & 0xFF;
+  frame[3] = status.sequence >> 8;
+  frame[4] = status.throttlePermille & 0xFF;
+  frame[5] = status.throttlePermille >> 8;
+  frame[6] = status.mode;
+  frame[7] = status.flags;
+  frame[8] = status.ledCurrentMa & 0xFF;
+  frame[9] = status.ledCurrentMa >> 8;
+  return STATUS_FRAME_SIZE;
+}
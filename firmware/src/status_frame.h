@@ -0,0 +1,40 @@
+#ifndef STATUS_FRAME_H
+#define STATUS_FRAME_H
+
+#include <Arduino.h>
+
+// Binary status notification (STATUS_FRAME_UUID), little-endian:
+//
+//   version (1) | frame length (1) | sequence (2) | throttle per-mille (2) | mode (1) | flags (1) |
+//   LED current mA (2)
+//
+// The length byte is the size of the whole frame. Fields are only ever
+// appended, so a client reads the fields it knows and skips the rest.
+// The sequence number increments on every notification; gaps mean the client
+// missed frames.
+#define STATUS_FRAME_VERSION 1
+#define STATUS_FRAME_SIZE 10              // Version 1 with LED current (8 bytes before)
+#define STATUS_THROTTLE_INVALID 0xFFFF    // No valid throttle reading (NaN)
+
+// Status flags
+#define STATUS_FLAG_CALIBRATING 0x01        // Throttle calibration in progress
+#define STATUS_FLAG_CALIBRATED 0x02         // Throttle range has been calibrated
+#define STATUS_FLAG_AFTERBURNER 0x04        // Throttle above the afterburner threshold
+#define STATUS_FLAG_SETTINGS_DIRTY 0x08     // Settings changed but not yet written to flash
+#define STATUS_FLAG_POWER_LIMITED 0x10      // LEDs dimmed to stay within the power budget
+
+struct StatusFrame {
+  uint16_t sequence;
+  uint16_t throttlePermille;  // 0-1000, or STATUS_THROTTLE_INVALID
+  uint8_t mode;
+  uint8_t flags;
+  uint16_t ledCurrentMa;      // Estimated LED current after the power limit
+};
+
+// 0.0-1.0 -> 0-1000 (clamped); NaN -> STATUS_THROTTLE_INVALID
+uint16_t throttleToPermille(float throttle);
+
+// Writes a STATUS_FRAME_SIZE-byte frame; returns its length
+size_t encodeStatusFrame(const StatusFrame& status, uint8_t* frame);
+
+#endif // STATUS_FRAME_H
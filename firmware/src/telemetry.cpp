@@ -0,0 +1,93 @@
+#include "telemetry.h"
+
+#define TELEMETRY_BUFFER_MASK (TELEMETRY_BUFFER_SIZE - 1)
+#define ATT_NOTIFY_OVERHEAD 3  // Opcode + attribute handle
+
+TelemetryBuffer::TelemetryBuffer() : head(0), tail(0), enabled(false) {
+  nextSequence = 0;
+  droppedSamples = 0;
+}
+
+void TelemetryBuffer::setEnabled(bool enable) {
+  enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool TelemetryBuffer::isEnabled() const {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+bool TelemetryBuffer::push(const TelemetrySample& sample) {
+  uint16_t sequence = nextSequence++;
+  
+  uint8_t currentHead = head.load(std::memory_order_relaxed);
+  uint8_t nextHead = (currentHead + 1) & TELEMETRY_BUFFER_MASK;
+  if (nextHead == tail.load(std::memory_order_acquire)) {
+    // Full: drop the newest sample, the consumer owns the tail
+    droppedSamples++;
+    return false;
+  }
+  samples[currentHead] = sample;
+  sampleSequence[currentHead] = sequence;
+  head.store(nextHead, std::memory_order_release);
+  return true;
+}
+
+uint8_t TelemetryBuffer::available() const {
+  return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed)) & TELEMETRY_BUFFER_MASK;
+}
+
+void TelemetryBuffer::discard() {
+  tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+static void putUint16(uint8_t* data, uint16_t value) {
+  data[0] = value & 0xFF;
+  data[1] = value >> 8;
+}
+
+size_t TelemetryBuffer::encodeBatch(uint8_t* frame, uint8_t maxSamples) {
+  uint8_t currentTail = tail.load(std::memory_order_relaxed);
+  uint8_t currentHead = head.load(std::memory_order_acquire);
+  if (currentTail == currentHead || maxSamples == 0) {
+    return 0;
+  }
+  
+  uint16_t firstSequence = sampleSequence[currentTail];
+  uint8_t count = 0;
+  uint8_t* out = frame + TELEMETRY_HEADER_SIZE;
+  
+  // Stop at a dropped-sample gap so the header sequence covers the whole batch
+  while (currentTail != currentHead && count < maxSamples &&
+         sampleSequence[currentTail] == (uint16_t)(firstSequence + count)) {
+    const TelemetrySample& sample = samples[currentTail];
+    putUint16(out, sample.timeMs);
+    putUint16(out + 2, sample.pulseUs);
+    putUint16(out + 4, sample.throttlePermille);
+    putUint16(out + 6, sample.renderUs);
+    out += TELEMETRY_SAMPLE_SIZE;
+    count++;
+    currentTail = (currentTail + 1) & TELEMETRY_BUFFER_MASK;
+  }
+  tail.store(currentTail, std::memory_order_release);
+  
+  frame[0] = TELEMETRY_VERSION;
+  frame[1] = count;
+  putUint16(frame + 2, firstSequence);
+  return TELEMETRY_HEADER_SIZE + count * TELEMETRY_SAMPLE_SIZE;
+}
+
+uint32_t TelemetryBuffer::getDroppedSamples() const {
+  return droppedSamples;
+}
+
+uint8_t telemetrySamplesPerBatch(uint16_t mtu) {
+  int payload = (int)mtu - ATT_NOTIFY_OVERHEAD - TELEMETRY_HEADER_SIZE;
+  int count = payload / TELEMETRY_SAMPLE_SIZE;
+  if (count < 1) {
+    return 1;
+  }
+  if (count > TELEMETRY_MAX_BATCH) {
+    return TELEMETRY_MAX_BATCH;
+  }
+  return count;
+}
@@ -0,0 +1,71 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#define TELEMETRY_BUFFER_SIZE 64        // Samples queued for BLE (power of two), ~1 s at 60 FPS
+#define TELEMETRY_MAX_BATCH 20          // Samples per notification at most
+#define TELEMETRY_MAX_LATENCY_MS 250    // A partial batch is sent once this old
+
+// Telemetry batch notification (TELEMETRY_UUID), little-endian:
+//
+//   version (1) | sample count (1) | sequence of the first sample (2) | samples
+//
+// Each sample:
+//
+//   frame time ms, low 16 bits (2) | raw pulse us (2) | throttle per-mille (2) | render us (2)
+//
+// Samples in a batch are consecutive; a jump in sequence between batches is
+// the number of samples lost because the buffer was full.
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HEADER_SIZE 4
+#define TELEMETRY_SAMPLE_SIZE 8
+#define TELEMETRY_MAX_FRAME_SIZE (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_BATCH * TELEMETRY_SAMPLE_SIZE)
+
+struct TelemetrySample {
+  uint16_t timeMs;            // Frame timestamp (RenderScheduler), low 16 bits
+  uint16_t pulseUs;           // Raw throttle pulse, 0 when the signal is lost
+  uint16_t throttlePermille;  // Smoothed throttle (status_frame.h encoding)
+  uint16_t renderUs;          // Time spent in LEDEffects::renderFrame()
+};
+
+// Samples taken by the render task and sent in batches by the system task.
+// Single-producer (render) / single-consumer (system) lock-free ring buffer;
+// the newest sample is dropped when it is full.
+class TelemetryBuffer {
+private:
+  TelemetrySample samples[TELEMETRY_BUFFER_SIZE];
+  uint16_t sampleSequence[TELEMETRY_BUFFER_SIZE];
+  std::atomic<uint8_t> head;  // Written only by the producer
+  std::atomic<uint8_t> tail;  // Written only by the consumer
+  std::atomic<bool> enabled;
+  uint16_t nextSequence;      // Producer side, counts dropped samples too
+  volatile uint32_t droppedSamples;
+
+public:
+  TelemetryBuffer();
+
+  // Sampling is off until a client opts in
+  void setEnabled(bool enable);
+  bool isEnabled() const;
+
+  // Producer: returns false if the sample was dropped
+  bool push(const TelemetrySample& sample);
+
+  // Consumer
+  uint8_t available() const;
+  void discard();
+
+  // Pops up to maxSamples consecutive samples into a batch frame (at least
+  // TELEMETRY_HEADER_SIZE + maxSamples * TELEMETRY_SAMPLE_SIZE bytes).
+  // Returns the frame length, 0 if there was nothing to send.
+  size_t encodeBatch(uint8_t* frame, uint8_t maxSamples);
+
+  uint32_t getDroppedSamples() const;
+};
+
+// Samples that fit one notification at the given ATT MTU (1-TELEMETRY_MAX_BATCH)
+uint8_t telemetrySamplesPerBatch(uint16_t mtu);
+
+#endif // TELEMETRY_H
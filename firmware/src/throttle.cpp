@@ -1,9 +1,11 @@
 #include "throttle.h"
+#include "logging.h"
 
 ThrottleReader::ThrottleReader() {
   smoothedThrottle = 0.0f;
   alpha = 0.10f;  // Smoothing factor
   lastPulseTime = 0;
+  lastPulseUs = 0;
   demoMode = false;
   
   // Initialize calibration state
@@ -30,7 +32,12 @@ ThrottleReader::ThrottleReader() {
 }
 
 void ThrottleReader::begin() {
+#ifdef THROTTLE_PULSEIN_FALLBACK
   pinMode(THROTTLE_PIN, INPUT);
+  LOG_INFO(THROTTLE, "Throttle: using blocking pulseIn() capture\n");
+#else
+  PwmCapture::begin(THROTTLE_PIN);
+#endif
   
   // Note: Calibration values will be loaded from settings manager
   // after the settings manager is initialized
@@ -54,6 +61,10 @@ float ThrottleReader::getSmoothedThrottle() {
   return smoothedThrottle;
 }
 
+uint16_t ThrottleReader::getLastPulse() {
+  return lastPulseUs;
+}
+
 void ThrottleReader::setDemoMode(bool enabled) {
   demoMode = enabled;
   if (enabled) {
@@ -82,7 +93,13 @@ void ThrottleReader::updateDemoThrottle() {
 }
 
 float ThrottleReader::readPWM() {
+#ifdef THROTTLE_PULSEIN_FALLBACK
   unsigned long pulseWidth = pulseIn(THROTTLE_PIN, HIGH, PWM_TIMEOUT);
+#else
+  // Latest pulse from the capture interrupt, 0 if the signal is lost
+  unsigned long pulseWidth = PwmCapture::getLatestPulse();
+#endif
+  lastPulseUs = pulseWidth;
   
   if (pulseWidth == 0) {
     // No pulse detected, keep last value (failsafe)
@@ -121,8 +138,11 @@ float ThrottleReader::mapPWMToThrottle(unsigned long pulseWidth) {
 
 // Throttle calibration methods
 void ThrottleReader::startCalibration() {
-  Serial.println("🎯 Starting throttle calibration...");
+  LOG_INFO(THROTTLE, "🎯 Starting throttle calibration...\n");
   calibrating = true;
+#ifndef THROTTLE_PULSEIN_FALLBACK
+  PwmCapture::flush();  // Only pulses from now on count
+#endif
   sampleIndex = 0;
   calibrationStartTime = millis();
   
@@ -145,7 +165,7 @@ void ThrottleReader::startCalibration() {
   lastMinTime = 0;
   lastMaxTime = 0;
   
-  Serial.println("Calibration started - move throttle to min and max positions multiple times");
+  LOG_INFO(THROTTLE, "Calibration started - move throttle to min and max positions multiple times\n");
 }
 
 void ThrottleReader::stopCalibration() {
@@ -167,9 +187,19 @@ void ThrottleReader::updateCalibration() {
     return;
   }
   
+#ifdef THROTTLE_PULSEIN_FALLBACK
   // Read current PWM value
-  unsigned long pulseWidth = pulseIn(THROTTLE_PIN, HIGH, PWM_TIMEOUT);
-  
+  addCalibrationSample(pulseIn(THROTTLE_PIN, HIGH, PWM_TIMEOUT));
+#else
+  // Process every pulse captured since the last call
+  uint16_t pulseWidth;
+  while (calibrating && PwmCapture::popPulse(pulseWidth)) {
+    addCalibrationSample(pulseWidth);
+  }
+#endif
+}
+
+void ThrottleReader::addCalibrationSample(unsigned long pulseWidth) {
   if (pulseWidth > 0 && pulseWidth >= MIN_PWM_VALUE && pulseWidth <= MAX_PWM_VALUE) {
     // Add sample to array
     calibrationSamples[sampleIndex] = pulseWidth;
@@ -215,14 +245,14 @@ void ThrottleReader::updateCalibration() {
     // Check if calibration is complete
     if (minVisits >= MIN_VISITS_REQUIRED && maxVisits >= MAX_VISITS_REQUIRED && 
         (calibrationMax - calibrationMin) > 500) {
-      Serial.printf("Calibration complete! Min: %u μs, max: %u μs\n", calibrationMin, calibrationMax);
+      LOG_INFO(THROTTLE, "Calibration complete! Min: %u μs, max: %u μs\n", calibrationMin, calibrationMax);
       stopCalibration();
     }
     
     // Progress update every 5 seconds
     static unsigned long lastProgressUpdate = 0;
     if (currentTime - lastProgressUpdate > 5000) {
-      Serial.printf("🎯 Calibration progress - Min visits: %d/%d, Max visits: %d/%d, Range: %u μs\n",
+      LOG_DEBUG(THROTTLE, "🎯 Calibration progress - Min visits: %d/%d, Max visits: %d/%d, Range: %u μs\n",
                     minVisits, MIN_VISITS_REQUIRED, maxVisits, MAX_VISITS_REQUIRED,
                     calibrationMax - calibrationMin);
       lastProgressUpdate = currentTime;
@@ -251,11 +281,11 @@ uint8_t ThrottleReader::getMaxVisits() {
 }
 
 void ThrottleReader::updateCalibrationValues(uint16_t minPWM, uint16_t maxPWM) {
-  Serial.printf("Throttle: Updating calibration values - Min: %u, Max: %u\n", minPWM, maxPWM);
+  LOG_INFO(THROTTLE, "Throttle: Updating calibration values - Min: %u, Max: %u\n", minPWM, maxPWM);
   
   // Validate the new values
   if (minPWM >= maxPWM || minPWM < MIN_PWM_VALUE || maxPWM > MAX_PWM_VALUE) {
-    Serial.printf("Throttle: ❌ Invalid calibration values - Min: %u, Max: %u\n", minPWM, maxPWM);
+    LOG_ERROR(THROTTLE, "Throttle: ❌ Invalid calibration values - Min: %u, Max: %u\n", minPWM, maxPWM);
     return;
   }
   
@@ -263,34 +293,34 @@ void ThrottleReader::updateCalibrationValues(uint16_t minPWM, uint16_t maxPWM) {
   calibrationMin = minPWM;
   calibrationMax = maxPWM;
   
-  Serial.printf("Throttle: ✅ Calibration values updated successfully - Min: %u, Max: %u\n", 
+  LOG_INFO(THROTTLE, "Throttle: ✅ Calibration values updated successfully - Min: %u, Max: %u\n", 
                 calibrationMin, calibrationMax);
   
   // Debug: Verify the values were actually set
-  Serial.printf("Throttle: 🔍 Verification - Internal calibrationMin: %u, calibrationMax: %u\n", 
+  LOG_DEBUG(THROTTLE, "Throttle: 🔍 Verification - Internal calibrationMin: %u, calibrationMax: %u\n", 
                 this->calibrationMin, this->calibrationMax);
 }
 
 void ThrottleReader::resetCalibrationToDefaults() {
-  Serial.println("Throttle: 🔄 Resetting calibration to defaults...");
+  LOG_INFO(THROTTLE, "Throttle: 🔄 Resetting calibration to defaults...\n");
   
   // Reset to default values
   calibrationMin = DEFAULT_THROTTLE_MIN;
   calibrationMax = DEFAULT_THROTTLE_MAX;
   
-  Serial.printf("Throttle: ✅ Calibration reset to defaults - Min: %u, Max: %u\n", 
+  LOG_INFO(THROTTLE, "Throttle: ✅ Calibration reset to defaults - Min: %u, Max: %u\n", 
                 calibrationMin, calibrationMax);
 }
 
 void ThrottleReader::debugCalibrationState() {
-  Serial.printf("Throttle: 🔍 Debug - Calibrating: %s, Min: %u, Max: %u, Range: %u\n",
+  LOG_DEBUG(THROTTLE, "Throttle: 🔍 Debug - Calibrating: %s, Min: %u, Max: %u, Range: %u\n",
                 calibrating ? "true" : "false", calibrationMin, calibrationMax, 
                 (calibrationMax > calibrationMin) ? (calibrationMax - calibrationMin) : 0);
   
   if (calibrating) {
-    Serial.printf("Throttle: 🔍 Calibration progress - Min visits: %d/%d, Max visits: %d/%d\n",
+    LOG_DEBUG(THROTTLE, "Throttle: 🔍 Calibration progress - Min visits: %d/%d, Max visits: %d/%d\n",
                   minVisits, MIN_VISITS_REQUIRED, maxVisits, MAX_VISITS_REQUIRED);
-    Serial.printf("Throttle: 🔍 Last min: %u, Last max: %u\n", lastMinValue, lastMaxValue);
+    LOG_DEBUG(THROTTLE, "Throttle: 🔍 Last min: %u, Last max: %u\n", lastMinValue, lastMaxValue);
   }
   
   bool hasValidCalibration = (calibrationMin < calibrationMax) && 
@@ -298,5 +328,5 @@ void ThrottleReader::debugCalibrationState() {
                             (calibrationMin >= MIN_PWM_VALUE) && 
                             (calibrationMax <= MAX_PWM_VALUE);
   
-  Serial.printf("Throttle: 🔍 Valid calibration: %s\n", hasValidCalibration ? "true" : "false");
+  LOG_DEBUG(THROTTLE, "Throttle: 🔍 Valid calibration: %s\n", hasValidCalibration ? "true" : "false");
 }
@@ -3,12 +3,25 @@
 
 #include <Arduino.h>
 #include "constants.h"
+#include "pwm_capture.h"
+
+// Input state published by the input task for the render and system tasks
+struct ThrottleState {
+  float throttle;             // Smoothed throttle, 0.0-1.0
+  uint16_t pulseUs;           // Raw pulse behind this reading, 0 when the signal is lost
+  bool calibrating;
+  uint16_t calibrationMin;
+  uint16_t calibrationMax;
+  uint8_t minVisits;
+  uint8_t maxVisits;
+};
 
 class ThrottleReader {
 private:
   float smoothedThrottle;
   float alpha;  // Smoothing factor
   unsigned long lastPulseTime;
+  uint16_t lastPulseUs;  // Raw pulse width of the last reading
   bool demoMode;
 
 public:
@@ -16,6 +29,7 @@ public:
   void begin();
   float readThrottle();
   float getSmoothedThrottle();
+  uint16_t getLastPulse();  // Raw pulse width of the last readThrottle(), 0 if none
   void setDemoMode(bool enabled);
   void updateDemoThrottle();
   
@@ -44,6 +58,7 @@ public:
   private:
   float readPWM();
   float mapPWMToThrottle(unsigned long pulseWidth);
+  void addCalibrationSample(unsigned long pulseWidth);
   
   // Calibration state
   bool calibrating;
@@ -0,0 +1,42 @@
+// Tests for the BLE command parser and the heap counter around writes
+// (settings field writes are covered by test_settings_fields).
+//
+// Run with: pio test -e native -f test_ble_write
+
+#include <unity.h>
+#include "ble_write.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_commands_accept_only_their_values() {
+  const uint8_t values[] = {0, 1, 2};
+  CommandWrite write = {0xFF};
+  
+  // Save and calibrate: 1 only; telemetry: 0 or 1
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, parseCommandWrite(values, 1, 1, 1, write));
+  TEST_ASSERT_EQUAL(WRITE_OK, parseCommandWrite(values + 1, 1, 1, 1, write));
+  TEST_ASSERT_EQUAL(1, write.command);
+  TEST_ASSERT_EQUAL(WRITE_OK, parseCommandWrite(values, 1, 0, 1, write));
+  TEST_ASSERT_EQUAL(0, write.command);
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, parseCommandWrite(values + 2, 1, 0, 1, write));
+  TEST_ASSERT_EQUAL(WRITE_BAD_LENGTH, parseCommandWrite(values, 2, 0, 1, write));
+  TEST_ASSERT_EQUAL_STRING("bad length", writeStatusName(WRITE_BAD_LENGTH));
+}
+
+void test_heap_watermark_counts_changed_writes() {
+  HeapWatermark heap;
+  heap.recordWrite(50000, 50000);
+  heap.recordWrite(50000, 49936);  // 64 bytes kept
+  heap.recordWrite(49936, 50000);  // Freed again
+  TEST_ASSERT_EQUAL(3, heap.getWrites());
+  TEST_ASSERT_EQUAL(2, heap.getChangedWrites());
+  TEST_ASSERT_EQUAL(64, heap.getLargestChange());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_commands_accept_only_their_values);
+  RUN_TEST(test_heap_watermark_counts_changed_writes);
+  return UNITY_END();
+}
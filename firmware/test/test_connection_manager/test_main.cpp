@@ -0,0 +1,93 @@
+// Tests for the BLE connection-parameter policy and diagnostics frame.
+//
+// Run with: pio test -e native -f test_connection_manager
+
+#include <unity.h>
+#include "connection_manager.h"
+
+static uint16_t getUint16(const uint8_t* data) {
+  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_nothing_requested_while_disconnected() {
+  ConnectionManager connection;
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_NONE, connection.update(true, 1000));
+  TEST_ASSERT_EQUAL(BLE_DEFAULT_MTU, connection.getMtu());
+}
+
+void test_active_requested_on_connect_then_idle_after_quiet_period() {
+  ConnectionManager connection;
+  connection.onConnect(24, 0, 400, 1000);
+  
+  // A fresh connection counts as activity
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_ACTIVE, connection.update(false, 1000));
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_NONE, connection.update(false, 1020));
+  
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_NONE, connection.update(false, 1000 + CONN_IDLE_AFTER_MS - 1));
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_IDLE, connection.update(false, 1000 + CONN_IDLE_AFTER_MS));
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_IDLE, connection.getRequestedProfile());
+  
+  // Activity switches back at once
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_ACTIVE, connection.update(true, 1000 + CONN_IDLE_AFTER_MS + 5000));
+}
+
+void test_requests_are_spaced() {
+  ConnectionManager connection;
+  connection.onConnect(24, 0, 400, 0);
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_ACTIVE, connection.update(true, 0));
+  
+  // Idle is due, but the previous request was too recent
+  unsigned long idleAt = CONN_IDLE_AFTER_MS;
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_IDLE, connection.update(false, idleAt));
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_NONE, connection.update(true, idleAt + 10));
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_ACTIVE, connection.update(true, idleAt + CONN_REQUEST_SPACING_MS));
+}
+
+void test_reconnect_starts_over() {
+  ConnectionManager connection;
+  connection.onConnect(24, 0, 400, 0);
+  connection.update(true, 0);
+  connection.onMtuChanged(247);
+  TEST_ASSERT_EQUAL(247, connection.getMtu());
+  
+  connection.onDisconnect();
+  TEST_ASSERT_FALSE(connection.isConnected());
+  TEST_ASSERT_EQUAL(BLE_DEFAULT_MTU, connection.getMtu());
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_NONE, connection.getRequestedProfile());
+  
+  connection.onConnect(36, 0, 500, 100);
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_ACTIVE, connection.update(false, 110));
+}
+
+void test_diagnostics_frame() {
+  ConnectionManager connection;
+  uint32_t changes = connection.getChangeCount();
+  connection.onConnect(24, 0, 400, 0);
+  connection.update(true, 0);
+  connection.onMtuChanged(247);
+  connection.onParamsUpdated(12, 1, 500);
+  TEST_ASSERT_EQUAL(changes + 3, connection.getChangeCount());
+  TEST_ASSERT_EQUAL(15, connection.getIntervalMs());
+  
+  uint8_t frame[DIAGNOSTICS_SIZE];
+  TEST_ASSERT_EQUAL(DIAGNOSTICS_SIZE, connection.encodeDiagnostics(frame));
+  TEST_ASSERT_EQUAL(DIAGNOSTICS_VERSION, frame[0]);
+  TEST_ASSERT_EQUAL(CONNECTION_PROFILE_ACTIVE, frame[1]);
+  TEST_ASSERT_EQUAL(247, getUint16(frame + 2));
+  TEST_ASSERT_EQUAL(12, getUint16(frame + 4));
+  TEST_ASSERT_EQUAL(1, getUint16(frame + 6));
+  TEST_ASSERT_EQUAL(500, getUint16(frame + 8));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_nothing_requested_while_disconnected);
+  RUN_TEST(test_active_requested_on_connect_then_idle_after_quiet_period);
+  RUN_TEST(test_requests_are_spaced);
+  RUN_TEST(test_reconnect_starts_over);
+  RUN_TEST(test_diagnostics_frame);
+  return UNITY_END();
+}
@@ -0,0 +1,138 @@
+// Tests for the deferred-action table that replaces delay() in BLE callbacks.
+//
+// Run with: pio test -e native -f test_deferred_actions
+
+#include <unity.h>
+#include <thread>
+#include "deferred_actions.h"
+
+static DeferredActions* chainTarget = nullptr;
+static int runLog[16];
+static int runCount = 0;
+
+static void recordAction(void* context) {
+  runLog[runCount++] = (int)(intptr_t)context;
+}
+
+static void chainedAction(void* context) {
+  recordAction(context);
+  chainTarget->schedule(recordAction, (void*)99, 50);
+}
+
+static void countAction(void* context) {
+  (*(std::atomic<int>*)context)++;
+}
+
+void setUp() {
+  setNativeMillis(1000);
+  runCount = 0;
+}
+
+void tearDown() {}
+
+void test_actions_run_when_due() {
+  DeferredActions actions;
+  TEST_ASSERT_TRUE(actions.schedule(recordAction, (void*)1, 500));
+  TEST_ASSERT_TRUE(actions.schedule(recordAction, (void*)2, 100));
+  TEST_ASSERT_EQUAL(2, actions.getPendingCount());
+  
+  actions.run(1099);
+  TEST_ASSERT_EQUAL(0, runCount);
+  
+  actions.run(1100);
+  TEST_ASSERT_EQUAL(1, runCount);
+  TEST_ASSERT_EQUAL(2, runLog[0]);
+  
+  actions.run(1500);
+  TEST_ASSERT_EQUAL(2, runCount);
+  TEST_ASSERT_EQUAL(1, runLog[1]);
+  TEST_ASSERT_EQUAL(0, actions.getPendingCount());
+  
+  // Each action runs once
+  actions.run(5000);
+  TEST_ASSERT_EQUAL(2, runCount);
+}
+
+void test_action_can_schedule_follow_up() {
+  DeferredActions actions;
+  chainTarget = &actions;
+  actions.schedule(chainedAction, (void*)7, 100);
+  
+  setNativeMillis(1100);
+  actions.run(1100);
+  TEST_ASSERT_EQUAL(1, runCount);
+  TEST_ASSERT_EQUAL(1, actions.getPendingCount());
+  
+  actions.run(1149);
+  TEST_ASSERT_EQUAL(1, runCount);
+  actions.run(1150);
+  TEST_ASSERT_EQUAL(2, runCount);
+  TEST_ASSERT_EQUAL(99, runLog[1]);
+}
+
+void test_full_table_refuses_and_counts() {
+  DeferredActions actions;
+  for (int i = 0; i < DEFERRED_ACTION_SLOTS; i++) {
+    TEST_ASSERT_TRUE(actions.schedule(recordAction, (void*)(intptr_t)i, 10));
+  }
+  TEST_ASSERT_FALSE(actions.schedule(recordAction, (void*)100, 10));
+  TEST_ASSERT_EQUAL(1, actions.getDroppedActions());
+  
+  // Slots are reusable once run
+  actions.run(1010);
+  TEST_ASSERT_EQUAL(DEFERRED_ACTION_SLOTS, runCount);
+  TEST_ASSERT_TRUE(actions.schedule(recordAction, (void*)100, 10));
+}
+
+void test_due_time_survives_millis_wrap() {
+  setNativeMillis(0xFFFFFFF0UL);
+  DeferredActions actions;
+  actions.schedule(recordAction, (void*)3, 0x20);
+  
+  actions.run(0xFFFFFFFFUL);
+  TEST_ASSERT_EQUAL(0, runCount);
+  actions.run(0x10);
+  TEST_ASSERT_EQUAL(1, runCount);
+}
+
+void test_concurrent_schedulers() {
+  DeferredActions actions;
+  std::atomic<int> ran(0);
+  std::atomic<int> scheduled(0);
+  std::atomic<bool> done(false);
+  
+  // Two producers (like the BLE task and the system task) against one runner
+  auto producer = [&]() {
+    for (int i = 0; i < 20000; i++) {
+      if (actions.schedule(countAction, &ran, 0)) {
+        scheduled++;
+      }
+    }
+  };
+  std::thread first(producer);
+  std::thread second(producer);
+  std::thread runner([&]() {
+    while (!done.load()) {
+      actions.run(millis());
+    }
+  });
+  
+  first.join();
+  second.join();
+  done = true;
+  runner.join();
+  actions.run(millis());
+  
+  TEST_ASSERT_EQUAL(scheduled.load(), ran.load());
+  TEST_ASSERT_EQUAL(40000, scheduled.load() + (int)actions.getDroppedActions());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_actions_run_when_due);
+  RUN_TEST(test_action_can_schedule_follow_up);
+  RUN_TEST(test_full_table_refuses_and_counts);
+  RUN_TEST(test_due_time_survives_millis_wrap);
+  RUN_TEST(test_concurrent_schedulers);
+  return UNITY_END();
+}
@@ -0,0 +1,105 @@
+// Tests for the effect registry behind settings.mode.
+//
+// Run with: pio test -e native -f test_effect_registry
+//
+// Pixel output of the built-in effects is pinned by test_fixed_point_golden;
+// these check the table itself and the per-frame dispatch.
+
+#include <unity.h>
+#include <string.h>
+#include "led_effects.h"
+#include "settings_record.h"
+
+static AfterburnerSettings makeSettings(uint8_t mode) {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = mode;
+  return settings;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_modes_follow_the_table() {
+  TEST_ASSERT_EQUAL(3, EFFECT_COUNT);
+  TEST_ASSERT_EQUAL_STRING("Linear", EFFECTS[0].name);
+  TEST_ASSERT_EQUAL_STRING("Ease", EFFECTS[1].name);
+  TEST_ASSERT_EQUAL_STRING("Pulse", EFFECTS[2].name);
+  
+  for (uint8_t mode = 0; mode < EFFECT_COUNT; mode++) {
+    TEST_ASSERT_TRUE(isValidEffect(mode));
+    TEST_ASSERT_TRUE(&getEffect(mode) == &EFFECTS[mode]);
+    TEST_ASSERT_TRUE(EFFECTS[mode].prepareFrame != nullptr);
+    TEST_ASSERT_TRUE(EFFECTS[mode].renderRing != nullptr);
+  }
+  TEST_ASSERT_FALSE(isValidEffect(EFFECT_COUNT));
+  TEST_ASSERT_FALSE(isValidEffect(255));
+}
+
+void test_names_are_unique() {
+  for (uint8_t a = 0; a < EFFECT_COUNT; a++) {
+    for (uint8_t b = a + 1; b < EFFECT_COUNT; b++) {
+      TEST_ASSERT_TRUE(strcmp(EFFECTS[a].name, EFFECTS[b].name) != 0);
+    }
+  }
+}
+
+void test_unknown_mode_renders_as_mode_zero() {
+  const uint16_t numLeds = 45;
+  LEDEffects effects;
+  effects.begin(numLeds * 2);
+  CRGB expected[numLeds * 2];
+  
+  for (unsigned long now = 0; now < 5000; now += 777) {
+    effects.render(makeSettings(0), 0.9f, now);
+    memcpy(expected, effects.getRenderedLeds(), sizeof(expected));
+    effects.render(makeSettings(EFFECT_COUNT), 0.9f, now);
+    TEST_ASSERT_EQUAL(0, memcmp(expected, effects.getRenderedLeds(), sizeof(expected)));
+  }
+}
+
+void test_effects_stay_inside_their_ring() {
+  const uint16_t numLeds = 16;
+  const CRGB guard(1, 2, 3);
+  CRGB buffer[numLeds + 2];
+  AfterburnerSettings settings = makeSettings(0);
+  
+  for (uint8_t mode = 0; mode < EFFECT_COUNT; mode++) {
+    settings.mode = mode;
+    FrameContext frame = {};
+    frame.now = 1234;
+    frame.effect = &EFFECTS[mode];
+    frame.ringCount = 2;
+    frame.ringPhase[1] = ANGLE_HALF_TURN;
+    frame.afterburnerActive = true;
+    frame.ringAbIntensity[0] = Q16_16_ONE;
+    frame.ringAbIntensity[1] = Q16_16_ONE;
+    
+    EffectInput input;
+    input.settings = &settings;
+    input.throttle = 1.0f;
+    input.throttleQ16 = Q16_16_ONE;
+    input.startColor = CRGB(255, 0, 0);
+    input.endColor = CRGB(0, 0, 255);
+    frame.effect->prepareFrame(frame, input);
+    
+    for (uint8_t ring = 0; ring < frame.ringCount; ring++) {
+      for (uint16_t i = 0; i < numLeds + 2; i++) {
+        buffer[i] = guard;
+      }
+      frame.effect->renderRing(frame, ring, buffer + 1, numLeds);
+      TEST_ASSERT_TRUE(buffer[0] == guard);
+      TEST_ASSERT_TRUE(buffer[numLeds + 1] == guard);
+      TEST_ASSERT_TRUE(buffer[1] != guard);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_modes_follow_the_table);
+  RUN_TEST(test_names_are_unique);
+  RUN_TEST(test_unknown_mode_renders_as_mode_zero);
+  RUN_TEST(test_effects_stay_inside_their_ring);
+  return UNITY_END();
+}
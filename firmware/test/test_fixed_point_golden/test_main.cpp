@@ -0,0 +1,229 @@
+// Golden-image test for the fixed-point LED render path.
+//
+// Run with: pio test -e native -f test_fixed_point_golden
+//
+// referenceRender() is a frozen copy of the original floating-point renderer
+// (sin(), pow(), float lerpColor). Every pixel LEDEffects::render() produces
+// (its effect colours, before the output stage) must stay within
+// GOLDEN_TOLERANCE of it on every channel.
+//
+// Speeds are restricted to values where 1000/speedMs is exact in binary: the
+// noise and sparkle clocks are then bit-identical in both paths. With other
+// speeds a one-count difference in those clocks flips whole pixels on or off,
+// which is a different animation frame rather than a colour error.
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "led_effects.h"
+#include "settings_record.h"
+
+#define GOLDEN_TOLERANCE 2
+
+static const uint16_t RING_SIZES[] = {1, 7, 45, 300};
+static const uint16_t SPEEDS_MS[] = {250, 500, 1000, 2000};
+static const float THROTTLES[] = {0.0f, 0.1f, 0.35f, 0.5f, 0.79f, 0.81f, 0.9f, 0.95f, 1.0f};
+static const unsigned long TIMES_MS[] = {0, 37, 1234, 5000, 9999};
+static const uint8_t AB_THRESHOLDS[] = {0, 50, 80};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof(a[0]))
+
+// ---------------------------------------------------------------------------
+// Reference: the original float renderer, kept verbatim apart from plumbing
+// ---------------------------------------------------------------------------
+
+static CRGB refLerpColor(CRGB color1, CRGB color2, float factor) {
+  factor = constrain(factor, 0.0f, 1.0f);
+
+  CRGB result;
+  result.r = (uint8_t)(color1.r + (color2.r - color1.r) * factor);
+  result.g = (uint8_t)(color1.g + (color2.g - color1.g) * factor);
+  result.b = (uint8_t)(color1.b + (color2.b - color1.b) * factor);
+  return result;
+}
+
+static void referenceRender(CRGB* leds, uint16_t numLeds, const AfterburnerSettings& settings,
+                            float throttle, unsigned long now) {
+  uint16_t totalLeds = numLeds * 2;
+  for (uint16_t i = 0; i < totalLeds; i++) {
+    leds[i] = CRGB::Black;
+  }
+
+  // Core effect
+  float easedThrottle = (settings.mode == 0) ? throttle : pow(throttle, 1.2f);
+  CRGB startColor = CRGB(settings.startColor[0], settings.startColor[1], settings.startColor[2]);
+  CRGB endColor = CRGB(settings.endColor[0], settings.endColor[1], settings.endColor[2]);
+  uint8_t baseBrightness = 255;
+
+  if (settings.mode == 0) {
+    float litPercentage = constrain(throttle, 0.20f, 1.0f);
+    uint8_t noiseThreshold = (uint8_t)(255 - (255 * litPercentage));
+    float flickerSpeed = (1000.0f / (float)settings.speedMs) * 5.0f;
+    uint32_t timeOffset = (uint32_t)(now * flickerSpeed);
+
+    for (uint16_t i = 0; i < totalLeds; i++) {
+      bool ring2 = i >= numLeds;
+      uint16_t localIndex = ring2 ? (i - numLeds) : i;
+      uint32_t seedOffset = ring2 ? 10000 : 0;
+      uint8_t noise = inoise8((localIndex * 37 + seedOffset), timeOffset + (localIndex * 13));
+      if (noise > noiseThreshold) {
+        CRGB color = refLerpColor(startColor, endColor, throttle);
+        color.nscale8(baseBrightness);
+        leds[i] = color;
+      }
+    }
+  } else {
+    for (uint16_t i = 0; i < totalLeds; i++) {
+      bool ring2 = i >= numLeds;
+      float breathingSpeed = 1000.0f / (float)settings.speedMs;
+      float phaseOffset = ring2 ? M_PI : 0.0f;
+      float breathing = 0.7f + 0.3f * sin(now * breathingSpeed + phaseOffset);
+      uint8_t currentBrightness = (uint8_t)(baseBrightness * breathing);
+
+      CRGB color = refLerpColor(startColor, endColor, easedThrottle);
+      color.nscale8(currentBrightness);
+      leds[i] = color;
+    }
+  }
+
+  // Afterburner overlay
+  float abThreshold = settings.abThreshold / 100.0f;
+  if (throttle <= abThreshold) {
+    return;
+  }
+
+  float abIntensity = (throttle - abThreshold) / (1.0f - abThreshold);
+  abIntensity = constrain(abIntensity, 0.0f, 1.0f);
+  CRGB abCoreColor1 = CRGB(90, 60, 255);
+  CRGB abCoreColor2 = CRGB(255, 90, 255);
+
+  for (uint16_t i = 0; i < totalLeds; i++) {
+    bool ring2 = i >= numLeds;
+    uint16_t localIndex = ring2 ? (i - numLeds) : i;
+    float position = (float)localIndex / numLeds;
+    position = ring2 ? (1.0f - position) : position;
+    float spatialProfile = 0.65f + 0.35f * sin(2.0f * M_PI * position);
+
+    float currentAbIntensity = abIntensity;
+    if (settings.mode == 2) {
+      float pulseFrequency = 1000.0f / (float)settings.speedMs;
+      float phaseOffset = ring2 ? M_PI : 0.0f;
+      float pulse = 0.6f + 0.4f * sin(now * pulseFrequency + phaseOffset);
+      currentAbIntensity *= pulse;
+    }
+
+    CRGB abColor = refLerpColor(abCoreColor1, abCoreColor2, throttle);
+    uint8_t abBrightness = (uint8_t)(255 * currentAbIntensity * spatialProfile);
+    abColor.nscale8(abBrightness);
+    leds[i] += abColor;
+  }
+
+  // Sparkles
+  if (abIntensity > 0.4f) {
+    float sparkleFrequency = 1000.0f / (float)settings.speedMs;
+    uint16_t sparkleChance = (uint16_t)(abIntensity * 50 * sparkleFrequency);
+    for (uint16_t i = 0; i < totalLeds; i++) {
+      uint32_t sparkleSeed = (now * sparkleFrequency) + (i * 17) + ((i >= numLeds) ? 5000 : 0);
+      if ((sparkleSeed % 1000) < sparkleChance) {
+        uint8_t sparkleIntensity = 50 + (sparkleSeed % 100);
+        leds[i] += CRGB(sparkleIntensity, sparkleIntensity, sparkleIntensity);
+      }
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+
+static AfterburnerSettings makeSettings(uint8_t mode, uint16_t speedMs, uint8_t abThreshold) {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = mode;
+  settings.speedMs = speedMs;
+  settings.abThreshold = abThreshold;
+  return settings;
+}
+
+static void checkMode(uint8_t mode) {
+  int worstError = 0;
+  unsigned long pixelsChecked = 0;
+
+  for (size_t r = 0; r < COUNT_OF(RING_SIZES); r++) {
+    uint16_t numLeds = RING_SIZES[r];
+    LEDEffects effects;
+    effects.begin(numLeds * 2);
+    CRGB* expected = new CRGB[numLeds * 2];
+
+    for (size_t s = 0; s < COUNT_OF(SPEEDS_MS); s++) {
+      for (size_t a = 0; a < COUNT_OF(AB_THRESHOLDS); a++) {
+        AfterburnerSettings settings = makeSettings(mode, SPEEDS_MS[s], AB_THRESHOLDS[a]);
+        for (size_t t = 0; t < COUNT_OF(THROTTLES); t++) {
+          for (size_t m = 0; m < COUNT_OF(TIMES_MS); m++) {
+            effects.render(settings, THROTTLES[t], TIMES_MS[m]);
+            referenceRender(expected, numLeds, settings, THROTTLES[t], TIMES_MS[m]);
+
+            const CRGB* actual = effects.getRenderedLeds();
+            for (uint16_t i = 0; i < numLeds * 2; i++) {
+              for (int c = 0; c < 3; c++) {
+                int error = abs((int)actual[i].raw[c] - (int)expected[i].raw[c]);
+                if (error > worstError) {
+                  worstError = error;
+                }
+                if (error > GOLDEN_TOLERANCE) {
+                  printf("mode %u leds %u speed %u threshold %u throttle %.2f t=%lu led %u ch %d: "
+                         "expected %u got %u\n",
+                         mode, numLeds, SPEEDS_MS[s], AB_THRESHOLDS[a], THROTTLES[t], TIMES_MS[m], i, c,
+                         expected[i].raw[c], actual[i].raw[c]);
+                }
+                TEST_ASSERT_INT_WITHIN(GOLDEN_TOLERANCE, expected[i].raw[c], actual[i].raw[c]);
+              }
+              pixelsChecked++;
+            }
+          }
+        }
+      }
+    }
+    delete[] expected;
+  }
+
+  printf("mode %u: %lu pixels checked, worst channel error %d LSB\n", mode, pixelsChecked, worstError);
+}
+
+void test_sin_table_matches_sin() {
+  for (uint32_t angle = 0; angle < 65536; angle += 7) {
+    double expected = sin(2.0 * M_PI * angle / 65536.0) * 32767.0;
+    TEST_ASSERT_INT_WITHIN(6, (int)lround(expected), sinQ15((uint16_t)angle));
+  }
+}
+
+void test_ease_table_matches_pow() {
+  for (q16_16_t t = 0; t <= Q16_16_ONE; t += 13) {
+    double expected = pow(t / 65536.0, 1.2) * 65536.0;
+    TEST_ASSERT_INT_WITHIN(16, (int)expected, easeQ16(t));
+  }
+  TEST_ASSERT_EQUAL(Q16_16_ONE, easeQ16(Q16_16_ONE));
+}
+
+void test_linear_mode_matches_float_reference() {
+  checkMode(0);
+}
+
+void test_ease_mode_matches_float_reference() {
+  checkMode(1);
+}
+
+void test_pulse_mode_matches_float_reference() {
+  checkMode(2);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_sin_table_matches_sin);
+  RUN_TEST(test_ease_table_matches_pow);
+  RUN_TEST(test_linear_mode_matches_float_reference);
+  RUN_TEST(test_ease_mode_matches_float_reference);
+  RUN_TEST(test_pulse_mode_matches_float_reference);
+  return UNITY_END();
+}
@@ -0,0 +1,206 @@
+// Tests for the double-buffered LED pipeline: stage timings, the back/front
+// buffer handoff in LEDEffects and skipping unchanged frames.
+//
+// Run with: pio test -e native -f test_frame_timings
+
+#include <unity.h>
+#include "frame_timings.h"
+#include "led_effects.h"
+#include "settings_record.h"
+
+#define PERIOD_US 16666
+
+void setUp() {}
+void tearDown() {}
+
+void test_averages_publish_once_per_window() {
+  FrameTimings timings;
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW - 1; i++) {
+    timings.record(3000, 9000, 0, PERIOD_US);
+  }
+  TEST_ASSERT_EQUAL(0, timings.getRenderUs());
+  
+  timings.record(3000, 9000, 0, PERIOD_US);
+  TEST_ASSERT_EQUAL(3000, timings.getRenderUs());
+  TEST_ASSERT_EQUAL(9000, timings.getTransmitUs());
+  TEST_ASSERT_EQUAL(0, timings.getWaitUs());
+  TEST_ASSERT_EQUAL(PERIOD_US - 3000, timings.getIdleUs());
+}
+
+void test_transmit_overlaps_render() {
+  // An 18 ms transmission on a 16.7 ms period: the render task waits for the
+  // rest of it, but the render itself is hidden behind the transmission
+  FrameTimings timings;
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW; i++) {
+    timings.record(3000, 18000, 1334, PERIOD_US);
+  }
+  TEST_ASSERT_EQUAL(1334, timings.getWaitUs());
+  TEST_ASSERT_EQUAL(PERIOD_US - 3000 - 1334, timings.getIdleUs());
+  TEST_ASSERT_EQUAL(PERIOD_US, timings.getRenderUs() + timings.getWaitUs() + timings.getIdleUs());
+  
+  // An overrun frame has no idle time rather than a negative one
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW; i++) {
+    timings.record(12000, 18000, 6000, PERIOD_US);
+  }
+  TEST_ASSERT_EQUAL(0, timings.getIdleUs());
+}
+
+void test_max_transmit_holds_until_reset() {
+  FrameTimings timings;
+  timings.record(1000, 20000, 0, PERIOD_US);
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW * 2; i++) {
+    timings.record(1000, 9000, 0, PERIOD_US);
+  }
+  TEST_ASSERT_EQUAL(20000, timings.getMaxTransmitUs());
+  TEST_ASSERT_EQUAL(9000, timings.getTransmitUs());
+  
+  timings.reset();
+  TEST_ASSERT_EQUAL(0, timings.getMaxTransmitUs());
+  TEST_ASSERT_EQUAL(0, timings.getTransmitUs());
+}
+
+void test_skip_ratio_per_window() {
+  FrameTimings timings;
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW; i++) {
+    if (i % 4 == 0) {
+      timings.record(3000, 9000, 0, PERIOD_US);
+    } else {
+      timings.recordSkipped(200, PERIOD_US);
+    }
+  }
+  TEST_ASSERT_EQUAL(750, timings.getSkipPermille());
+  // Skipped frames send nothing and never wait; transmit stays per frame sent
+  TEST_ASSERT_EQUAL(9000, timings.getTransmitUs());
+  TEST_ASSERT_EQUAL(0, timings.getWaitUs());
+  
+  // A window with nothing sent keeps the last transmit time
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW; i++) {
+    timings.recordSkipped(200, PERIOD_US);
+  }
+  TEST_ASSERT_EQUAL(1000, timings.getSkipPermille());
+  TEST_ASSERT_EQUAL(9000, timings.getTransmitUs());
+  
+  for (uint32_t i = 0; i < FRAME_TIMINGS_WINDOW; i++) {
+    timings.record(3000, 9000, 0, PERIOD_US);
+  }
+  TEST_ASSERT_EQUAL(0, timings.getSkipPermille());
+}
+
+void test_unchanged_frame_is_skipped() {
+  LEDEffects effects;
+  effects.begin(30);
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = 0;
+  // LEDs fully on or off: exact 8-bit levels, nothing to dither
+  settings.startColor[0] = settings.endColor[0] = 255;
+  settings.startColor[1] = settings.endColor[1] = 0;
+  settings.startColor[2] = settings.endColor[2] = 0;
+  settings.brightness = 255;
+  
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 1, 0.5f, 1000));
+  effects.swapBuffers();
+  CRGB first = FastLED.getLeds()[0];
+  
+  // Same inputs, and throttle noise below one render step
+  TEST_ASSERT_FALSE(effects.renderFrameIfChanged(settings, 1, 0.5f, 1000));
+  TEST_ASSERT_FALSE(effects.renderFrameIfChanged(settings, 1, 0.5001f, 1000));
+  TEST_ASSERT_TRUE(FastLED.getLeds()[0] == first);
+  
+  // A throttle step, new settings or a later noise frame render again
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 1, 0.6f, 1000));
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 2, 0.6f, 1000));
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 2, 0.6f, 1300));
+  
+  // renderFrame() and begin() leave nothing to compare against
+  effects.renderFrame(settings, 0.6f, 1300);
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 2, 0.6f, 1300));
+  effects.begin(30);
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 2, 0.6f, 1300));
+}
+
+void test_static_frame_keeps_dithering() {
+  LEDEffects effects;
+  effects.begin(30);
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = 1;
+  settings.brightness = 40;
+  
+  // Nothing to render, but the levels between 8-bit steps are still sent
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 1, 0.5f, 1000));
+  CRGB rendered = effects.getRenderedLeds()[0];
+  bool outputChanged = false;
+  effects.swapBuffers();
+  CRGB first = FastLED.getLeds()[0];
+  for (int i = 0; i < 8; i++) {
+    TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 1, 0.5f, 1000));
+    effects.swapBuffers();
+    outputChanged = outputChanged || FastLED.getLeds()[0] != first;
+  }
+  TEST_ASSERT_TRUE(outputChanged);
+  TEST_ASSERT_TRUE(effects.getRenderedLeds()[0] == rendered);
+}
+
+void test_dark_strip_skips_animation() {
+  LEDEffects effects;
+  effects.begin(30);
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = 0;
+  
+  // The noise animation moves every frame...
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 1, 0.3f, 1000));
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 1, 0.3f, 1016));
+  
+  // ...but at zero brightness none of it is visible
+  settings.brightness = 0;
+  TEST_ASSERT_TRUE(effects.renderFrameIfChanged(settings, 2, 0.3f, 1033));
+  TEST_ASSERT_FALSE(effects.renderFrameIfChanged(settings, 2, 0.3f, 1050));
+  TEST_ASSERT_FALSE(effects.renderFrameIfChanged(settings, 2, 0.9f, 1066));
+}
+
+void test_render_frame_leaves_front_buffer_alone() {
+  LEDEffects effects;
+  effects.begin(30);
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = 1;
+  settings.brightness = 77;
+  
+  // Rendered into the back buffer: the outputs still send the dark frame
+  effects.renderFrame(settings, 1.0f, 1000);
+  const CRGB* front = FastLED.getLeds();
+  for (int i = 0; i < FastLED.size(); i++) {
+    TEST_ASSERT_TRUE(front[i] == CRGB(CRGB::Black));
+  }
+  
+  // The swap attaches the new frame, brightness already applied, to the outputs
+  effects.swapBuffers();
+  TEST_ASSERT_TRUE(FastLED.getLeds() != front);
+  TEST_ASSERT_TRUE(FastLED.getLeds()[0] != CRGB(CRGB::Black));
+  unsigned long shows = FastLED.showCount;
+  effects.show();
+  TEST_ASSERT_EQUAL(shows + 1, FastLED.showCount);
+  TEST_ASSERT_EQUAL(255, FastLED.getBrightness());
+  TEST_ASSERT_EQUAL(DISABLE_DITHER, FastLED.getDither());
+  
+  // The next frame goes into the buffer that was just sent
+  effects.renderFrame(settings, 0.0f, 1016);
+  TEST_ASSERT_TRUE(FastLED.getLeds()[0] != CRGB(CRGB::Black));
+  effects.swapBuffers();
+  TEST_ASSERT_TRUE(FastLED.getLeds() == front);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_averages_publish_once_per_window);
+  RUN_TEST(test_transmit_overlaps_render);
+  RUN_TEST(test_max_transmit_holds_until_reset);
+  RUN_TEST(test_render_frame_leaves_front_buffer_alone);
+  RUN_TEST(test_skip_ratio_per_window);
+  RUN_TEST(test_unchanged_frame_is_skipped);
+  RUN_TEST(test_static_frame_keeps_dithering);
+  RUN_TEST(test_dark_strip_skips_animation);
+  return UNITY_END();
+}
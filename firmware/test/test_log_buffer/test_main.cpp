@@ -0,0 +1,182 @@
+// Tests for the lock-free log line queue behind LOG_INFO() and friends.
+//
+// Run with: pio test -e native -f test_log_buffer
+
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <thread>
+#include "log_buffer.h"
+
+static bool pushString(LogBuffer& buffer, const char* text) {
+  return buffer.push(text, strlen(text));
+}
+
+static size_t popString(LogBuffer& buffer, char* text) {
+  size_t length = buffer.pop(text);
+  text[length] = '\0';
+  return length;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_lines_come_out_in_order() {
+  LogBuffer buffer;
+  char line[LOG_LINE_MAX + 1];
+  TEST_ASSERT_EQUAL(0, buffer.pop(line));
+  
+  TEST_ASSERT_TRUE(pushString(buffer, "first\n"));
+  TEST_ASSERT_TRUE(pushString(buffer, "second\n"));
+  
+  TEST_ASSERT_EQUAL(6, popString(buffer, line));
+  TEST_ASSERT_EQUAL_STRING("first\n", line);
+  TEST_ASSERT_EQUAL(7, popString(buffer, line));
+  TEST_ASSERT_EQUAL_STRING("second\n", line);
+  TEST_ASSERT_EQUAL(0, buffer.pop(line));
+}
+
+void test_full_buffer_drops_and_counts() {
+  LogBuffer buffer;
+  char line[LOG_LINE_MAX + 1];
+  char text[16];
+  
+  for (int i = 0; i < LOG_BUFFER_LINES; i++) {
+    snprintf(text, sizeof(text), "%d\n", i);
+    TEST_ASSERT_TRUE(pushString(buffer, text));
+  }
+  TEST_ASSERT_FALSE(pushString(buffer, "lost\n"));
+  TEST_ASSERT_FALSE(pushString(buffer, "lost\n"));
+  TEST_ASSERT_EQUAL(2, buffer.getDroppedLines());
+  
+  // Oldest lines are kept; freeing one slot accepts new lines again
+  TEST_ASSERT_EQUAL(2, popString(buffer, line));
+  TEST_ASSERT_EQUAL_STRING("0\n", line);
+  TEST_ASSERT_TRUE(pushString(buffer, "kept\n"));
+  
+  for (int i = 1; i < LOG_BUFFER_LINES; i++) {
+    popString(buffer, line);
+    snprintf(text, sizeof(text), "%d\n", i);
+    TEST_ASSERT_EQUAL_STRING(text, line);
+  }
+  popString(buffer, line);
+  TEST_ASSERT_EQUAL_STRING("kept\n", line);
+  TEST_ASSERT_EQUAL(0, buffer.pop(line));
+  TEST_ASSERT_EQUAL(2, buffer.getDroppedLines());
+}
+
+void test_long_lines_are_truncated() {
+  LogBuffer buffer;
+  char text[LOG_LINE_MAX * 2];
+  char line[LOG_LINE_MAX + 1];
+  memset(text, 'x', sizeof(text));
+  
+  TEST_ASSERT_TRUE(buffer.push(text, sizeof(text)));
+  TEST_ASSERT_EQUAL(LOG_LINE_MAX, buffer.pop(line));
+}
+
+void test_maximum_length_line_is_kept_whole() {
+  LogBuffer buffer;
+  char text[LOG_LINE_MAX];
+  char line[LOG_LINE_MAX + 1];
+  for (size_t i = 0; i < sizeof(text); i++) {
+    text[i] = 'a' + i % 26;
+  }
+  
+  TEST_ASSERT_TRUE(buffer.push(text, sizeof(text)));
+  TEST_ASSERT_EQUAL(LOG_LINE_MAX, buffer.pop(line));
+  TEST_ASSERT_EQUAL(0, memcmp(text, line, sizeof(text)));
+}
+
+void test_longest_message_fits() {
+  // The settings commit line with every number at its widest
+  char text[LOG_LINE_MAX * 2];
+  int length = snprintf(text, sizeof(text), "Settings: ✅ All settings saved successfully - mode=%d, startColor=[%d,%d,%d], endColor=[%d,%d,%d], speed=%d, brightness=%d, numLeds=%d, abThreshold=%d, throttleMin=%d, throttleMax=%d\n",
+                        255, 255, 255, 255, 255, 255, 255, 65535, 255, 65535, 255, 65535, 65535);
+  TEST_ASSERT_TRUE(length < LOG_LINE_MAX);
+}
+
+void test_buffer_wraps_many_laps() {
+  LogBuffer buffer;
+  char line[LOG_LINE_MAX + 1];
+  char text[16];
+  
+  for (int i = 0; i < LOG_BUFFER_LINES * 10; i++) {
+    snprintf(text, sizeof(text), "%d\n", i);
+    TEST_ASSERT_TRUE(pushString(buffer, text));
+    popString(buffer, line);
+    TEST_ASSERT_EQUAL_STRING(text, line);
+  }
+  TEST_ASSERT_EQUAL(0, buffer.getDroppedLines());
+}
+
+void test_concurrent_producers_lose_nothing_silently() {
+  LogBuffer buffer;
+  const int producers = 4;
+  const int linesPerProducer = 2000;
+  int received[producers] = {0};
+  int lastIndex[producers];
+  bool ordered = true;
+  std::atomic<int> running(producers);
+  
+  for (int p = 0; p < producers; p++) {
+    lastIndex[p] = -1;
+  }
+  
+  std::thread threads[producers];
+  for (int p = 0; p < producers; p++) {
+    threads[p] = std::thread([&buffer, &running, p, linesPerProducer]() {
+      char text[16];
+      for (int i = 0; i < linesPerProducer; i++) {
+        int length = snprintf(text, sizeof(text), "%d %d\n", p, i);
+        buffer.push(text, length);
+      }
+      running--;
+    });
+  }
+  
+  // Consume while the producers run, then drain what is left
+  char line[LOG_LINE_MAX + 1];
+  while (true) {
+    bool done = running.load() == 0;
+    size_t length;
+    while ((length = popString(buffer, line)) > 0) {
+      int producer, index;
+      TEST_ASSERT_EQUAL(2, sscanf(line, "%d %d", &producer, &index));
+      TEST_ASSERT_TRUE(producer >= 0 && producer < producers);
+      if (index <= lastIndex[producer]) {
+        ordered = false;
+      }
+      lastIndex[producer] = index;
+      received[producer]++;
+    }
+    if (done) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+  
+  for (int p = 0; p < producers; p++) {
+    threads[p].join();
+  }
+  
+  // Every line was either delivered intact or counted as dropped
+  int total = 0;
+  for (int p = 0; p < producers; p++) {
+    total += received[p];
+  }
+  TEST_ASSERT_TRUE(ordered);
+  TEST_ASSERT_EQUAL(producers * linesPerProducer, total + (int)buffer.getDroppedLines());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lines_come_out_in_order);
+  RUN_TEST(test_full_buffer_drops_and_counts);
+  RUN_TEST(test_long_lines_are_truncated);
+  RUN_TEST(test_maximum_length_line_is_kept_whole);
+  RUN_TEST(test_longest_message_fits);
+  RUN_TEST(test_buffer_wraps_many_laps);
+  RUN_TEST(test_concurrent_producers_lose_nothing_silently);
+  return UNITY_END();
+}
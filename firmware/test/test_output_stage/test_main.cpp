@@ -0,0 +1,134 @@
+// Tests for the LED output stage: gamma table, brightness in 16 bits and
+// temporal dithering down to the strip's 8 bits.
+//
+// Run with: pio test -e native -f test_output_stage
+
+#include <unity.h>
+#include "output_stage.h"
+
+#define GRADIENT_LEDS 32
+
+void setUp() {}
+void tearDown() {}
+
+// Sum of each channel over that many dithered frames
+static void sumFrames(OutputStage& stage, CRGB* leds, uint16_t count, uint16_t frames, uint32_t* sums) {
+  memset(sums, 0, count * 3 * sizeof(uint32_t));
+  for (uint16_t f = 0; f < frames; f++) {
+    stage.dither(leds);
+    for (uint16_t i = 0; i < count; i++) {
+      for (uint8_t c = 0; c < 3; c++) {
+        sums[i * 3 + c] += leds[i].raw[c];
+      }
+    }
+  }
+}
+
+static void fillGradient(CRGB* leds) {
+  // Start -> end colour ramp, as lerpColor() renders it
+  for (uint16_t i = 0; i < GRADIENT_LEDS; i++) {
+    leds[i] = CRGB(255 - i * 3, 40 + i, i * 8);
+  }
+}
+
+void test_gamma_table_spans_the_output_range() {
+  OutputStage stage;
+  stage.begin(1);
+  TEST_ASSERT_EQUAL(0, stage.getGammaLevel(0));
+  TEST_ASSERT_EQUAL(OUTPUT_LEVEL_MAX, stage.getGammaLevel(255));
+  for (uint16_t value = 1; value < 256; value++) {
+    TEST_ASSERT_TRUE(stage.getGammaLevel(value) >= stage.getGammaLevel(value - 1));
+  }
+  // Half the input is about a fifth of the light at gamma 2.2
+  TEST_ASSERT_INT_WITHIN(OUTPUT_LEVEL_MAX / 100, OUTPUT_LEVEL_MAX * 22 / 100, stage.getGammaLevel(128));
+  
+  // Gamma 1 is the identity in 16 bits
+  stage.begin(1, 1.0f);
+  TEST_ASSERT_EQUAL(100 << 8, stage.getGammaLevel(100));
+}
+
+void test_average_over_a_cycle_matches_the_16_bit_level() {
+  CRGB leds[GRADIENT_LEDS];
+  fillGradient(leds);
+  OutputStage stage;
+  stage.begin(GRADIENT_LEDS);
+  stage.encode(leds, 20);
+  TEST_ASSERT_TRUE(stage.needsDither());
+  
+  uint32_t sums[GRADIENT_LEDS * 3];
+  sumFrames(stage, leds, GRADIENT_LEDS, OUTPUT_DITHER_FRAMES, sums);
+  const uint16_t* levels = stage.getLevels();
+  for (uint16_t i = 0; i < GRADIENT_LEDS * 3; i++) {
+    TEST_ASSERT_EQUAL(levels[i], sums[i] * 256 / OUTPUT_DITHER_FRAMES);
+  }
+}
+
+void test_short_windows_stay_close_to_the_level() {
+  // Any aligned run of 64 frames is within 1/64 of an 8-bit step
+  CRGB leds[GRADIENT_LEDS];
+  fillGradient(leds);
+  OutputStage stage;
+  stage.begin(GRADIENT_LEDS);
+  stage.encode(leds, 90);
+  
+  uint32_t sums[GRADIENT_LEDS * 3];
+  const uint16_t* levels = stage.getLevels();
+  for (uint8_t window = 0; window < OUTPUT_DITHER_FRAMES / 64; window++) {
+    sumFrames(stage, leds, GRADIENT_LEDS, 64, sums);
+    for (uint16_t i = 0; i < GRADIENT_LEDS * 3; i++) {
+      TEST_ASSERT_INT_WITHIN(4, levels[i], sums[i] * 256 / 64);
+    }
+  }
+}
+
+void test_low_brightness_keeps_every_gradient_step() {
+  // 8-bit brightness scaling folds these reds onto two levels; the 16-bit
+  // levels and their dithered averages keep all of them apart
+  const uint8_t count = 12;
+  CRGB leds[count];
+  for (uint8_t i = 0; i < count; i++) {
+    leds[i] = CRGB(200 + i, 0, 0);
+  }
+  OutputStage stage;
+  stage.begin(count);
+  stage.encode(leds, 16);
+  
+  uint32_t sums[count * 3];
+  sumFrames(stage, leds, count, OUTPUT_DITHER_FRAMES, sums);
+  const uint16_t* levels = stage.getLevels();
+  for (uint8_t i = 1; i < count; i++) {
+    TEST_ASSERT_TRUE(levels[i * 3] > levels[(i - 1) * 3]);
+    TEST_ASSERT_TRUE(sums[i * 3] > sums[(i - 1) * 3]);
+  }
+}
+
+void test_exact_levels_are_sent_unchanged() {
+  CRGB leds[3] = {CRGB(255, 0, 255), CRGB(0, 0, 0), CRGB(255, 255, 255)};
+  OutputStage stage;
+  stage.begin(3);
+  stage.encode(leds, 255);
+  TEST_ASSERT_FALSE(stage.needsDither());
+  
+  for (int f = 0; f < 10; f++) {
+    stage.dither(leds);
+    TEST_ASSERT_TRUE(leds[0] == CRGB(255, 0, 255));
+    TEST_ASSERT_TRUE(leds[1] == CRGB(0, 0, 0));
+    TEST_ASSERT_TRUE(leds[2] == CRGB(255, 255, 255));
+  }
+  
+  // Zero brightness is black, however bright the colours
+  stage.encode(leds, 0);
+  TEST_ASSERT_FALSE(stage.needsDither());
+  stage.dither(leds);
+  TEST_ASSERT_TRUE(leds[2] == CRGB(0, 0, 0));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_gamma_table_spans_the_output_range);
+  RUN_TEST(test_average_over_a_cycle_matches_the_16_bit_level);
+  RUN_TEST(test_short_windows_stay_close_to_the_level);
+  RUN_TEST(test_low_brightness_keeps_every_gradient_step);
+  RUN_TEST(test_exact_levels_are_sent_unchanged);
+  return UNITY_END();
+}
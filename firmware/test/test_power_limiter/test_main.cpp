@@ -0,0 +1,140 @@
+// Tests for the LED current estimate and the power budget limiter.
+//
+// Run with: pio test -e native -f test_power_limiter
+
+#include <unity.h>
+#include "power_limiter.h"
+#include "output_stage.h"
+#include "led_effects.h"
+#include "settings_record.h"
+
+#define STRIP_LEDS 600
+
+void setUp() {}
+void tearDown() {}
+
+static void fillSums(uint32_t* sums, uint16_t leds, uint16_t red, uint16_t green, uint16_t blue) {
+  sums[0] = (uint32_t)leds * red;
+  sums[1] = (uint32_t)leds * green;
+  sums[2] = (uint32_t)leds * blue;
+}
+
+void test_estimate_is_linear_in_the_levels() {
+  PowerLimiter limiter;
+  limiter.setChannelCurrents(20, 10, 5, 1);
+  uint32_t sums[3];
+  
+  // Dark strip: idle current only
+  fillSums(sums, 100, 0, 0, 0);
+  limiter.update(sums, 100);
+  TEST_ASSERT_EQUAL(100, limiter.getRequestedMa());
+  
+  // Full white: every channel at its full current
+  fillSums(sums, 100, OUTPUT_LEVEL_MAX, OUTPUT_LEVEL_MAX, OUTPUT_LEVEL_MAX);
+  limiter.update(sums, 100);
+  TEST_ASSERT_EQUAL(100 + 100 * 35, limiter.getRequestedMa());
+  
+  // Half-level red
+  fillSums(sums, 100, OUTPUT_LEVEL_MAX / 2, 0, 0);
+  limiter.update(sums, 100);
+  TEST_ASSERT_EQUAL(100 + 100 * 10, limiter.getRequestedMa());
+}
+
+void test_frames_within_budget_are_not_scaled() {
+  PowerLimiter limiter;
+  limiter.setChannelCurrents(20, 20, 20, 1);
+  uint32_t sums[3];
+  fillSums(sums, 50, OUTPUT_LEVEL_MAX, OUTPUT_LEVEL_MAX, OUTPUT_LEVEL_MAX);
+  
+  // 50 + 3000 mA: no budget, then a budget that fits
+  TEST_ASSERT_EQUAL(Q16_16_ONE, limiter.update(sums, 50));
+  limiter.setBudget(3050);
+  TEST_ASSERT_EQUAL(Q16_16_ONE, limiter.update(sums, 50));
+  TEST_ASSERT_FALSE(limiter.isLimiting());
+  TEST_ASSERT_EQUAL(limiter.getRequestedMa(), limiter.getEstimatedMa());
+}
+
+void test_over_budget_frames_scale_to_the_budget() {
+  PowerLimiter limiter;
+  limiter.setChannelCurrents(20, 20, 20, 1);
+  limiter.setBudget(1000);
+  uint32_t sums[3];
+  fillSums(sums, 50, OUTPUT_LEVEL_MAX, OUTPUT_LEVEL_MAX, OUTPUT_LEVEL_MAX);
+  
+  // Idle current stays; the 3000 mA of colour is cut to 950
+  q16_16_t scale = limiter.update(sums, 50);
+  TEST_ASSERT_TRUE(limiter.isLimiting());
+  TEST_ASSERT_EQUAL(3050, limiter.getRequestedMa());
+  TEST_ASSERT_INT_WITHIN(2, Q16_16(950.0 / 3000.0), scale);
+  TEST_ASSERT_TRUE(limiter.getEstimatedMa() <= 1000);
+  TEST_ASSERT_TRUE(limiter.getEstimatedMa() >= 999);
+  
+  // A budget below the idle current leaves only the idle current
+  limiter.setBudget(20);
+  TEST_ASSERT_EQUAL(0, limiter.update(sums, 50));
+  TEST_ASSERT_EQUAL(50, limiter.getEstimatedMa());
+}
+
+void test_sent_frames_average_within_budget() {
+  // Full white on the largest strip, through the output stage: the current of
+  // what is actually sent, averaged over a dither cycle, meets the budget
+  static CRGB leds[STRIP_LEDS];
+  fill_solid(leds, STRIP_LEDS, CRGB(255, 255, 255));
+  OutputStage stage;
+  stage.begin(STRIP_LEDS);
+  stage.encode(leds, 255);
+  
+  PowerLimiter limiter;
+  limiter.setBudget(DEFAULT_POWER_BUDGET_MA);
+  stage.setScale(limiter.update(stage.getChannelSums(), STRIP_LEDS));
+  TEST_ASSERT_TRUE(limiter.getRequestedMa() > 20000);
+  TEST_ASSERT_TRUE(stage.needsDither());
+  
+  uint64_t channelTotals[3] = {0, 0, 0};
+  for (int f = 0; f < OUTPUT_DITHER_FRAMES; f++) {
+    stage.dither(leds);
+    for (uint16_t i = 0; i < STRIP_LEDS; i++) {
+      for (uint8_t c = 0; c < 3; c++) {
+        channelTotals[c] += leds[i].raw[c];
+      }
+    }
+  }
+  const uint16_t channelMa[3] = {LED_MA_RED, LED_MA_GREEN, LED_MA_BLUE};
+  double averageMa = STRIP_LEDS * LED_MA_IDLE;
+  for (uint8_t c = 0; c < 3; c++) {
+    averageMa += (double)channelTotals[c] / OUTPUT_DITHER_FRAMES / 255.0 * channelMa[c];
+  }
+  TEST_ASSERT_TRUE(averageMa <= DEFAULT_POWER_BUDGET_MA);
+  TEST_ASSERT_TRUE(averageMa >= DEFAULT_POWER_BUDGET_MA * 0.98);
+}
+
+void test_led_effects_apply_the_settings_budget() {
+  LEDEffects effects;
+  effects.begin(600);
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.brightness = 255;
+  
+  // Full afterburner on 600 LEDs is far over the default budget
+  effects.renderFrame(settings, 1.0f, 1000);
+  const PowerLimiter& power = effects.getPowerLimiter();
+  TEST_ASSERT_TRUE(power.isLimiting());
+  TEST_ASSERT_TRUE(power.getRequestedMa() > DEFAULT_POWER_BUDGET_MA);
+  TEST_ASSERT_TRUE(power.getEstimatedMa() <= DEFAULT_POWER_BUDGET_MA);
+  
+  // Budget 0 sends the frame as rendered
+  settings.powerBudgetMa = 0;
+  effects.renderFrame(settings, 1.0f, 1000);
+  TEST_ASSERT_FALSE(power.isLimiting());
+  TEST_ASSERT_EQUAL(power.getRequestedMa(), power.getEstimatedMa());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_estimate_is_linear_in_the_levels);
+  RUN_TEST(test_frames_within_budget_are_not_scaled);
+  RUN_TEST(test_over_budget_frames_scale_to_the_budget);
+  RUN_TEST(test_sent_frames_average_within_budget);
+  RUN_TEST(test_led_effects_apply_the_settings_budget);
+  return UNITY_END();
+}
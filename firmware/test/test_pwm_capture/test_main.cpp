@@ -0,0 +1,100 @@
+// Tests for the interrupt-driven throttle capture on the host.
+//
+// Run with: pio test -e native -f test_pwm_capture
+//
+// The fake GPIO in native/Arduino.h calls the attached CHANGE handler on
+// every level change, so pulses are generated edge by edge on the fake clock.
+
+#include <unity.h>
+#include "pwm_capture.h"
+
+#define RC_FRAME_US 20000  // 50 Hz receiver frame
+
+static void sendPulse(uint16_t widthUs) {
+  setNativePin(THROTTLE_PIN, HIGH);
+  advanceNativeMicros(widthUs);
+  setNativePin(THROTTLE_PIN, LOW);
+  advanceNativeMicros(RC_FRAME_US - widthUs);
+}
+
+void setUp() {
+  setNativeMillis(1000);
+  setNativePin(THROTTLE_PIN, LOW);
+  PwmCapture::begin(THROTTLE_PIN);
+}
+
+void tearDown() {}
+
+void test_no_signal_reads_zero() {
+  uint16_t pulse;
+  TEST_ASSERT_EQUAL(0, PwmCapture::getLatestPulse());
+  TEST_ASSERT_FALSE(PwmCapture::popPulse(pulse));
+}
+
+void test_latest_pulse_is_measured() {
+  sendPulse(1500);
+  sendPulse(1234);
+  TEST_ASSERT_EQUAL(1234, PwmCapture::getLatestPulse());
+}
+
+void test_signal_loss_after_timeout() {
+  sendPulse(1500);
+  advanceNativeMicros(PWM_TIMEOUT);
+  TEST_ASSERT_EQUAL(0, PwmCapture::getLatestPulse());
+}
+
+void test_pulses_queue_in_order() {
+  sendPulse(1000);
+  sendPulse(1500);
+  sendPulse(2000);
+  
+  uint16_t pulse;
+  TEST_ASSERT_TRUE(PwmCapture::popPulse(pulse));
+  TEST_ASSERT_EQUAL(1000, pulse);
+  TEST_ASSERT_TRUE(PwmCapture::popPulse(pulse));
+  TEST_ASSERT_EQUAL(1500, pulse);
+  TEST_ASSERT_TRUE(PwmCapture::popPulse(pulse));
+  TEST_ASSERT_EQUAL(2000, pulse);
+  TEST_ASSERT_FALSE(PwmCapture::popPulse(pulse));
+}
+
+void test_full_buffer_drops_newest() {
+  uint32_t droppedBefore = PwmCapture::getDroppedPulses();
+  for (int i = 0; i < PWM_CAPTURE_BUFFER_SIZE + 4; i++) {
+    sendPulse(1000 + i);
+  }
+  // One slot stays empty to tell full from empty
+  TEST_ASSERT_EQUAL(droppedBefore + 5, PwmCapture::getDroppedPulses());
+  TEST_ASSERT_EQUAL(1000 + PWM_CAPTURE_BUFFER_SIZE + 3, PwmCapture::getLatestPulse());
+  
+  uint16_t pulse;
+  TEST_ASSERT_TRUE(PwmCapture::popPulse(pulse));
+  TEST_ASSERT_EQUAL(1000, pulse);
+  
+  PwmCapture::flush();
+  TEST_ASSERT_FALSE(PwmCapture::popPulse(pulse));
+}
+
+void test_overlong_pulse_is_ignored() {
+  sendPulse(1500);
+  setNativePin(THROTTLE_PIN, HIGH);
+  advanceNativeMicros(PWM_TIMEOUT + 1);
+  setNativePin(THROTTLE_PIN, LOW);
+  TEST_ASSERT_EQUAL(0, PwmCapture::getLatestPulse());
+  
+  uint16_t pulse;
+  TEST_ASSERT_TRUE(PwmCapture::popPulse(pulse));
+  TEST_ASSERT_EQUAL(1500, pulse);
+  TEST_ASSERT_FALSE(PwmCapture::popPulse(pulse));
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_no_signal_reads_zero);
+  RUN_TEST(test_latest_pulse_is_measured);
+  RUN_TEST(test_signal_loss_after_timeout);
+  RUN_TEST(test_pulses_queue_in_order);
+  RUN_TEST(test_full_buffer_drops_newest);
+  RUN_TEST(test_overlong_pulse_is_ignored);
+  return UNITY_END();
+}
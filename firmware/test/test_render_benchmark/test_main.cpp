@@ -0,0 +1,153 @@
+// Frame-time benchmark for LEDEffects on the host.
+//
+// Run with: pio test -e native -f test_render_benchmark -v
+//
+// prepareFrame() and each per-LED render stage are timed separately for every
+// mode and ring size and reported as ns/frame and ns/LED (LED = one pixel
+// across both rings).
+// Host numbers are not device numbers, but they move together: quote the
+// before/after table for any change to led_effects.cpp.
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include "led_effects.h"
+#include "settings_record.h"
+
+struct LEDEffectsTestAccess {
+  static void prepareFrame(LEDEffects& effects, const AfterburnerSettings& settings, float throttle) {
+    effects.prepareFrame(settings, throttle, millis());
+  }
+  static void renderCoreEffect(LEDEffects& effects) {
+    effects.renderCoreEffect();
+  }
+  static void renderAfterburnerOverlay(LEDEffects& effects) {
+    effects.renderAfterburnerOverlay();
+  }
+  static void addSparkles(LEDEffects& effects) {
+    effects.addSparkles();
+  }
+};
+
+// LEDs per ring to sweep (the BLE setting allows 1-300)
+static const uint16_t RING_SIZES[] = {1, 8, 45, 100, 150, 300};
+#define NUM_RING_SIZES (sizeof(RING_SIZES) / sizeof(RING_SIZES[0]))
+
+#define BENCH_THROTTLE 0.95f         // Above the default AB threshold so every stage does work
+#define BENCH_LED_UPDATES 2000000UL  // Pixel updates per measurement
+#define BENCH_MIN_FRAMES 500UL
+#define BENCH_WARMUP_FRAMES 50
+#define FRAME_PERIOD_US 16667        // 60 fps worth of animation time per frame
+
+enum BenchStage {
+  STAGE_PREPARE,
+  STAGE_CORE,
+  STAGE_OVERLAY,
+  STAGE_SPARKLES,
+  STAGE_RENDER
+};
+
+static const char* STAGE_NAMES[] = {"prepare", "core", "overlay", "sparkles", "render"};
+static const char* MODE_NAMES[] = {"Linear", "Ease", "Pulse"};
+
+static volatile uint32_t benchSink = 0;
+
+static AfterburnerSettings makeSettings(uint8_t mode) {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = mode;
+  return settings;
+}
+
+// The per-LED stages reuse one prepared frame so only their own loop is timed;
+// prepare and render advance the clock every frame
+static void runStage(LEDEffects& effects, BenchStage stage, const AfterburnerSettings& settings) {
+  switch (stage) {
+    case STAGE_PREPARE:
+      advanceNativeMicros(FRAME_PERIOD_US);
+      LEDEffectsTestAccess::prepareFrame(effects, settings, BENCH_THROTTLE);
+      break;
+    case STAGE_CORE:
+      LEDEffectsTestAccess::renderCoreEffect(effects);
+      break;
+    case STAGE_OVERLAY:
+      LEDEffectsTestAccess::renderAfterburnerOverlay(effects);
+      break;
+    case STAGE_SPARKLES:
+      LEDEffectsTestAccess::addSparkles(effects);
+      break;
+    case STAGE_RENDER:
+      advanceNativeMicros(FRAME_PERIOD_US);
+      effects.render(settings, BENCH_THROTTLE, millis());
+      break;
+  }
+}
+
+// Returns the average time of one frame of the given stage in nanoseconds
+static double measureStage(LEDEffects& effects, BenchStage stage, const AfterburnerSettings& settings,
+                           uint16_t totalLeds) {
+  unsigned long frames = BENCH_LED_UPDATES / totalLeds;
+  if (frames < BENCH_MIN_FRAMES) {
+    frames = BENCH_MIN_FRAMES;
+  }
+
+  for (int i = 0; i < BENCH_WARMUP_FRAMES; i++) {
+    runStage(effects, stage, settings);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i < frames; i++) {
+    runStage(effects, stage, settings);
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  // Keep the rendered buffer observable so the work cannot be optimized away
+  benchSink = benchSink + FastLED.getLeds()[totalLeds - 1].r;
+
+  double elapsedNs = std::chrono::duration<double, std::nano>(end - start).count();
+  return elapsedNs / frames;
+}
+
+static void benchmarkMode(uint8_t mode) {
+  AfterburnerSettings settings = makeSettings(mode);
+
+  printf("\n%-7s %9s  %-9s %12s %9s\n", "mode", "leds/ring", "stage", "ns/frame", "ns/LED");
+  for (size_t i = 0; i < NUM_RING_SIZES; i++) {
+    uint16_t ledsPerRing = RING_SIZES[i];
+    uint16_t totalLeds = ledsPerRing * 2;
+
+    LEDEffects effects;
+    effects.begin(totalLeds);
+    setNativeMillis(0);
+
+    for (int stage = STAGE_PREPARE; stage <= STAGE_RENDER; stage++) {
+      double nsPerFrame = measureStage(effects, (BenchStage)stage, settings, totalLeds);
+      printf("%-7s %9u  %-9s %12.1f %9.2f\n", MODE_NAMES[mode], ledsPerRing, STAGE_NAMES[stage],
+             nsPerFrame, nsPerFrame / totalLeds);
+      TEST_ASSERT_TRUE(nsPerFrame > 0.0);
+    }
+  }
+}
+
+void test_benchmark_linear_mode() {
+  benchmarkMode(0);
+}
+
+void test_benchmark_ease_mode() {
+  benchmarkMode(1);
+}
+
+void test_benchmark_pulse_mode() {
+  benchmarkMode(2);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_benchmark_linear_mode);
+  RUN_TEST(test_benchmark_ease_mode);
+  RUN_TEST(test_benchmark_pulse_mode);
+  return UNITY_END();
+}
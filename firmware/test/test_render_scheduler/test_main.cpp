@@ -0,0 +1,88 @@
+// Cadence tests for RenderScheduler on the host fake clock.
+//
+// Run with: pio test -e native -f test_render_scheduler
+
+#include <unity.h>
+#include "render_scheduler.h"
+
+#define TEST_FPS 50
+#define TEST_PERIOD_US (1000000UL / TEST_FPS)
+
+static RenderScheduler scheduler;
+
+void setUp() {
+  setNativeMillis(1000);
+  scheduler.begin(TEST_FPS);
+}
+
+void tearDown() {}
+
+void test_first_frame_is_due_immediately() {
+  TEST_ASSERT_TRUE(scheduler.frameDue());
+  TEST_ASSERT_EQUAL(1000, scheduler.getFrameTime());
+  TEST_ASSERT_FALSE(scheduler.frameDue());
+}
+
+void test_wait_lands_on_next_deadline() {
+  TEST_ASSERT_TRUE(scheduler.frameDue());
+  advanceNativeMicros(3500);  // Render work
+  
+  scheduler.waitForNextFrame();
+  TEST_ASSERT_TRUE(scheduler.frameDue());
+  TEST_ASSERT_EQUAL(1000 + TEST_PERIOD_US / 1000, scheduler.getFrameTime());
+  TEST_ASSERT_EQUAL(0, scheduler.getFramesDropped());
+}
+
+void test_late_frames_are_dropped_not_queued() {
+  TEST_ASSERT_TRUE(scheduler.frameDue());
+  
+  // Stall for three and a half periods: two deadlines are skipped entirely
+  advanceNativeMicros(TEST_PERIOD_US * 3 + TEST_PERIOD_US / 2);
+  TEST_ASSERT_TRUE(scheduler.frameDue());
+  TEST_ASSERT_FALSE(scheduler.frameDue());
+  TEST_ASSERT_EQUAL(2, scheduler.getFramesDropped());
+  
+  // The animation clock still reflects the time that passed
+  TEST_ASSERT_EQUAL(1000 + 3 * TEST_PERIOD_US / 1000, scheduler.getFrameTime());
+}
+
+void test_frame_clock_advances_in_whole_periods() {
+  // 60 FPS has a non-integer millisecond period; the clock must not drift
+  scheduler.begin(60);
+  for (int i = 0; i < 600; i++) {
+    scheduler.waitForNextFrame();
+    TEST_ASSERT_TRUE(scheduler.frameDue());
+    advanceNativeMicros(2000);
+  }
+  TEST_ASSERT_UINT32_WITHIN(1, 1000 + 599 * (1000000UL / 60) / 1000, scheduler.getFrameTime());
+}
+
+void test_reports_achieved_fps_and_jitter() {
+  for (int i = 0; i < TEST_FPS * 2 + 1; i++) {
+    scheduler.waitForNextFrame();
+    advanceNativeMicros(200);  // Woke up late
+    TEST_ASSERT_TRUE(scheduler.frameDue());
+    advanceNativeMicros(4800);  // Keeps the sleep a whole number of ticks
+  }
+  TEST_ASSERT_EQUAL(TEST_FPS, scheduler.getAchievedFps());
+  TEST_ASSERT_EQUAL(200, scheduler.getAverageJitterUs());
+  TEST_ASSERT_EQUAL(200, scheduler.getMaxJitterUs());
+}
+
+void test_target_fps_is_clamped() {
+  scheduler.setTargetFps(1);
+  TEST_ASSERT_EQUAL(MIN_TARGET_FPS, scheduler.getTargetFps());
+  scheduler.setTargetFps(1000);
+  TEST_ASSERT_EQUAL(MAX_TARGET_FPS, scheduler.getTargetFps());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_frame_is_due_immediately);
+  RUN_TEST(test_wait_lands_on_next_deadline);
+  RUN_TEST(test_late_frames_are_dropped_not_queued);
+  RUN_TEST(test_frame_clock_advances_in_whole_periods);
+  RUN_TEST(test_reports_achieved_fps_and_jitter);
+  RUN_TEST(test_target_fps_is_clamped);
+  return UNITY_END();
+}
@@ -0,0 +1,253 @@
+// Tests for the ring topology: validation, the encoded layout, output ranges
+// and rendering onto segments.
+//
+// Run with: pio test -e native -f test_ring_topology
+
+#include <unity.h>
+#include <string.h>
+#include "ring_topology.h"
+#include "led_effects.h"
+#include "settings_record.h"
+
+static RingSegment makeSegment(uint16_t start, uint16_t length, uint8_t flags, uint16_t phaseOffset) {
+  RingSegment segment;
+  segment.start = start;
+  segment.length = length;
+  segment.flags = flags;
+  segment.phaseOffset = phaseOffset;
+  return segment;
+}
+
+static RingTopology makeFourEngines() {
+  RingTopology topology;
+  memset(&topology, 0, sizeof(topology));
+  topology.segmentCount = 4;
+  topology.segments[0] = makeSegment(0, 24, 0, 0);
+  topology.segments[1] = makeSegment(24, 24, RING_SEGMENT_REVERSED, 16384);
+  topology.segments[2] = makeSegment(60, 16, 0, 32768);  // LEDs 48-59 unused
+  topology.segments[3] = makeSegment(76, 16, RING_SEGMENT_REVERSED, 49152);
+  return topology;
+}
+
+static AfterburnerSettings makeSettings(uint8_t mode) {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = mode;
+  return settings;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_legacy_layout_is_two_equal_rings() {
+  RingTopology empty;
+  memset(&empty, 0, sizeof(empty));
+  RingTopology resolved;
+  resolveTopology(empty, 45, resolved);
+  
+  TEST_ASSERT_EQUAL(2, resolved.segmentCount);
+  TEST_ASSERT_EQUAL(0, resolved.segments[0].start);
+  TEST_ASSERT_EQUAL(45, resolved.segments[1].start);
+  TEST_ASSERT_EQUAL(45, resolved.segments[1].length);
+  TEST_ASSERT_EQUAL(RING_SEGMENT_REVERSED, resolved.segments[1].flags);
+  TEST_ASSERT_EQUAL(ANGLE_HALF_TURN, resolved.segments[1].phaseOffset);
+  TEST_ASSERT_EQUAL(90, getTopologyLedCount(resolved));
+  TEST_ASSERT_EQUAL(TOPOLOGY_OK, validateTopology(resolved));
+  
+  // A configured topology is used as is
+  RingTopology configured = makeFourEngines();
+  resolveTopology(configured, 45, resolved);
+  TEST_ASSERT_TRUE(sameTopology(configured, resolved));
+  TEST_ASSERT_EQUAL(92, getTopologyLedCount(resolved));
+}
+
+void test_invalid_topologies_are_rejected() {
+  RingTopology topology = makeFourEngines();
+  TEST_ASSERT_EQUAL(TOPOLOGY_OK, validateTopology(topology));
+  
+  topology.segments[2].length = 0;
+  TEST_ASSERT_EQUAL(TOPOLOGY_EMPTY_SEGMENT, validateTopology(topology));
+  
+  topology = makeFourEngines();
+  topology.segments[3].start = MAX_TOPOLOGY_LEDS - 15;
+  TEST_ASSERT_EQUAL(TOPOLOGY_OUT_OF_RANGE, validateTopology(topology));
+  
+  topology = makeFourEngines();
+  topology.segments[2].start = 47;
+  TEST_ASSERT_EQUAL(TOPOLOGY_OVERLAP, validateTopology(topology));
+  
+  topology = makeFourEngines();
+  topology.segments[0].flags = 0x80;
+  TEST_ASSERT_EQUAL(TOPOLOGY_BAD_FLAGS, validateTopology(topology));
+  
+  topology = makeFourEngines();
+  topology.segmentCount = MAX_RING_SEGMENTS + 1;
+  TEST_ASSERT_EQUAL(TOPOLOGY_TOO_MANY_SEGMENTS, validateTopology(topology));
+}
+
+void test_encoding_round_trips_and_pins_layout() {
+  RingTopology original = makeFourEngines();
+  uint8_t data[TOPOLOGY_MAX_SIZE];
+  size_t length = encodeTopology(original, data);
+  TEST_ASSERT_EQUAL(TOPOLOGY_MAX_SIZE, length);
+  
+  // version | count | start | length | flags | phase, little-endian
+  const uint8_t expectedSecond[] = {24, 0, 24, 0, RING_SEGMENT_REVERSED, 0x00, 0x40};
+  TEST_ASSERT_EQUAL(TOPOLOGY_VERSION, data[0]);
+  TEST_ASSERT_EQUAL(4, data[1]);
+  TEST_ASSERT_EQUAL(0, memcmp(expectedSecond, data + TOPOLOGY_HEADER_SIZE + TOPOLOGY_SEGMENT_SIZE, 7));
+  
+  RingTopology decoded;
+  TEST_ASSERT_EQUAL(TOPOLOGY_OK, decodeTopology(data, length, decoded));
+  TEST_ASSERT_TRUE(sameTopology(original, decoded));
+  
+  // An empty topology (legacy layout) is just the header
+  RingTopology empty;
+  memset(&empty, 0, sizeof(empty));
+  TEST_ASSERT_EQUAL(TOPOLOGY_HEADER_SIZE, encodeTopology(empty, data));
+  TEST_ASSERT_EQUAL(TOPOLOGY_OK, decodeTopology(data, TOPOLOGY_HEADER_SIZE, decoded));
+  TEST_ASSERT_EQUAL(0, decoded.segmentCount);
+}
+
+void test_bad_writes_leave_topology_unchanged() {
+  RingTopology current = makeFourEngines();
+  RingTopology target = current;
+  uint8_t data[TOPOLOGY_MAX_SIZE];
+  
+  RingTopology overlapping = makeFourEngines();
+  overlapping.segments[1].start = 10;
+  size_t length = encodeTopology(overlapping, data);
+  TEST_ASSERT_EQUAL(TOPOLOGY_OVERLAP, decodeTopology(data, length, target));
+  TEST_ASSERT_TRUE(sameTopology(current, target));
+  
+  length = encodeTopology(current, data);
+  TEST_ASSERT_EQUAL(TOPOLOGY_BAD_LENGTH, decodeTopology(data, length - 1, target));
+  data[0] = TOPOLOGY_VERSION + 1;
+  TEST_ASSERT_EQUAL(TOPOLOGY_BAD_VERSION, decodeTopology(data, length, target));
+  data[0] = TOPOLOGY_VERSION;
+  data[1] = MAX_RING_SEGMENTS + 1;
+  TEST_ASSERT_EQUAL(TOPOLOGY_TOO_MANY_SEGMENTS, decodeTopology(data, length, target));
+  TEST_ASSERT_TRUE(sameTopology(current, target));
+}
+
+void test_render_fills_segments_and_leaves_gaps_dark() {
+  RingTopology topology = makeFourEngines();
+  LEDEffects effects;
+  effects.begin(topology);
+  TEST_ASSERT_EQUAL(92, FastLED.size());
+  
+  for (uint8_t mode = 0; mode < EFFECT_COUNT; mode++) {
+    effects.render(makeSettings(mode), 1.0f, 1234);
+    const CRGB* leds = effects.getRenderedLeds();
+    
+    for (uint16_t i = 48; i < 60; i++) {
+      TEST_ASSERT_TRUE(leds[i] == CRGB(CRGB::Black));
+    }
+    // Full throttle lights every LED of every ring through the overlay
+    for (uint8_t ring = 0; ring < topology.segmentCount; ring++) {
+      const RingSegment& segment = topology.segments[ring];
+      for (uint16_t i = segment.start; i < segment.start + segment.length; i++) {
+        TEST_ASSERT_TRUE(leds[i] != CRGB(CRGB::Black));
+      }
+    }
+  }
+}
+
+void test_reversed_segment_mirrors_the_profile() {
+  // One ring forward, one reversed, same phase: the overlay (no sparkles below
+  // 40% intensity) should mirror around LED 0
+  RingTopology topology;
+  memset(&topology, 0, sizeof(topology));
+  topology.segmentCount = 2;
+  topology.segments[0] = makeSegment(0, 20, 0, 0);
+  topology.segments[1] = makeSegment(20, 20, RING_SEGMENT_REVERSED, 0);
+  
+  LEDEffects effects;
+  effects.begin(topology);
+  AfterburnerSettings settings = makeSettings(1);
+  settings.startColor[0] = settings.startColor[1] = settings.startColor[2] = 0;
+  settings.endColor[0] = settings.endColor[1] = settings.endColor[2] = 0;
+  settings.abThreshold = 50;
+  effects.render(settings, 0.7f, 0);
+  
+  const CRGB* leds = effects.getRenderedLeds();
+  TEST_ASSERT_TRUE(leds[0] == leds[20]);
+  for (uint16_t i = 1; i < 20; i++) {
+    TEST_ASSERT_TRUE(leds[i] == leds[20 + (20 - i)]);
+  }
+  TEST_ASSERT_TRUE(leds[5] != leds[25]);
+}
+
+void test_output_ranges_and_validation() {
+  // Engines 1-2 on output 0, engines 3-4 on output 1
+  RingTopology topology = makeFourEngines();
+  topology.segments[2].flags |= RING_SEGMENT_OUTPUT(1);
+  topology.segments[3].flags |= RING_SEGMENT_OUTPUT(1);
+  TEST_ASSERT_EQUAL(TOPOLOGY_OK, validateTopology(topology));
+  TEST_ASSERT_EQUAL(1, getSegmentOutput(topology.segments[3]));
+  
+  uint16_t start, length;
+  TEST_ASSERT_TRUE(getOutputRange(topology, 0, start, length));
+  TEST_ASSERT_EQUAL(0, start);
+  TEST_ASSERT_EQUAL(48, length);
+  TEST_ASSERT_TRUE(getOutputRange(topology, 1, start, length));
+  TEST_ASSERT_EQUAL(60, start);
+  TEST_ASSERT_EQUAL(32, length);
+  
+  // The output travels in the flags byte of the encoded layout
+  uint8_t data[TOPOLOGY_MAX_SIZE];
+  RingTopology decoded;
+  TEST_ASSERT_EQUAL(TOPOLOGY_OK, decodeTopology(data, encodeTopology(topology, data), decoded));
+  TEST_ASSERT_TRUE(sameTopology(topology, decoded));
+  
+  // Single-output layouts leave the other output unused
+  RingTopology single = makeFourEngines();
+  TEST_ASSERT_FALSE(getOutputRange(single, 1, start, length));
+  TEST_ASSERT_EQUAL(0, length);
+  
+  topology.segments[3].flags = RING_SEGMENT_OUTPUT(LED_OUTPUT_COUNT);
+  TEST_ASSERT_EQUAL(TOPOLOGY_BAD_OUTPUT, validateTopology(topology));
+  
+  // Output 0 would have to send output 1's LEDs 24-47
+  topology = makeFourEngines();
+  topology.segments[1].flags |= RING_SEGMENT_OUTPUT(1);
+  TEST_ASSERT_EQUAL(TOPOLOGY_OUTPUT_INTERLEAVED, validateTopology(topology));
+}
+
+void test_render_points_each_output_at_its_range() {
+  RingTopology topology = makeFourEngines();
+  topology.segments[2].flags |= RING_SEGMENT_OUTPUT(1);
+  topology.segments[3].flags |= RING_SEGMENT_OUTPUT(1);
+  
+  LEDEffects effects;
+  effects.begin(topology);
+  TEST_ASSERT_EQUAL(LED_OUTPUT_COUNT, FastLED.count());
+  TEST_ASSERT_EQUAL(LED_OUTPUT_PIN_1, FastLED[1].pin);
+  TEST_ASSERT_EQUAL(48, FastLED[0].size());
+  TEST_ASSERT_EQUAL(32, FastLED[1].size());
+  TEST_ASSERT_TRUE(FastLED[1].getLeds() == FastLED[0].getLeds() + 60);
+  
+  effects.render(makeSettings(1), 1.0f, 1234);
+  for (int i = 0; i < FastLED[1].size(); i++) {
+    TEST_ASSERT_TRUE(FastLED[1].getLeds()[i] != CRGB(CRGB::Black));
+  }
+  
+  // Back to one output: the second is kept but sends nothing
+  effects.update(makeFourEngines());
+  TEST_ASSERT_EQUAL(LED_OUTPUT_COUNT, FastLED.count());
+  TEST_ASSERT_EQUAL(92, FastLED[0].size());
+  TEST_ASSERT_EQUAL(0, FastLED[1].size());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_legacy_layout_is_two_equal_rings);
+  RUN_TEST(test_invalid_topologies_are_rejected);
+  RUN_TEST(test_encoding_round_trips_and_pins_layout);
+  RUN_TEST(test_bad_writes_leave_topology_unchanged);
+  RUN_TEST(test_render_fills_segments_and_leaves_gaps_dark);
+  RUN_TEST(test_reversed_segment_mirrors_the_profile);
+  RUN_TEST(test_output_ranges_and_validation);
+  RUN_TEST(test_render_points_each_output_at_its_range);
+  return UNITY_END();
+}
@@ -0,0 +1,151 @@
+// Tests for the settings field table behind the per-setting characteristics:
+// lengths, ranges, byte order, and that every row points at its field.
+//
+// Run with: pio test -e native -f test_settings_fields
+
+#include <unity.h>
+#include "settings_fields.h"
+#include "settings_record.h"
+#include "effects.h"
+
+static const SettingsField& findField(const char* uuid) {
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    if (strcmp(SETTINGS_FIELDS[i].uuid, uuid) == 0) {
+      return SETTINGS_FIELDS[i];
+    }
+  }
+  return SETTINGS_FIELDS[0];  // The UUID checks in test_table_rows_are_consistent fail first
+}
+
+// Equal in every field the table covers
+static bool sameFields(const AfterburnerSettings& a, const AfterburnerSettings& b) {
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    uint8_t x[SETTINGS_FIELD_MAX_WIDTH];
+    uint8_t y[SETTINGS_FIELD_MAX_WIDTH];
+    size_t length = encodeField(SETTINGS_FIELDS[i], a, x);
+    encodeField(SETTINGS_FIELDS[i], b, y);
+    if (memcmp(x, y, length) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static AfterburnerSettings makeSettings() {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  return settings;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_table_rows_are_consistent() {
+  const char* uuids[] = {MODE_UUID, START_COLOR_UUID, END_COLOR_UUID, SPEED_MS_UUID,
+                         BRIGHTNESS_UUID, NUM_LEDS_UUID, AB_THRESHOLD_UUID, POWER_BUDGET_UUID};
+  TEST_ASSERT_EQUAL(8, SETTINGS_FIELD_COUNT);
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    TEST_ASSERT_EQUAL_STRING(uuids[i], SETTINGS_FIELDS[i].uuid);
+  }
+  
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    const SettingsField& field = SETTINGS_FIELDS[i];
+    TEST_ASSERT_TRUE(field.width >= 1 && field.width <= SETTINGS_FIELD_MAX_WIDTH);
+    TEST_ASSERT_TRUE(field.offset + field.width <= sizeof(AfterburnerSettings));
+    TEST_ASSERT_TRUE(field.min <= field.max);
+    TEST_ASSERT_TRUE(field.width == 2 || field.max <= 255);
+    for (uint8_t j = 0; j < i; j++) {
+      TEST_ASSERT_TRUE(strcmp(field.uuid, SETTINGS_FIELDS[j].uuid) != 0);
+      TEST_ASSERT_TRUE(field.offset != SETTINGS_FIELDS[j].offset);
+    }
+  }
+}
+
+void test_rows_encode_their_settings_field() {
+  AfterburnerSettings settings = makeSettings();
+  uint8_t value[SETTINGS_FIELD_MAX_WIDTH];
+  
+  TEST_ASSERT_EQUAL(1, encodeField(findField(MODE_UUID), settings, value));
+  TEST_ASSERT_EQUAL(settings.mode, value[0]);
+  TEST_ASSERT_EQUAL(3, encodeField(findField(END_COLOR_UUID), settings, value));
+  TEST_ASSERT_EQUAL(0, memcmp(settings.endColor, value, 3));
+  TEST_ASSERT_EQUAL(2, encodeField(findField(SPEED_MS_UUID), settings, value));
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS & 0xFF, value[0]);
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS >> 8, value[1]);
+  TEST_ASSERT_EQUAL(DEFAULT_NUM_LEDS, getFieldValue(findField(NUM_LEDS_UUID), settings));
+  TEST_ASSERT_EQUAL(DEFAULT_AB_THRESHOLD, getFieldValue(findField(AB_THRESHOLD_UUID), settings));
+  TEST_ASSERT_EQUAL(DEFAULT_BRIGHTNESS, getFieldValue(findField(BRIGHTNESS_UUID), settings));
+  TEST_ASSERT_EQUAL(DEFAULT_POWER_BUDGET_MA, getFieldValue(findField(POWER_BUDGET_UUID), settings));
+  
+  // Every row round-trips its own value
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    AfterburnerSettings copy = settings;
+    size_t length = encodeField(SETTINGS_FIELDS[i], settings, value);
+    TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(SETTINGS_FIELDS[i], value, length, copy));
+    TEST_ASSERT_TRUE(sameFields(settings, copy));
+  }
+}
+
+void test_single_byte_fields_check_length_and_range() {
+  AfterburnerSettings settings = makeSettings();
+  
+  const uint8_t mode[] = {EFFECT_COUNT - 1, EFFECT_COUNT};
+  TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(findField(MODE_UUID), mode, 1, settings));
+  TEST_ASSERT_EQUAL(EFFECT_COUNT - 1, settings.mode);
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, applyFieldWrite(findField(MODE_UUID), mode + 1, 1, settings));
+  TEST_ASSERT_EQUAL(WRITE_BAD_LENGTH, applyFieldWrite(findField(MODE_UUID), mode, 0, settings));
+  
+  const uint8_t brightness[] = {MIN_BRIGHTNESS, MIN_BRIGHTNESS - 1};
+  TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(findField(BRIGHTNESS_UUID), brightness, 1, settings));
+  TEST_ASSERT_EQUAL(MIN_BRIGHTNESS, settings.brightness);
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, applyFieldWrite(findField(BRIGHTNESS_UUID), brightness + 1, 1, settings));
+  TEST_ASSERT_EQUAL(WRITE_BAD_LENGTH, applyFieldWrite(findField(BRIGHTNESS_UUID), brightness, 2, settings));
+  
+  const uint8_t threshold[] = {MAX_AB_THRESHOLD, MAX_AB_THRESHOLD + 1};
+  TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(findField(AB_THRESHOLD_UUID), threshold, 1, settings));
+  TEST_ASSERT_EQUAL(MAX_AB_THRESHOLD, settings.abThreshold);
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, applyFieldWrite(findField(AB_THRESHOLD_UUID), threshold + 1, 1, settings));
+}
+
+void test_two_byte_fields_are_little_endian() {
+  AfterburnerSettings settings = makeSettings();
+  
+  const uint8_t speed[] = {0xB0, 0x04};  // 1200 ms
+  settings.speedMs = 0;
+  TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(findField(SPEED_MS_UUID), speed, 2, settings));
+  TEST_ASSERT_EQUAL(1200, settings.speedMs);
+  const uint8_t slow[] = {0x89, 0x13};  // 5001 ms
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, applyFieldWrite(findField(SPEED_MS_UUID), slow, 2, settings));
+  TEST_ASSERT_EQUAL(WRITE_BAD_LENGTH, applyFieldWrite(findField(SPEED_MS_UUID), speed, 1, settings));
+  
+  const uint8_t leds[] = {0x2C, 0x01};  // 300
+  TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(findField(NUM_LEDS_UUID), leds, 2, settings));
+  TEST_ASSERT_EQUAL(300, settings.numLeds);
+  const uint8_t none[] = {0x00, 0x00};
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, applyFieldWrite(findField(NUM_LEDS_UUID), none, 2, settings));
+}
+
+void test_rejected_writes_leave_settings_untouched() {
+  AfterburnerSettings settings = makeSettings();
+  AfterburnerSettings original = settings;
+  
+  const uint8_t color[] = {1, 2, 3, 4};
+  TEST_ASSERT_EQUAL(WRITE_BAD_LENGTH, applyFieldWrite(findField(START_COLOR_UUID), color, 4, settings));
+  const uint8_t slow[] = {0xFF, 0xFF};
+  TEST_ASSERT_EQUAL(WRITE_OUT_OF_RANGE, applyFieldWrite(findField(SPEED_MS_UUID), slow, 2, settings));
+  TEST_ASSERT_TRUE(sameFields(original, settings));
+  
+  TEST_ASSERT_EQUAL(WRITE_OK, applyFieldWrite(findField(START_COLOR_UUID), color, 3, settings));
+  TEST_ASSERT_EQUAL(3, settings.startColor[2]);
+  TEST_ASSERT_EQUAL(original.endColor[0], settings.endColor[0]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_table_rows_are_consistent);
+  RUN_TEST(test_rows_encode_their_settings_field);
+  RUN_TEST(test_single_byte_fields_check_length_and_range);
+  RUN_TEST(test_two_byte_fields_are_little_endian);
+  RUN_TEST(test_rejected_writes_leave_settings_untouched);
+  return UNITY_END();
+}
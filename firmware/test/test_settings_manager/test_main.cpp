@@ -0,0 +1,142 @@
+// Tests for SettingsManager::modifySettings(): BLE writes and the throttle
+// calibration run on different tasks and must not overwrite each other.
+//
+// Run with: pio test -e native -f test_settings_manager
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "settings.h"
+#include "settings_fields.h"
+#include "constants.h"
+
+#define STRESS_ROUNDS 2000
+
+void setUp() {}
+void tearDown() {}
+
+static const SettingsField& findField(const char* uuid) {
+  for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+    if (strcmp(SETTINGS_FIELDS[i].uuid, uuid) == 0) {
+      return SETTINGS_FIELDS[i];
+    }
+  }
+  return SETTINGS_FIELDS[0];
+}
+
+// The BLE field write path, as handleFieldWrite() runs it
+static bool writeField(SettingsManager& manager, const char* uuid, const uint8_t* data, size_t length) {
+  const SettingsField& field = findField(uuid);
+  return manager.modifySettings([&](AfterburnerSettings& current) {
+    return applyFieldWrite(field, data, length, current) == WRITE_OK;
+  });
+}
+
+void test_field_write_during_calibration_keeps_both() {
+  SettingsManager manager;
+  manager.begin();
+
+  // The field write has read the settings and is still changing them when
+  // calibration finishes on the system task
+  std::atomic<bool> writing(false);
+  std::thread ble([&]() {
+    manager.modifySettings([&](AfterburnerSettings& current) {
+      writing = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      current.brightness = 42;
+      return true;
+    });
+  });
+  while (!writing) {
+    std::this_thread::yield();
+  }
+  manager.updateThrottleCalibration(1010, 1990);
+  ble.join();
+
+  const AfterburnerSettings& published = manager.acquireSettings(SETTINGS_READER_SYSTEM);
+  TEST_ASSERT_EQUAL(42, published.brightness);
+  TEST_ASSERT_EQUAL(1010, published.throttleMin);
+  TEST_ASSERT_EQUAL(1990, published.throttleMax);
+  TEST_ASSERT_TRUE(published.throttleCalibrated);
+  TEST_ASSERT_EQUAL(0, memcmp(&published, &manager.getSettings(), sizeof(AfterburnerSettings)));
+}
+
+void test_concurrent_writers_never_lose_a_change() {
+  SettingsManager manager;
+  manager.begin();
+
+  std::thread ble([&]() {
+    for (uint16_t i = 0; i < STRESS_ROUNDS; i++) {
+      uint8_t brightness = MIN_BRIGHTNESS + i % 200;
+      writeField(manager, BRIGHTNESS_UUID, &brightness, 1);
+    }
+  });
+  for (uint16_t i = 0; i < STRESS_ROUNDS; i++) {
+    manager.modifySettings([i](AfterburnerSettings& current) {
+      current.throttleMin = 1000 + i % 100;
+      current.throttleMax = 1900 + i % 100;
+      current.throttleCalibrated = true;
+      return true;
+    });
+  }
+  ble.join();
+
+  const AfterburnerSettings& settings = manager.getSettings();
+  TEST_ASSERT_EQUAL(MIN_BRIGHTNESS + (STRESS_ROUNDS - 1) % 200, settings.brightness);
+  TEST_ASSERT_EQUAL(1000 + (STRESS_ROUNDS - 1) % 100, settings.throttleMin);
+  TEST_ASSERT_EQUAL(1900 + (STRESS_ROUNDS - 1) % 100, settings.throttleMax);
+  TEST_ASSERT_TRUE(manager.isDirty());
+}
+
+void test_rejected_change_leaves_settings_untouched() {
+  SettingsManager manager;
+  manager.begin();
+  uint32_t version = manager.getSettingsVersion();
+
+  // Out of range: the copy is dropped, nothing is published or marked dirty
+  uint8_t brightness = MIN_BRIGHTNESS - 1;
+  TEST_ASSERT_FALSE(writeField(manager, BRIGHTNESS_UUID, &brightness, 1));
+  TEST_ASSERT_EQUAL(DEFAULT_BRIGHTNESS, manager.getSettings().brightness);
+  TEST_ASSERT_EQUAL(version, manager.getSettingsVersion());
+  TEST_ASSERT_FALSE(manager.isDirty());
+
+  // result still reports the stored settings, so a read shows the write undone
+  AfterburnerSettings result;
+  manager.modifySettings([](AfterburnerSettings& current) {
+    current.mode = 2;
+    return false;
+  }, &result);
+  TEST_ASSERT_EQUAL(DEFAULT_MODE, result.mode);
+}
+
+void test_calibration_reset_and_defaults_keep_other_writes() {
+  SettingsManager manager;
+  manager.begin();
+
+  uint8_t speed[2] = {0xD0, 0x07};  // 2000 ms
+  TEST_ASSERT_TRUE(writeField(manager, SPEED_MS_UUID, speed, 2));
+  manager.updateThrottleCalibration(1100, 1800);
+  manager.resetThrottleCalibration();
+  TEST_ASSERT_EQUAL(2000, manager.getSettings().speedMs);
+  TEST_ASSERT_EQUAL(DEFAULT_THROTTLE_MIN, manager.getSettings().throttleMin);
+  TEST_ASSERT_FALSE(manager.getSettings().throttleCalibrated);
+  TEST_ASSERT_TRUE(manager.isDirty());
+
+  // Defaults reset the effect settings but not the calibration
+  manager.updateThrottleCalibration(1100, 1800);
+  manager.resetToDefaults();
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS, manager.getSettings().speedMs);
+  TEST_ASSERT_EQUAL(1100, manager.getSettings().throttleMin);
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS, manager.acquireSettings(SETTINGS_READER_RENDER).speedMs);
+  TEST_ASSERT_FALSE(manager.isDirty());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_field_write_during_calibration_keeps_both);
+  RUN_TEST(test_concurrent_writers_never_lose_a_change);
+  RUN_TEST(test_rejected_change_leaves_settings_untouched);
+  RUN_TEST(test_calibration_reset_and_defaults_keep_other_writes);
+  return UNITY_END();
+}
@@ -0,0 +1,171 @@
+// Tests for the multi-field settings packet.
+//
+// Run with: pio test -e native -f test_settings_packet
+
+#include <unity.h>
+#include <string.h>
+#include "settings_packet.h"
+#include "settings_record.h"
+#include "settings_fields.h"
+#include "effects.h"
+
+static AfterburnerSettings makePreset() {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = 2;
+  settings.startColor[0] = 10;
+  settings.startColor[1] = 20;
+  settings.startColor[2] = 30;
+  settings.endColor[0] = 40;
+  settings.endColor[1] = 50;
+  settings.endColor[2] = 60;
+  settings.speedMs = 750;
+  settings.brightness = 128;
+  settings.numLeds = 60;
+  settings.abThreshold = 70;
+  return settings;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_full_packet_round_trip() {
+  AfterburnerSettings preset = makePreset();
+  uint8_t packet[SETTINGS_PACKET_SIZE];
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_SIZE, encodeSettingsPacket(preset, SETTINGS_FIELD_ALL, 0, packet));
+  
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  SettingsPacketResult result = applySettingsPacket(packet, sizeof(packet), settings);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_OK, result.status);
+  TEST_ASSERT_EQUAL(SETTINGS_FIELD_ALL, result.mask);
+  TEST_ASSERT_EQUAL(0, memcmp(&preset, &settings, sizeof(settings)));
+}
+
+void test_mask_selects_fields() {
+  AfterburnerSettings preset = makePreset();
+  uint8_t packet[SETTINGS_PACKET_SIZE];
+  encodeSettingsPacket(preset, SETTINGS_FIELD_MODE | SETTINGS_FIELD_END_COLOR, SETTINGS_PACKET_FLAG_SAVE, packet);
+  
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  SettingsPacketResult result = applySettingsPacket(packet, sizeof(packet), settings);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_OK, result.status);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_FLAG_SAVE, result.flags);
+  TEST_ASSERT_EQUAL(2, settings.mode);
+  TEST_ASSERT_EQUAL(40, settings.endColor[0]);
+  TEST_ASSERT_EQUAL(DEFAULT_START_COLOR_R, settings.startColor[0]);
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS, settings.speedMs);
+  TEST_ASSERT_EQUAL(DEFAULT_NUM_LEDS, settings.numLeds);
+}
+
+void test_one_invalid_field_rejects_the_whole_packet() {
+  AfterburnerSettings preset = makePreset();
+  preset.speedMs = MAX_SPEED_MS + 1;
+  uint8_t packet[SETTINGS_PACKET_SIZE];
+  encodeSettingsPacket(preset, SETTINGS_FIELD_ALL, 0, packet);
+  
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  AfterburnerSettings before = settings;
+  SettingsPacketResult result = applySettingsPacket(packet, sizeof(packet), settings);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_BAD_VALUE, result.status);
+  TEST_ASSERT_EQUAL(SETTINGS_FIELD_SPEED, result.rejectedField);
+  TEST_ASSERT_EQUAL(0, memcmp(&before, &settings, sizeof(settings)));
+  
+  // The same bad value is ignored when its field is not selected
+  encodeSettingsPacket(preset, SETTINGS_FIELD_ALL & ~SETTINGS_FIELD_SPEED, 0, packet);
+  result = applySettingsPacket(packet, sizeof(packet), settings);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_OK, result.status);
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS, settings.speedMs);
+}
+
+void test_range_limits() {
+  struct { uint16_t field; void (*set)(AfterburnerSettings&); } cases[] = {
+    {SETTINGS_FIELD_MODE, [](AfterburnerSettings& s) { s.mode = EFFECT_COUNT; }},
+    {SETTINGS_FIELD_SPEED, [](AfterburnerSettings& s) { s.speedMs = MIN_SPEED_MS - 1; }},
+    {SETTINGS_FIELD_BRIGHTNESS, [](AfterburnerSettings& s) { s.brightness = MIN_BRIGHTNESS - 1; }},
+    {SETTINGS_FIELD_NUM_LEDS, [](AfterburnerSettings& s) { s.numLeds = 0; }},
+    {SETTINGS_FIELD_NUM_LEDS, [](AfterburnerSettings& s) { s.numLeds = MAX_NUM_LEDS + 1; }},
+    {SETTINGS_FIELD_AB_THRESHOLD, [](AfterburnerSettings& s) { s.abThreshold = MAX_AB_THRESHOLD + 1; }},
+  };
+  
+  for (auto& c : cases) {
+    AfterburnerSettings preset = makePreset();
+    c.set(preset);
+    uint8_t packet[SETTINGS_PACKET_SIZE];
+    encodeSettingsPacket(preset, SETTINGS_FIELD_ALL, 0, packet);
+    
+    AfterburnerSettings settings;
+    getDefaultSettings(settings);
+    SettingsPacketResult result = applySettingsPacket(packet, sizeof(packet), settings);
+    TEST_ASSERT_EQUAL(SETTINGS_PACKET_BAD_VALUE, result.status);
+    TEST_ASSERT_EQUAL(c.field, result.rejectedField);
+  }
+}
+
+void test_ranges_come_from_the_field_table() {
+  // Each one-byte value is accepted exactly when its characteristic accepts it
+  struct { uint16_t mask; const char* uuid; uint8_t payloadOffset; } fields[] = {
+    {SETTINGS_FIELD_MODE, MODE_UUID, 0},
+    {SETTINGS_FIELD_BRIGHTNESS, BRIGHTNESS_UUID, 9},
+    {SETTINGS_FIELD_AB_THRESHOLD, AB_THRESHOLD_UUID, 12},
+  };
+  for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+    const SettingsField* row = nullptr;
+    for (uint8_t i = 0; i < SETTINGS_FIELD_COUNT; i++) {
+      if (strcmp(SETTINGS_FIELDS[i].uuid, fields[f].uuid) == 0) {
+        row = &SETTINGS_FIELDS[i];
+      }
+    }
+    TEST_ASSERT_TRUE(row != nullptr);
+    
+    for (uint16_t value = 0; value < 256; value++) {
+      uint8_t packet[SETTINGS_PACKET_SIZE];
+      encodeSettingsPacket(makePreset(), fields[f].mask, 0, packet);
+      packet[SETTINGS_PACKET_HEADER_SIZE + fields[f].payloadOffset] = value;
+      
+      AfterburnerSettings viaPacket, viaField;
+      getDefaultSettings(viaPacket);
+      getDefaultSettings(viaField);
+      uint8_t byte = value;
+      bool fieldOk = applyFieldWrite(*row, &byte, 1, viaField) == WRITE_OK;
+      bool packetOk = applySettingsPacket(packet, sizeof(packet), viaPacket).status == SETTINGS_PACKET_OK;
+      TEST_ASSERT_EQUAL(fieldOk, packetOk);
+      TEST_ASSERT_EQUAL(0, memcmp(&viaField, &viaPacket, sizeof(AfterburnerSettings)));
+    }
+  }
+}
+
+void test_malformed_packets() {
+  AfterburnerSettings preset = makePreset();
+  uint8_t packet[SETTINGS_PACKET_SIZE + 4] = {};
+  encodeSettingsPacket(preset, SETTINGS_FIELD_ALL, 0, packet);
+  
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_BAD_LENGTH, applySettingsPacket(packet, 2, settings).status);
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_BAD_LENGTH, applySettingsPacket(packet, SETTINGS_PACKET_SIZE - 1, settings).status);
+  
+  // Newer, longer packets are accepted
+  packet[0] = SETTINGS_PACKET_VERSION + 1;
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_OK, applySettingsPacket(packet, sizeof(packet), settings).status);
+  
+  packet[0] = 0;
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_BAD_VERSION, applySettingsPacket(packet, sizeof(packet), settings).status);
+  
+  packet[0] = SETTINGS_PACKET_VERSION;
+  packet[3] = 0x80;  // Field this firmware does not know
+  TEST_ASSERT_EQUAL(SETTINGS_PACKET_BAD_MASK, applySettingsPacket(packet, sizeof(packet), settings).status);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_packet_round_trip);
+  RUN_TEST(test_mask_selects_fields);
+  RUN_TEST(test_one_invalid_field_rejects_the_whole_packet);
+  RUN_TEST(test_range_limits);
+  RUN_TEST(test_ranges_come_from_the_field_table);
+  RUN_TEST(test_malformed_packets);
+  return UNITY_END();
+}
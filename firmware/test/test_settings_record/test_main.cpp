@@ -0,0 +1,246 @@
+// Tests for the single-blob settings record stored in NVS.
+//
+// Run with: pio test -e native -f test_settings_record
+
+#include <unity.h>
+#include <string.h>
+#include "settings_record.h"
+
+static AfterburnerSettings makeCustomSettings() {
+  AfterburnerSettings settings;
+  getDefaultSettings(settings);
+  settings.mode = 2;
+  settings.startColor[0] = 1;
+  settings.startColor[1] = 2;
+  settings.startColor[2] = 3;
+  settings.endColor[0] = 4;
+  settings.endColor[1] = 5;
+  settings.endColor[2] = 6;
+  settings.speedMs = 4321;
+  settings.brightness = 77;
+  settings.numLeds = 123;
+  settings.abThreshold = 65;
+  settings.throttleMin = 1010;
+  settings.throttleMax = 1990;
+  settings.throttleCalibrated = true;
+  settings.topology.segmentCount = 3;
+  for (uint8_t i = 0; i < 3; i++) {
+    settings.topology.segments[i].start = i * 40;
+    settings.topology.segments[i].length = 36;
+    settings.topology.segments[i].flags = i == 1 ? RING_SEGMENT_REVERSED : 0;
+    settings.topology.segments[i].phaseOffset = i * 21845;
+  }
+  settings.powerBudgetMa = 4321;
+  return settings;
+}
+
+static void assertSettingsEqual(const AfterburnerSettings& expected, const AfterburnerSettings& actual) {
+  TEST_ASSERT_EQUAL(expected.mode, actual.mode);
+  for (int c = 0; c < 3; c++) {
+    TEST_ASSERT_EQUAL(expected.startColor[c], actual.startColor[c]);
+    TEST_ASSERT_EQUAL(expected.endColor[c], actual.endColor[c]);
+  }
+  TEST_ASSERT_EQUAL(expected.speedMs, actual.speedMs);
+  TEST_ASSERT_EQUAL(expected.brightness, actual.brightness);
+  TEST_ASSERT_EQUAL(expected.numLeds, actual.numLeds);
+  TEST_ASSERT_EQUAL(expected.abThreshold, actual.abThreshold);
+  TEST_ASSERT_EQUAL(expected.throttleMin, actual.throttleMin);
+  TEST_ASSERT_EQUAL(expected.throttleMax, actual.throttleMax);
+  TEST_ASSERT_EQUAL(expected.throttleCalibrated, actual.throttleCalibrated);
+  TEST_ASSERT_TRUE(sameTopology(expected.topology, actual.topology));
+  TEST_ASSERT_EQUAL(expected.powerBudgetMa, actual.powerBudgetMa);
+}
+
+// Header and CRC around a payload already in place at record + SETTINGS_RECORD_HEADER_SIZE
+static size_t sealRecord(uint8_t* record, uint8_t schemaVersion, size_t payloadSize) {
+  record[0] = SETTINGS_RECORD_MAGIC & 0xFF;
+  record[1] = SETTINGS_RECORD_MAGIC >> 8;
+  record[2] = schemaVersion;
+  record[3] = payloadSize;
+  uint32_t crc = settingsCrc32(record, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  for (int i = 0; i < 4; i++) {
+    record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + i] = (crc >> (8 * i)) & 0xFF;
+  }
+  return SETTINGS_RECORD_HEADER_SIZE + payloadSize + SETTINGS_RECORD_CRC_SIZE;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc32_matches_standard_check_value() {
+  const char* check = "123456789";
+  TEST_ASSERT_EQUAL(0xCBF43926UL, settingsCrc32((const uint8_t*)check, strlen(check)));
+}
+
+void test_record_round_trips() {
+  AfterburnerSettings original = makeCustomSettings();
+  uint8_t record[SETTINGS_RECORD_SIZE];
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_SIZE, encodeSettingsRecord(original, record));
+  
+  AfterburnerSettings decoded;
+  uint8_t schemaVersion = 0;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, sizeof(record), decoded, &schemaVersion));
+  TEST_ASSERT_EQUAL(SETTINGS_SCHEMA_VERSION, schemaVersion);
+  assertSettingsEqual(original, decoded);
+}
+
+void test_corruption_falls_back_to_defaults() {
+  AfterburnerSettings defaults;
+  getDefaultSettings(defaults);
+  uint8_t record[SETTINGS_RECORD_SIZE];
+  encodeSettingsRecord(makeCustomSettings(), record);
+  
+  // Every single-bit flip anywhere in the record is rejected
+  for (size_t byte = 0; byte < sizeof(record); byte++) {
+    for (int bit = 0; bit < 8; bit++) {
+      record[byte] ^= (1 << bit);
+      AfterburnerSettings decoded;
+      TEST_ASSERT_TRUE(decodeSettingsRecord(record, sizeof(record), decoded, nullptr) != SETTINGS_RECORD_OK);
+      assertSettingsEqual(defaults, decoded);
+      record[byte] ^= (1 << bit);
+    }
+  }
+  
+  AfterburnerSettings decoded;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_BAD_LENGTH, decodeSettingsRecord(record, sizeof(record) - 1, decoded, nullptr));
+}
+
+void test_older_shorter_schema_keeps_defaults_for_new_fields() {
+  // A record whose payload stops after abThreshold (13 bytes)
+  AfterburnerSettings original = makeCustomSettings();
+  uint8_t full[SETTINGS_RECORD_SIZE];
+  encodeSettingsRecord(original, full);
+  
+  const size_t payloadSize = 13;
+  uint8_t record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + SETTINGS_RECORD_CRC_SIZE];
+  memcpy(record, full, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  record[2] = 0;  // Older schema
+  record[3] = payloadSize;
+  uint32_t crc = settingsCrc32(record, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  for (int i = 0; i < 4; i++) {
+    record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + i] = (crc >> (8 * i)) & 0xFF;
+  }
+  
+  AfterburnerSettings decoded;
+  uint8_t schemaVersion = 99;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, sizeof(record), decoded, &schemaVersion));
+  TEST_ASSERT_EQUAL(0, schemaVersion);
+  TEST_ASSERT_EQUAL(original.abThreshold, decoded.abThreshold);
+  TEST_ASSERT_EQUAL(DEFAULT_THROTTLE_MIN, decoded.throttleMin);
+  TEST_ASSERT_EQUAL(DEFAULT_THROTTLE_MAX, decoded.throttleMax);
+  TEST_ASSERT_EQUAL(DEFAULT_THROTTLE_CALIBRATED, decoded.throttleCalibrated);
+}
+
+void test_schema_1_record_uses_legacy_topology() {
+  // Schema 1 stopped after throttleCalibrated (18 bytes)
+  AfterburnerSettings original = makeCustomSettings();
+  uint8_t full[SETTINGS_RECORD_SIZE];
+  encodeSettingsRecord(original, full);
+  
+  const size_t payloadSize = 18;
+  uint8_t record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + SETTINGS_RECORD_CRC_SIZE];
+  memcpy(record, full, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  record[2] = 1;
+  record[3] = payloadSize;
+  uint32_t crc = settingsCrc32(record, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  for (int i = 0; i < 4; i++) {
+    record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + i] = (crc >> (8 * i)) & 0xFF;
+  }
+  
+  AfterburnerSettings decoded;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, sizeof(record), decoded, nullptr));
+  TEST_ASSERT_EQUAL(original.numLeds, decoded.numLeds);
+  TEST_ASSERT_TRUE(original.throttleCalibrated == decoded.throttleCalibrated);
+  TEST_ASSERT_EQUAL(0, decoded.topology.segmentCount);
+}
+
+void test_schema_2_record_keeps_default_power_budget() {
+  // Schema 2 stopped after the topology (48 bytes)
+  AfterburnerSettings original = makeCustomSettings();
+  uint8_t full[SETTINGS_RECORD_SIZE];
+  encodeSettingsRecord(original, full);
+  
+  const size_t payloadSize = 48;
+  uint8_t record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + SETTINGS_RECORD_CRC_SIZE];
+  memcpy(record, full, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  record[2] = 2;
+  record[3] = payloadSize;
+  uint32_t crc = settingsCrc32(record, SETTINGS_RECORD_HEADER_SIZE + payloadSize);
+  for (int i = 0; i < 4; i++) {
+    record[SETTINGS_RECORD_HEADER_SIZE + payloadSize + i] = (crc >> (8 * i)) & 0xFF;
+  }
+  
+  AfterburnerSettings decoded;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, sizeof(record), decoded, nullptr));
+  TEST_ASSERT_TRUE(sameTopology(original.topology, decoded.topology));
+  TEST_ASSERT_EQUAL(DEFAULT_POWER_BUDGET_MA, decoded.powerBudgetMa);
+}
+
+void test_newer_longest_record_decodes_known_fields() {
+  // A future schema with the largest payload the length byte allows
+  AfterburnerSettings original = makeCustomSettings();
+  uint8_t record[SETTINGS_RECORD_MAX_SIZE];
+  encodeSettingsRecord(original, record);
+  memset(record + SETTINGS_RECORD_HEADER_SIZE + SETTINGS_PAYLOAD_SIZE, 0xEE,
+         SETTINGS_PAYLOAD_MAX_SIZE - SETTINGS_PAYLOAD_SIZE);
+  size_t length = sealRecord(record, SETTINGS_SCHEMA_VERSION + 1, SETTINGS_PAYLOAD_MAX_SIZE);
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_MAX_SIZE, length);
+  
+  AfterburnerSettings decoded;
+  uint8_t schemaVersion = 0;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, length, decoded, &schemaVersion));
+  TEST_ASSERT_EQUAL(SETTINGS_SCHEMA_VERSION + 1, schemaVersion);
+  assertSettingsEqual(original, decoded);
+}
+
+void test_out_of_range_fields_take_their_defaults() {
+  // Intact (CRC-valid) record holding values no BLE write would accept
+  AfterburnerSettings original = makeCustomSettings();
+  AfterburnerSettings stored = original;
+  stored.mode = 200;
+  stored.speedMs = 0;
+  stored.brightness = MIN_BRIGHTNESS - 1;
+  stored.numLeds = MAX_NUM_LEDS + 1;
+  stored.abThreshold = MAX_AB_THRESHOLD + 1;
+  stored.powerBudgetMa = MAX_POWER_BUDGET_MA + 1;
+  uint8_t record[SETTINGS_RECORD_SIZE];
+  encodeSettingsRecord(stored, record);
+  
+  AfterburnerSettings decoded;
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, sizeof(record), decoded, nullptr));
+  TEST_ASSERT_EQUAL(DEFAULT_MODE, decoded.mode);
+  TEST_ASSERT_EQUAL(DEFAULT_SPEED_MS, decoded.speedMs);
+  TEST_ASSERT_EQUAL(DEFAULT_BRIGHTNESS, decoded.brightness);
+  TEST_ASSERT_EQUAL(DEFAULT_NUM_LEDS, decoded.numLeds);
+  TEST_ASSERT_EQUAL(DEFAULT_AB_THRESHOLD, decoded.abThreshold);
+  TEST_ASSERT_EQUAL(DEFAULT_POWER_BUDGET_MA, decoded.powerBudgetMa);
+  
+  // Valid fields next to them are kept
+  TEST_ASSERT_EQUAL(original.startColor[2], decoded.startColor[2]);
+  TEST_ASSERT_EQUAL(original.throttleMax, decoded.throttleMax);
+  TEST_ASSERT_TRUE(sameTopology(original.topology, decoded.topology));
+  
+  // An impossible calibration is dropped as a whole
+  stored = original;
+  stored.throttleMin = 2000;
+  stored.throttleMax = 1000;
+  encodeSettingsRecord(stored, record);
+  TEST_ASSERT_EQUAL(SETTINGS_RECORD_OK, decodeSettingsRecord(record, sizeof(record), decoded, nullptr));
+  TEST_ASSERT_EQUAL(DEFAULT_THROTTLE_MIN, decoded.throttleMin);
+  TEST_ASSERT_EQUAL(DEFAULT_THROTTLE_MAX, decoded.throttleMax);
+  TEST_ASSERT_FALSE(decoded.throttleCalibrated);
+  TEST_ASSERT_EQUAL(original.speedMs, decoded.speedMs);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc32_matches_standard_check_value);
+  RUN_TEST(test_record_round_trips);
+  RUN_TEST(test_corruption_falls_back_to_defaults);
+  RUN_TEST(test_older_shorter_schema_keeps_defaults_for_new_fields);
+  RUN_TEST(test_schema_1_record_uses_legacy_topology);
+  RUN_TEST(test_schema_2_record_keeps_default_power_budget);
+  RUN_TEST(test_newer_longest_record_decodes_known_fields);
+  RUN_TEST(test_out_of_range_fields_take_their_defaults);
+  return UNITY_END();
+}
@@ -0,0 +1,67 @@
+// Tests for the binary BLE status frame.
+//
+// Run with: pio test -e native -f test_status_frame
+
+#include <unity.h>
+#include <math.h>
+#include "status_frame.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_frame_layout_is_little_endian() {
+  StatusFrame status;
+  status.sequence = 0x1234;
+  status.throttlePermille = 875;
+  status.mode = 2;
+  status.flags = STATUS_FLAG_CALIBRATED | STATUS_FLAG_AFTERBURNER;
+  status.ledCurrentMa = 2480;
+  
+  uint8_t frame[STATUS_FRAME_SIZE];
+  TEST_ASSERT_EQUAL(STATUS_FRAME_SIZE, encodeStatusFrame(status, frame));
+  
+  const uint8_t expected[STATUS_FRAME_SIZE] = {
+    STATUS_FRAME_VERSION, STATUS_FRAME_SIZE, 0x34, 0x12, 875 & 0xFF, 875 >> 8, 2, 0x06, 2480 & 0xFF, 2480 >> 8
+  };
+  for (int i = 0; i < STATUS_FRAME_SIZE; i++) {
+    TEST_ASSERT_EQUAL(expected[i], frame[i]);
+  }
+}
+
+void test_throttle_to_permille_rounds_and_clamps() {
+  TEST_ASSERT_EQUAL(0, throttleToPermille(0.0f));
+  TEST_ASSERT_EQUAL(0, throttleToPermille(-0.2f));
+  TEST_ASSERT_EQUAL(1000, throttleToPermille(1.0f));
+  TEST_ASSERT_EQUAL(1000, throttleToPermille(1.7f));
+  TEST_ASSERT_EQUAL(500, throttleToPermille(0.5f));
+  TEST_ASSERT_EQUAL(124, throttleToPermille(0.1236f));
+  TEST_ASSERT_EQUAL(1, throttleToPermille(0.0005f));
+}
+
+void test_nan_throttle_is_marked_invalid() {
+  TEST_ASSERT_EQUAL(STATUS_THROTTLE_INVALID, throttleToPermille(NAN));
+}
+
+void test_sequence_wraps_in_frame() {
+  StatusFrame status = {};
+  status.sequence = 0xFFFF;
+  
+  uint8_t frame[STATUS_FRAME_SIZE];
+  encodeStatusFrame(status, frame);
+  TEST_ASSERT_EQUAL(0xFF, frame[2]);
+  TEST_ASSERT_EQUAL(0xFF, frame[3]);
+  
+  status.sequence++;
+  encodeStatusFrame(status, frame);
+  TEST_ASSERT_EQUAL(0, frame[2]);
+  TEST_ASSERT_EQUAL(0, frame[3]);
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_layout_is_little_endian);
+  RUN_TEST(test_throttle_to_permille_rounds_and_clamps);
+  RUN_TEST(test_nan_throttle_is_marked_invalid);
+  RUN_TEST(test_sequence_wraps_in_frame);
+  return UNITY_END();
+}
@@ -0,0 +1,127 @@
+// Tests for the telemetry sample buffer and its BLE batch frames.
+//
+// Run with: pio test -e native -f test_telemetry
+
+#include <unity.h>
+#include "telemetry.h"
+
+static TelemetrySample makeSample(uint16_t n) {
+  TelemetrySample sample;
+  sample.timeMs = n * 16;
+  sample.pulseUs = 1000 + n;
+  sample.throttlePermille = n;
+  sample.renderUs = 300 + n;
+  return sample;
+}
+
+static uint16_t getUint16(const uint8_t* data) {
+  return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_batch_layout() {
+  TelemetryBuffer buffer;
+  for (uint16_t n = 0; n < 3; n++) {
+    TEST_ASSERT_TRUE(buffer.push(makeSample(n)));
+  }
+  TEST_ASSERT_EQUAL(3, buffer.available());
+  
+  uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+  size_t length = buffer.encodeBatch(frame, TELEMETRY_MAX_BATCH);
+  TEST_ASSERT_EQUAL(TELEMETRY_HEADER_SIZE + 3 * TELEMETRY_SAMPLE_SIZE, length);
+  TEST_ASSERT_EQUAL(TELEMETRY_VERSION, frame[0]);
+  TEST_ASSERT_EQUAL(3, frame[1]);
+  TEST_ASSERT_EQUAL(0, getUint16(frame + 2));
+  
+  for (uint16_t n = 0; n < 3; n++) {
+    const uint8_t* sample = frame + TELEMETRY_HEADER_SIZE + n * TELEMETRY_SAMPLE_SIZE;
+    TEST_ASSERT_EQUAL(n * 16, getUint16(sample));
+    TEST_ASSERT_EQUAL(1000 + n, getUint16(sample + 2));
+    TEST_ASSERT_EQUAL(n, getUint16(sample + 4));
+    TEST_ASSERT_EQUAL(300 + n, getUint16(sample + 6));
+  }
+  
+  TEST_ASSERT_EQUAL(0, buffer.available());
+  TEST_ASSERT_EQUAL(0, buffer.encodeBatch(frame, TELEMETRY_MAX_BATCH));
+}
+
+void test_batches_are_limited_and_sequenced() {
+  TelemetryBuffer buffer;
+  for (uint16_t n = 0; n < 25; n++) {
+    buffer.push(makeSample(n));
+  }
+  
+  uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+  buffer.encodeBatch(frame, 10);
+  TEST_ASSERT_EQUAL(10, frame[1]);
+  TEST_ASSERT_EQUAL(0, getUint16(frame + 2));
+  
+  buffer.encodeBatch(frame, 10);
+  TEST_ASSERT_EQUAL(10, frame[1]);
+  TEST_ASSERT_EQUAL(10, getUint16(frame + 2));
+  
+  buffer.encodeBatch(frame, 10);
+  TEST_ASSERT_EQUAL(5, frame[1]);
+  TEST_ASSERT_EQUAL(20, getUint16(frame + 2));
+}
+
+void test_full_buffer_drops_newest_and_splits_batch_at_gap() {
+  TelemetryBuffer buffer;
+  uint16_t pushed = 0;
+  while (buffer.push(makeSample(pushed))) {
+    pushed++;
+  }
+  TEST_ASSERT_EQUAL(TELEMETRY_BUFFER_SIZE - 1, pushed);
+  TEST_ASSERT_EQUAL(1, buffer.getDroppedSamples());
+  
+  // Drain all but the last queued sample, then queue one after the gap
+  uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+  while (buffer.available() > 1) {
+    uint8_t count = buffer.available() - 1;
+    buffer.encodeBatch(frame, count < TELEMETRY_MAX_BATCH ? count : TELEMETRY_MAX_BATCH);
+  }
+  TEST_ASSERT_TRUE(buffer.push(makeSample(pushed + 1)));
+  
+  // The batch stops at the gap; the next one starts after it
+  buffer.encodeBatch(frame, TELEMETRY_MAX_BATCH);
+  TEST_ASSERT_EQUAL(1, frame[1]);
+  TEST_ASSERT_EQUAL(pushed - 1, getUint16(frame + 2));
+  
+  buffer.encodeBatch(frame, TELEMETRY_MAX_BATCH);
+  TEST_ASSERT_EQUAL(1, frame[1]);
+  TEST_ASSERT_EQUAL(pushed + 1, getUint16(frame + 2));
+}
+
+void test_samples_per_batch_follows_mtu() {
+  TEST_ASSERT_EQUAL(2, telemetrySamplesPerBatch(23));
+  TEST_ASSERT_EQUAL(12, telemetrySamplesPerBatch(103));
+  TEST_ASSERT_EQUAL(TELEMETRY_MAX_BATCH, telemetrySamplesPerBatch(247));
+  TEST_ASSERT_EQUAL(TELEMETRY_MAX_BATCH, telemetrySamplesPerBatch(517));
+  
+  // A full batch at the clamped size always fits the frame buffer
+  TEST_ASSERT_TRUE(TELEMETRY_MAX_FRAME_SIZE <= 247 - 3);
+}
+
+void test_discard_and_enable() {
+  TelemetryBuffer buffer;
+  TEST_ASSERT_FALSE(buffer.isEnabled());
+  buffer.setEnabled(true);
+  TEST_ASSERT_TRUE(buffer.isEnabled());
+  
+  buffer.push(makeSample(0));
+  buffer.push(makeSample(1));
+  buffer.discard();
+  TEST_ASSERT_EQUAL(0, buffer.available());
+}
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_batch_layout);
+  RUN_TEST(test_batches_are_limited_and_sequenced);
+  RUN_TEST(test_full_buffer_drops_newest_and_splits_batch_at_gap);
+  RUN_TEST(test_samples_per_batch_follows_mtu);
+  RUN_TEST(test_discard_and_enable);
+  return UNITY_END();
+}